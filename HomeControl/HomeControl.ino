@@ -16,26 +16,57 @@
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <Arena.h>
+#include <BufferedPrint.h>
 #include <ClientHelper.h>
 #include <DateTime.h>
+#include <DedupFilter.h>
+#include <DhcpClient.h>
 #include <Event.h>
+#include <EventStore.h>
+#include <Feedback.h>
+#include <Format.h>
 #include <HumidSensor.h>
 #include <LightSensor.h>
-#include <RingBuffer.h>
+#include <NamePool.h>
+#include <PageTemplate.h>
+#include <Profiler.h>
+#include <RateLimiter.h>
+#include <Resync.h>
+#include <RfReceiver.h>
+#include <RuleCompiler.h>
+#include <RuleEngine.h>
+#include <RuleProgram.h>
+#include <Scene.h>
 #include <Schedule.h>
+#include <SendTracker.h>
+#include <Session.h>
 #include <Sensor.h>
+#include <Sha256.h>
 #include <Switch.h>
+#include <SwitchBatch.h>
+#include <SwitchRegistry.h>
 #include <TempSensor.h>
 #include <Time.h>
+#include <TimerWheel.h>
+#include <Trace.h>
+#include <Transmitter.h>
 #include <Util.h>
 #include <WebServer.h>
 #include <SavedArray.h>
+#include <Storage.h>
+#ifdef __AVR__
+#include <utility/w5100.h>
+#else
+#include <GatewayServer.h>
+#include <Snapshot.h>
+#include <stdio.h>
+#endif
 
 #include <SPI.h>
 #include <Wire.h>
 #include <Ethernet.h>
 #include <IPAddress.h>
-#include <RCSwitch.h>
 #include <OneWire.h>
 #include <DHT.h>
 
@@ -48,16 +79,20 @@ const int PIN_RECV = 0;
 // analog
 const int PIN_LIGHT = 0;
 
-const uint32_t MAGIC = 1410;
+const uint32_t MAGIC = 1423;
 const uint32_t WAIT_PERIOD = 60000;
+const uint32_t LEARN_TIMEOUT = 30000;
 const int EVENT_DELAY = 5;
 const int SEND_REPEAT = 3;
 const int SERVER_PORT = 80;
 const int MAX_SENSORS = 3;
-const int MAX_SWITCHES = 16;
-const int MAX_SCHEDULES = 32;
-const int MAX_RULES = 32;
-const int MAX_EVENTS = 64;
+const int MAX_SWITCHES = Switch::MAX;
+const int MAX_SCHEDULES = 64;
+const int MAX_RULES = 64;
+const int MAX_PROGRAMS = 16;
+const int MAX_SCENES = 32;
+// switch ids from here on in event rules and schedules are scenes
+const switch_id_t SCENE_TARGET = 1000;
 
 const char* URI_TIME = "time";
 const char* URI_SERVER = "server";
@@ -70,6 +105,29 @@ const char* URI_MOBILE = "mobile";
 const char* URI_FAVICON = "favicon.ico";
 const char* URI_EVENT = "event";
 const char* URI_SETTING = "setting";
+const char* URI_METRICS = "metrics";
+const char* URI_TRACE = "trace";
+const char* URI_LEARN = "learn";
+const char* URI_PROGRAM = "program";
+const char* URI_SCENE = "scene";
+const char* URI_RADIO = "radio";
+const char* URI_API_EVENTS = "api/events";
+const char* URI_LOGIN = "login";
+const char* URI_LOGOUT = "logout";
+// starts with 'c', so its query is left to getKey() like the one of control
+const char* URI_BATCH = "control/batch";
+
+// request counters in the profiler
+enum { 
+	ROUTE_STATUS, ROUTE_MOBILE, ROUTE_SWITCH, ROUTE_SCHEDULE, 
+	ROUTE_EVENT, ROUTE_EVENT_RULES, ROUTE_SETTING, ROUTE_METRICS, 
+	ROUTE_TRACE, ROUTE_CONTROL, ROUTE_POST, ROUTE_PROGRAM, ROUTE_API_EVENTS, 
+	ROUTE_LOGIN, ROUTE_LOGOUT, ROUTE_BATCH, ROUTE_SCENE, ROUTE_OTHER, ROUTES
+};
+STATIC_ASSERT(ROUTES <= Profiler::MAX_ROUTES, route_count);
+STATIC_ASSERT(MAX_SWITCHES <= SwitchBatch::MAX, batch_size);
+STATIC_ASSERT(MAX_SWITCHES <= SCENE_TARGET && SCENE_TARGET + MAX_SCENES < Switch::NONE, scene_target);
+STATIC_ASSERT(MAX_PROGRAMS <= RuleEngine::MAX_PROGRAMS, program_count);
 
 EEMEM uint32_t magic_ee;
 /* BUG 
@@ -81,22 +139,205 @@ EEMEM WebServer webServer_ee;
 EEMEM byte switch_ee[MAX_SWITCHES*sizeof(Switch)];
 EEMEM byte schedule_ee[MAX_SCHEDULES*sizeof(Schedule)];
 EEMEM byte rules_ee[MAX_RULES*sizeof(EventRule)];
+EEMEM byte programs_ee[MAX_PROGRAMS*sizeof(RuleProgram)];
 EEMEM byte time_ee[sizeof(Time)];
 EEMEM byte webServer_ee[sizeof(WebServer)];
+EEMEM byte resync_ee[sizeof(Resync)];
+EEMEM byte names_ee[sizeof(NamePool)];
+EEMEM byte scenes_ee[MAX_SCENES*sizeof(Scene)];
+EEMEM byte feedback_ee[MAX_SWITCHES*sizeof(Feedback)];
+EEMEM byte events_ee[EventStore::STORAGE_SIZE];
 
 SavedArray<Switch, MAX_SWITCHES> switches(&switch_ee);
 SavedArray<Schedule, MAX_SCHEDULES> schedules(&schedule_ee);
 SavedArray<EventRule, MAX_RULES> eventRules(&rules_ee);
+SavedArray<RuleProgram, MAX_PROGRAMS> programs(&programs_ee);
+SavedArray<Scene, MAX_SCENES> scenes(&scenes_ee);
+SavedArray<Feedback, MAX_SWITCHES> feedback(&feedback_ee);
 SavedArray<Time, 1> timeConf(&time_ee);
 SavedArray<WebServer, 1> serverConf(&webServer_ee);
-RingBuffer<Event, MAX_EVENTS> eventLog;
+SavedArray<Resync, 1> resyncConf(&resync_ee);
+SavedArray<NamePool, 1> nameConf(&names_ee);
+EventStore eventStore(&events_ee);
 
-Time& time = timeConf.instance();
+Time& rtc = timeConf.instance();
 WebServer& webServer = serverConf.instance();
-RCSwitch switchControl = RCSwitch();
+Resync& resync = resyncConf.instance();
+NamePool& names = nameConf.instance();
+// the active switches, rebuilt from switches at start
+SwitchRegistry<MAX_SWITCHES> registry;
+RfReceiver receiver;
+DedupFilter dedup(EVENT_DELAY * 1000UL);
+Transmitter transmitter(PIN_SEND);
+SendTracker tracker(SEND_REPEAT);
+Profiler profiler;
+RateLimiter limiter;
+TimerWheel timers;
+Session session;
+DhcpClient dhcp;
+
+bool switchIsOn(switch_id_t);
+float sensorValue(byte);
+void ruleAction(switch_id_t, byte);
+RuleEngine ruleEngine(timers, switchIsOn, sensorValue, ruleAction);
+
+// Timers not armed by the rule engine carry a RuleProgram switch op
+// in bits 12-13 (see timerTag()) and the switch id below. Each switch 
+// has at most one auto-off timer, a new one replaces it.
+const uint16_t TIMER_AUTO_OFF = 0x4000;
+STATIC_ASSERT(MAX_SWITCHES <= 0x1000, timer_tag);
+byte autoOff[MAX_SWITCHES];
+// Switches whose last command was manual, and every switch after a
+// reset until a command or feedback sets its state. Their recorded
+// state may be stale then, and the resync leaves them alone.
+SwitchBatch manualSwitches;
+// the switch the resync is sending, and the bursts it still gets
+switch_id_t resyncId;
+byte resyncLeft;
 Sensor* sensors[MAX_SENSORS] = {0};
+Arena<ARENA_SIZEOF(TempSensor) + 
+	ARENA_SIZEOF(LightSensor) + 
+	ARENA_SIZEOF(HumidSensor)> sensorArena;
+
+// event rule waiting for the next received code
+const byte NO_RULE = 255;
+byte learnRule = NO_RULE;
+uint32_t learnStart;
+// tables loadDeferred() has loaded so far
+byte deferred;
+
+// false if the name pool is full, the record keeps its old name then
+template<class T>
+bool setName(T& record, const char* name)
+{
+	byte id = record.getNameId();
+	if (!names.rename(id, name))
+		return false;
+	record.setNameId(id);
+	return true;
+}
+
+#ifdef __AVR__
 EthernetServer server(SERVER_PORT);
 
+// everything the pages render, on the board simply the live configuration
+struct State {
+	const SavedArray<Switch, MAX_SWITCHES>& switches;
+	const SavedArray<Schedule, MAX_SCHEDULES>& schedules;
+	const SavedArray<EventRule, MAX_RULES>& eventRules;
+	const SavedArray<RuleProgram, MAX_PROGRAMS>& programs;
+	const SavedArray<Scene, MAX_SCENES>& scenes;
+	const SavedArray<Feedback, MAX_SWITCHES>& feedback;
+	const SwitchRegistry<MAX_SWITCHES>& registry;
+	const NamePool& names;
+	const Time& time;
+	const WebServer& webServer;
+	const Resync& resync;
+	const Session& session;
+	const byte& learnRule;
+
+	float readSensor(int i) const { return sensors[i]->read(); }
+	DateTime now() const { return rtc.getTime(); }
+	int freeMemory() const { return freeRam(); }
+	MemStat memory() const { memSample(); return memStat(); }
+} live = { switches, schedules, eventRules, programs, scenes, feedback, registry, names, rtc, webServer, resync, session, learnRule };
+
+class StateView {
+public:
+	const State& get() const { return live; }
+};
+
+inline void publishState(bool = false) {}
+#else
+bool handleReadRequest(Client&);
+GatewayServer server(SERVER_PORT, handleReadRequest);
+
+// Copy of everything the pages render. The loop publishes it after each
+// change and gateway workers render from it without taking any lock, 
+// so page views never hold up rf and schedule handling. The clock runs
+// on from the time of the copy, between changes nothing is copied.
+struct State {
+	SavedArray<Switch, MAX_SWITCHES, RamStorage> switches;
+	SavedArray<Schedule, MAX_SCHEDULES, RamStorage> schedules;
+	SavedArray<EventRule, MAX_RULES, RamStorage> eventRules;
+	SavedArray<RuleProgram, MAX_PROGRAMS, RamStorage> programs;
+	SavedArray<Scene, MAX_SCENES, RamStorage> scenes;
+	SavedArray<Feedback, MAX_SWITCHES, RamStorage> feedback;
+	SwitchRegistry<MAX_SWITCHES> registry;
+	NamePool names;
+	Time time;
+	WebServer webServer;
+	Resync resync;
+	Session session;
+	byte learnRule;
+	float sensorValue[MAX_SENSORS];
+	DateTime clock;
+	uint32_t clockMillis;
+	int ramFree;
+	MemStat mem;
+
+	State(): switches(NULL), schedules(NULL), eventRules(NULL), programs(NULL), scenes(NULL), feedback(NULL) {}
+
+	float readSensor(int i) const { return sensorValue[i]; }
+	DateTime now() const
+	{
+		return DateTime(clock.getUnix() + (uint32_t(millis()) - clockMillis) / 1000);
+	}
+	int freeMemory() const { return ramFree; }
+	MemStat memory() const { return mem; }
+};
+
+Snapshot<State> snapshot;
+State staging;
+// the last publish found every copy in use
+bool unpublished;
+
+class StateView {
+	byte slot;
+	const State& state;
+public:
+	StateView(): state(snapshot.acquire(slot)) {}
+	~StateView() { snapshot.release(slot); }
+	const State& get() const { return state; }
+};
+
+template<class T, uint16_t sz, class A, class B>
+void copyArray(SavedArray<T, sz, A>& dst, const SavedArray<T, sz, B>& src)
+{
+	for (int i = 0; i < sz; i++)
+		dst[i] = src[i];
+}
+
+void publishState(bool readSensors = false)
+{
+	if (readSensors) {
+		for (int i = 0; i < MAX_SENSORS; i++)
+			staging.sensorValue[i] = sensors[i]->read();
+	}
+	copyArray(staging.switches, switches);
+	copyArray(staging.schedules, schedules);
+	copyArray(staging.eventRules, eventRules);
+	copyArray(staging.programs, programs);
+	copyArray(staging.scenes, scenes);
+	copyArray(staging.feedback, feedback);
+	staging.registry = registry;
+	staging.names = names;
+	staging.time = rtc;
+	staging.webServer = webServer;
+	staging.resync = resync;
+	staging.session = session;
+	staging.learnRule = learnRule;
+	staging.clock = rtc.getTime();
+	staging.clockMillis = millis();
+	memSample();
+	staging.ramFree = freeRam();
+	staging.mem = memStat();
+
+	// retried on the next pass if readers still hold every other copy
+	unpublished = !snapshot.publish(staging);
+}
+#endif
+
 uint32_t wait;
 
 void setup()
@@ -105,40 +346,81 @@ void setup()
 	Serial.begin(9600);
 #endif
 
-	DEBUG_PRINT("starting...");
-	DEBUG_PRINT(MAGIC);
-	if (eeprom_read_dword(&magic_ee) == MAGIC) {
+	TRACE_MSG("starting...");
+	TRACE(MAGIC);
+	// what the radio and the network need, the rest follows in loop()
+	if (readMagic() == MAGIC) {
 		switches.load();
-		schedules.load();
 		eventRules.load();
+		programs.load();
+		scenes.load();
+		feedback.load();
 		timeConf.load();
 		serverConf.load();
-		DEBUG_PRINT("config loaded from eeprom");
+		resyncConf.load();
 	} else {
 		switches.save();
 		schedules.save();
 		eventRules.save();
+		programs.save();
+		scenes.save();
+		feedback.save();
 		timeConf.save();
 		serverConf.save();
-		eeprom_write_dword(&magic_ee, MAGIC);
-		DEBUG_PRINT("config written to eeprom");
+		resyncConf.save();
+		nameConf.save();
+		eventStore.clear();
+		writeMagic(MAGIC);
+		profiler.reach(Profiler::BOOT_CONFIG);
+		TRACE_MSG("config written to eeprom");
 	}
-	DEBUG_PRINT(int(&magic_ee));
-	DEBUG_PRINT(int(&switch_ee));
-	DEBUG_PRINT(int(&rules_ee));
-	DEBUG_PRINT(int(&schedule_ee));
-	DEBUG_PRINT(int(&time_ee));
-	DEBUG_PRINT(int(&webServer_ee));
-
-	sensors[0] = new TempSensor(PIN_TEMP);
-	sensors[1] = new LightSensor(PIN_LIGHT);
-	sensors[2] = new HumidSensor(PIN_DHT11);
+	for (switch_id_t i = 0; i < switches.getSize(); i++) {
+		registry.setActive(i, switches[i].isActive());
+		manualSwitches.set(i, true);
+	}
+	TRACE(size_t(&magic_ee));
+	TRACE(size_t(&switch_ee));
+	TRACE(size_t(&rules_ee));
+	TRACE(size_t(&schedule_ee));
+	TRACE(size_t(&time_ee));
+	TRACE(size_t(&webServer_ee));
+	TRACE(size_t(&resync_ee));
+	TRACE(size_t(&names_ee));
+	TRACE(size_t(&scenes_ee));
+	TRACE(size_t(&feedback_ee));
+	TRACE(size_t(&events_ee));
+	TRACE(sizeof(Switch));
+	TRACE(sizeof(Schedule));
+	TRACE(sizeof(EventRule));
+	TRACE(sizeof(RuleProgram));
+	TRACE(sizeof(Scene));
+	TRACE(sizeof(Feedback));
+	TRACE(names.getFree());
+
+	sensors[0] = ARENA_NEW(sensorArena, TempSensor)(PIN_TEMP);
+	sensors[1] = ARENA_NEW(sensorArena, LightSensor)(PIN_LIGHT);
+	sensors[2] = ARENA_NEW(sensorArena, HumidSensor)(PIN_DHT11);
+	TRACE(sensorArena.getFree());
+
+	// codes are queued from here on
+	receiver.begin(PIN_RECV);
+	transmitter.begin();
+	ruleEngine.begin(&programs[0], programs.getSize());
+	memset(autoOff, TimerWheel::NONE, sizeof(autoOff));
+	timers.begin();
+	resync.begin(millis());
+	profiler.reach(Profiler::BOOT_RADIO);
 
 	wait = millis() + WAIT_PERIOD;
 
-	if (webServer.getDHCP()) {
+	// DHCP runs in loop(), until then the interface has no address
+	if (runsDhcp()) {
+		IPAddress none(0, 0, 0, 0);
+		Ethernet.begin(webServer.getMAC(), none, none, none, none);
+		dhcp.begin(webServer.getMAC(), millis());
+		TRACE_MSG("using DHCP");
+	} else if (webServer.getDHCP()) {
 		Ethernet.begin(webServer.getMAC());
-		DEBUG_PRINT("using DHCP");
 	} else {
 		Ethernet.begin(webServer.getMAC(), 
 			webServer.getIP(), 
@@ -146,124 +428,418 @@ void setup()
 			webServer.getGW(), 
 			webServer.getMask());
 	}
-	DEBUG_PRINT(Ethernet.localIP());
+	TRACE(Ethernet.localIP());
+	session.begin(webServer.getPasswDigest(), sessionSeed());
 
-	switchControl.enableReceive(PIN_RECV);
-	switchControl.enableTransmit(PIN_SEND);
+	rtc.begin();
+	publishState(true);
 
-	time.begin();
-	server.begin();
+	TRACE_MSG("setup finished");
+}
+
+// The event log, names and schedules, one per pass. The event log 
+// comes first since codes are logged from the first pass on, pages 
+// wait for the rest.
+void loadDeferred()
+{
+	switch (deferred++) {
+		case 0: eventStore.load(); break;
+		case 1: nameConf.load(); break;
+		case 2: 
+			schedules.load();
+			profiler.reach(Profiler::BOOT_CONFIG);
+			TRACE_MSG("config loaded from eeprom");
+			break;
+	}
+}
+
+// A gateway leaves DHCP to the system, its address is there from the
+// start. Only a DHCP stand-in on loopback is asked (see EthernetUDP).
+bool runsDhcp()
+{
+#ifdef __AVR__
+	return webServer.getDHCP();
+#else
+	return webServer.getDHCP() && getenv("HOMECONTROL_DHCP_PORT");
+#endif
+}
+
+// Addresses of a new lease, or none after it was lost. The sockets in
+// use stay open.
+void applyLease()
+{
+#ifdef __AVR__
+	uint32_t addr = dhcp.getIP();
+	W5100.setIPAddress((uint8_t*)&addr);
+	addr = dhcp.getGateway();
+	W5100.setGatewayIp((uint8_t*)&addr);
+	addr = dhcp.getMask();
+	W5100.setSubnetMask((uint8_t*)&addr);
+#else
+	Ethernet.begin(webServer.getMAC(), 
+		dhcp.getIP(), 
+		dhcp.getDNS(), 
+		dhcp.getGateway(), 
+		dhcp.getMask());
+#endif
+	TRACE(dhcp.getIP());
+}
+
+// A DHCP step, the web server starts once there is an address and the
+// config is complete. The client renews the lease at half its time by
+// itself, there is no Ethernet.maintain() to call.
+void pollNetwork()
+{
+	if (runsDhcp()) {
+		unsigned long start = micros();
+		if (dhcp.poll(millis()) != DhcpClient::NONE) {
+			applyLease();
+			profiler.record(Profiler::ETHERNET, start);
+		}
+	}
+	if (profiler.isReached(Profiler::BOOT_NETWORK) || 
+			!profiler.isReached(Profiler::BOOT_CONFIG) ||
+			(runsDhcp() && !dhcp.isBound()))
+		return;
 
-	DEBUG_PRINT("setup finished");
+	server.begin();
+	profiler.reach(Profiler::BOOT_NETWORK);
+	TRACE_MSG("server started");
 }
 
 void loop()
 {
-	EthernetClient client = server.available();
+	bool changed = false;
+	// nothing was served, received, fired or retried on this pass
+	bool idle = learnRule == NO_RULE;
+
+	if (!profiler.isReached(Profiler::BOOT_CONFIG)) {
+		loadDeferred();
+		changed = true;
+		idle = false;
+	}
+	pollNetwork();
+
+	// available() would start the server early on the board
+	bool serving = profiler.isReached(Profiler::BOOT_NETWORK);
+	unsigned long start = micros();
+#ifdef __AVR__
+	EthernetClient client;
+
+	if (serving)
+		client = server.available();
 
 	if (client) {
-		DEBUG_PRINT("client available");
+		TRACE_MSG("client available");
+		idle = false;
 		while (client.connected()) {
 			if (client.available()) {
-				ClientHelper webClient(&client);
-				switch (webClient.getRequestType()) {
-					case ClientHelper::GET:
-						DEBUG_PRINT("GET request");
-						handleGetRequest(client);
-						break;
-					case ClientHelper::POST:
-						DEBUG_PRINT("POST request");
-						handlePostRequest(client);
-						break;
-					default:
-						DEBUG_PRINT("unknown request");
-						sendError(client);
-				}
+				if (admitRequest(client, remoteAddress(client)))
+					handleRequest(client);
 				break;
 			}
 		}
 		delay(1);
 		client.stop();
-		DEBUG_PRINT("client disconnected");
+		TRACE_MSG("client disconnected");
+		profiler.record(Profiler::HTTP, start);
+	}
+#else
+	// requests the gateway workers left to us because they change state
+	SocketClient* client = serving ? server.available() : NULL;
+
+	if (client) {
+		if (handleRequest(*client))
+			changed = true;
+		delete client;
+		idle = false;
+		profiler.record(Profiler::HTTP, start);
 	}
+#endif
 
-	if (switchControl.available()) {
-		unsigned long id = switchControl.getReceivedValue();
-		for (int i = 0; i < eventRules.getSize(); i++) {
-			EventRule& rule = eventRules[i];
-			applyEventRules(rule, id);
+	RfCode code;
+	start = micros();
+
+	if (receiver.poll(code)) {
+		unsigned long id = code.getId();
+		profiler.count(Profiler::RF_CODES);
+		idle = false;
+		TRACE(code.protocol);
+		// echoes of a switch tend to come again on a resend
+		applyFeedback(id);
+		// before any rule, a burst or a held button is one event
+		bool repeat = dedup.isRepeat(id, millis());
+		if (repeat) {
+			profiler.count(Profiler::RF_REPEATS);
+		} else if (learnRule != NO_RULE) {
+			// bound only, the remote is not acted upon while learning
+			eventRules[learnRule].setEventId(id);
+			eventRules.save();
+			learnRule = NO_RULE;
+		} else {
+			for (int i = 0; i < eventRules.getSize(); i++) {
+				EventRule& rule = eventRules[i];
+				applyEventRules(rule, id);
+			}
+			unsigned long ruleStart = micros();
+			ruleEngine.onCode(id, rtc.getTime());
+			profiler.record(Profiler::RULES, ruleStart);
 		}
-		logEvent(id);
-		switchControl.resetAvailable();
+		logEvent(id, repeat);
+		if (!repeat)
+			changed = true;
+		profiler.record(Profiler::RF, start);
+	}
+
+	uint16_t timer;
+	while (timers.poll(timer)) {
+		start = micros();
+		if (timer & RuleEngine::TIMER_TAG) {
+			ruleEngine.resume(timer, rtc.getTime());
+		} else {
+			switch_id_t id = timer & 0x0FFF;
+			if (timer & TIMER_AUTO_OFF)
+				autoOff[id] = TimerWheel::NONE;
+			ruleAction(id, RuleProgram::SWITCH_ON + (timer >> 12 & 3));
+		}
+		profiler.record(Profiler::RULES, start);
+		changed = true;
+		idle = false;
+	}
+
+	// commands that got no feedback in time
+	switch_id_t sent;
+	bool on;
+	while (tracker.due(sent, on, millis())) {
+		start = micros();
+		if (sensorConfirms(sent, on))
+			tracker.confirm(sent, on);
+		else if (tracker.retry(sent))
+			resendSwitch(sent, on);
+		profiler.record(Profiler::RF, start);
+		idle = false;
+	}
+
+	if (learnRule != NO_RULE && millis() - learnStart >= LEARN_TIMEOUT) {
+		learnRule = NO_RULE;
+		changed = true;
 	}
 
 	if (long(millis()-wait) >= 0) {
+		start = micros();
 		for (int i = 0; i < schedules.getSize(); i++) {
 			applySchedule(schedules[i]);
 		}
-		time.syncTime();
-		Ethernet.maintain();
+		profiler.record(Profiler::SCHEDULE, start);
+		start = micros();
+		ruleEngine.onMinute(rtc.getTime());
+		profiler.record(Profiler::RULES, start);
+		// no use waiting for an answer without an address
+		if (serving && (!runsDhcp() || dhcp.isBound())) {
+			start = micros();
+			rtc.syncTime();
+			profiler.record(Profiler::NTP, start);
+		}
+		eventStore.flush();
 		wait += WAIT_PERIOD;
-		DEBUG_PRINT("maintenance done");
-		DEBUG_PRINT(freeRam());
-		DEBUG_PRINT(time.getTime());
+		idle = false;
+		memSample();
+		TRACE_MSG("maintenance done");
+		TRACE(freeRam());
+		TRACE(memStat().lowFree);
+		TRACE(memStat().heapPeak);
+		TRACE(rtc.getTime().getUnix());
+		publishState(true);
 	}
+	// a single burst, and only on a pass that had nothing else to do
+	if (idle) {
+		start = micros();
+		if (resyncSwitch())
+			profiler.record(Profiler::RF, start);
+	}
+#ifndef __AVR__
+	if (unpublished)
+		changed = true;
+#endif
+	if (changed)
+		publishState();
+#ifdef DEBUG
+	traceLog.drain(Serial);
+#endif
+}
+
+// false if the request only read
+bool handleRequest(Client& client)
+{
+	ClientHelper webClient(&client);
+
+	switch (webClient.getRequestType()) {
+		case ClientHelper::GET:
+			TRACE_MSG("GET request");
+			return handleGetRequest(client);
+		case ClientHelper::POST:
+			TRACE_MSG("POST request");
+			handlePostRequest(client);
+			return true;
+		default:
+			TRACE_MSG("unknown request");
+			sendError(client);
+			return false;
+	}
+}
+
+#ifndef __AVR__
+// runs on the gateway workers, anything that changes state is left to loop()
+bool handleReadRequest(Client& client)
+{
+	unsigned long start = micros();
+
+	// the gateway hands its workers socket clients only
+	if (!admitRequest(client, static_cast<SocketClient&>(client).getRemoteAddress()))
+		return true;
+
+	ClientHelper webClient(&client);
+
+	if (webClient.getRequestType() != ClientHelper::GET)
+		return false;
+
+	const char* uri = webClient.getRequestURI('c');
+
+	// the event log is read from the eeprom file, which only loop() writes,
+	// metrics from the live counters of the receiver, tracker and timers
+	if (uri && (strcmp(uri, URI_CONTROL) == 0 || strcmp(uri, URI_EVENT) == 0 ||
+			strcmp(uri, URI_API_EVENTS) == 0 || strcmp(uri, URI_LOGOUT) == 0 ||
+			strcmp(uri, URI_BATCH) == 0 || strcmp(uri, URI_METRICS) == 0))
+		return false;
+
+	sendPage(client, webClient, uri);
+	profiler.record(Profiler::HTTP, start);
+	return true;
+}
+#endif
+
+#ifdef __AVR__
+uint32_t remoteAddress(EthernetClient& client)
+{
+	uint32_t addr;
+	W5100.readSnDIPR(client.getSocketNumber(), (uint8_t*)&addr);
+	return addr;
+}
+#endif
+
+// answered without reading the request, with a single write
+const char TOO_MANY[] PROGMEM = "HTTP/1.0 429 Too Many Requests\r\n"
+	"Retry-After: 1\r\n"
+	"Connection: close\r\n"
+	"\r\n";
+
+bool admitRequest(Client& client, uint32_t addr)
+{
+	RateLimiter::Result r = limiter.admit(addr, millis());
+
+	if (r == RateLimiter::ADMIT)
+		return true;
+	TRACE(int(r));
+	char buf[sizeof(TOO_MANY)];
+	memcpy_P(buf, TOO_MANY, sizeof(buf));
+	client.write((const uint8_t*)buf, sizeof(buf)-1);
+	return false;
 }
 
 void reset()
 {
-	DEBUG_PRINT("rebooting");
+	TRACE_MSG("rebooting");
 	delay(1000);
+#ifdef __AVR__
 	asm volatile ("  jmp 0"); 
+#else
+	exit(0); // restarted by the service manager
+#endif
 }
 
-void logEvent(unsigned long id)
+uint32_t readMagic()
 {
-	time_t now = time.getTime().getUnix();
-	Event ev(id);
-	ev.setTime(now);
+	uint32_t magic;
+	DefaultStorage::read(&magic, &magic_ee, sizeof(magic));
+	return magic;
+}
 
-	Event& last = eventLog[eventLog.isEmpty() ? 0 : eventLog.getSize()-1];
+void writeMagic(uint32_t magic)
+{
+	DefaultStorage::write(&magic, &magic_ee, sizeof(magic));
+}
 
-	if (ev.getId() == last.getId() && 
-			ev.getTime() - last.getTime() < EVENT_DELAY) {
-		last.setTime(now);
-		DEBUG_PRINT("duplicate received");
+// differs between boots, the session key mixes in the password digest
+unsigned long sessionSeed()
+{
+	unsigned long seed = micros();
+#ifdef __AVR__
+	// noise in the low bits of the light sensor readings
+	for (byte i = 0; i < 32; i++)
+		seed = (seed << 1 | seed >> 31) ^ analogRead(PIN_LIGHT) ^ micros();
+#else
+	FILE* f = fopen("/dev/urandom", "rb");
+	if (f) {
+		fread(&seed, sizeof(seed), 1, f);
+		fclose(f);
+	}
+#endif
+	return seed;
+}
+
+// a repeat only moves the time of the last event if that has its code
+void logEvent(unsigned long id, bool repeat)
+{
+	time_t now = rtc.getTime().getUnix();
+
+	if (repeat) {
+		eventStore.touch(id, now, EVENT_DELAY);
+		TRACE_MSG("duplicate received");
 	} else { 
-		eventLog.put(ev);
-		DEBUG_PRINT("RF signal received");
+		eventStore.add(id, now);
+		TRACE_MSG("RF signal received");
 	}
-	DEBUG_PRINT(ev.getId());
+	TRACE(id);
 }
 
-const char* getEventName(Event& ev)
+const char* getEventName(const State& st, const Event& ev)
 {
-	for (int i = 0; i < eventRules.getSize(); i++) {
-		if (eventRules[i].getEventId() == ev.getId())
-			return eventRules[i].getName();
+	for (int i = 0; i < st.eventRules.getSize(); i++) {
+		const EventRule& rule = st.eventRules[i];
+
+		if (rule.getEventId() == ev.getId() && rule.getNameId() != NamePool::NONE)
+			return st.names.get(rule.getNameId());
 	}
 	return NULL;
 }
 
 void doSwitch(Switch& sw, bool state, bool manual = false)
 {
+	switch_id_t id = &sw - &switches[0];
+
 	if (sw.isPin()) {
 		pinMode(sw.getId(), OUTPUT);
 		digitalWrite(sw.getId(), state);
-	} else if (state) {
-		for (int i = 0; i < SEND_REPEAT; i++) {
-			switchControl.switchOn(sw.getGroup(), sw.getDevice());
-			delay(5);
-		}
 	} else {
-		for (int i = 0; i < SEND_REPEAT; i++) {
-			switchControl.switchOff(sw.getGroup(), sw.getDevice());
+		uint32_t code = sw.getCode(state);
+		byte repeat = tracker.getRepeat(id);
+		// we would receive our own bursts
+		receiver.disable();
+		for (byte i = 0; i < repeat; i++) {
+			transmitter.send(code);
 			delay(5);
 		}
+		receiver.enable();
+		tracker.sent(id, state, repeat, hasFeedback(id), millis());
 	}
-	if (!manual)
+
+	if (manual) {
+		manualSwitches.set(id, true);
+	} else {
 		sw.setOn(state);
-	DEBUG_PRINT("switched");
+		manualSwitches.clear(id);
+	}
+	TRACE_MSG("switched");
 }
 
 void doManualSwitch(Switch& sw, bool state)
@@ -271,14 +847,198 @@ void doManualSwitch(Switch& sw, bool state)
 	doSwitch(sw, state, true);
 }
 
+// a command that got no feedback, manual if it was
+void resendSwitch(switch_id_t id, bool state)
+{
+	doSwitch(switches[id], state, manualSwitches.has(id));
+}
+
+// turnOn(i) is the state of active switch i, as recorded by doSwitch()
+SwitchBatch switchStates()
+{
+	SwitchBatch states;
+
+	for (switch_id_t k = 0; k < registry.getCount(); k++) {
+		switch_id_t id = registry[k];
+		states.set(id, switches[id].isOn());
+	}
+	return states;
+}
+
+// Switches everything in the batch that is not in its target state
+// yet, unless forced, and records the new states. The bursts are 
+// interleaved, every switch gets its first one before any gets the
+// next, and the receiver is disabled once for all of them. A switch
+// drops out after its own number of bursts.
+byte applyBatch(SwitchBatch batch, bool force = false)
+{
+	uint32_t codes[MAX_SWITCHES];
+	switch_id_t ids[MAX_SWITCHES];
+	switch_id_t n = 0;
+	byte most = 0;
+
+	if (!force)
+		batch.dropUnchanged(switchStates());
+
+	for (switch_id_t k = 0; k < registry.getCount(); k++) {
+		switch_id_t id = registry[k];
+		if (!batch.has(id))
+			continue;
+		Switch& sw = switches[id];
+		bool on = batch.turnOn(id);
+		if (sw.isPin()) {
+			pinMode(sw.getId(), OUTPUT);
+			digitalWrite(sw.getId(), on);
+		} else {
+			ids[n] = id;
+			codes[n++] = sw.getCode(on);
+			most = max(most, tracker.getRepeat(id));
+		}
+		sw.setOn(on);
+		manualSwitches.clear(id);
+	}
+
+	if (n) {
+		receiver.disable();
+		for (byte r = 0; r < most; r++) {
+			for (switch_id_t i = 0; i < n; i++) {
+				if (r < tracker.getRepeat(ids[i]))
+					transmitter.send(codes[i]);
+			}
+			delay(5);
+		}
+		receiver.enable();
+		for (switch_id_t i = 0; i < n; i++) {
+			switch_id_t id = ids[i];
+			tracker.sent(id, batch.turnOn(id), tracker.getRepeat(id), hasFeedback(id), millis());
+		}
+	}
+	TRACE(batch.getCount());
+	return batch.getCount();
+}
+
+// scene of an event rule or schedule target, NULL for a switch or an
+// unused scene
+const Scene* targetScene(switch_id_t target)
+{
+	if (target < SCENE_TARGET || target - SCENE_TARGET >= scenes.getSize())
+		return NULL;
+
+	const Scene& scene = scenes[target - SCENE_TARGET];
+
+	return scene.isActive() ? &scene : NULL;
+}
+
+// off sets every switch of the scene to the other state
+void applyScene(const Scene& scene, bool on)
+{
+	const SwitchBatch& batch = scene.getBatch();
+
+	applyBatch(on ? batch : batch.inverted());
+}
+
+// skipped by the resync, a pin, a switch whose state is not known or
+// one that waits for feedback
+bool resyncSkips(switch_id_t id)
+{
+	return !registry.isActive(id) || switches[id].isPin() ||
+		manualSwitches.has(id) || tracker.isPending(id);
+}
+
+// Sends one burst of the recorded state of the switch being resent, or
+// of the next active switch if one is due. A switch gets its bursts on
+// as many calls, a command to it in between drops the rest. False if
+// nothing was sent.
+bool resyncSwitch()
+{
+	if (resyncLeft && resyncSkips(resyncId))
+		resyncLeft = 0;
+
+	if (!resyncLeft) {
+		switch_id_t k = resync.next(registry.getCount(), millis());
+		if (k == Switch::NONE || resyncSkips(registry[k]))
+			return false;
+
+		resyncId = registry[k];
+		resyncLeft = tracker.getRepeat(resyncId);
+		resync.count();
+	}
+	const Switch& sw = switches[resyncId];
+
+	receiver.disable();
+	transmitter.send(sw.getCode(sw.isOn()));
+	receiver.enable();
+	resyncLeft--;
+	TRACE(resyncId);
+	return true;
+}
+
+// true if switch id reports its state, by a paired sensor or an echo
+bool hasFeedback(switch_id_t id)
+{
+	if (feedback[id].getSensorId() < MAX_SENSORS)
+		return true;
+
+	for (int i = 0; i < eventRules.getSize(); i++) {
+		const EventRule& rule = eventRules[i];
+		if (rule.isActive() && rule.isFeedback() && rule.getSwitchId() == id)
+			return true;
+	}
+	return false;
+}
+
+// a command waiting for switch id to reach state on got it, if the 
+// paired sensor says so
+bool sensorConfirms(switch_id_t id, bool on)
+{
+	const Feedback& fb = feedback[id];
+
+	if (fb.getSensorId() >= MAX_SENSORS)
+		return false;
+
+	float value = sensors[fb.getSensorId()]->read();
+
+	return value != Sensor::ERROR && fb.isOn(value) == on;
+}
+
+// Echo rules confirm a command waiting for the reported state. The 
+// state is recorded either way, the switch may have been used by hand.
+void applyFeedback(unsigned long id)
+{
+	for (int i = 0; i < eventRules.getSize(); i++) {
+		const EventRule& rule = eventRules[i];
+
+		if (!rule.isActive() || !rule.isFeedback() || rule.getEventId() != id)
+			continue;
+		if (rule.getSwitchId() >= MAX_SWITCHES)
+			continue;
+
+		tracker.confirm(rule.getSwitchId(), rule.turnOn());
+		switches[rule.getSwitchId()].setOn(rule.turnOn());
+		manualSwitches.clear(rule.getSwitchId());
+	}
+}
+
 void applyEventRules(const EventRule& rule, unsigned long id)
 {
-	if (!rule.isActive())
+	if (!rule.isActive() || rule.isFeedback())
 		return;
 
 	if (rule.getEventId() != id)
 		return;
 
+	// no auto-off, a rule with a duration only applies the scene
+	if (rule.getSwitchId() >= SCENE_TARGET) {
+		const Scene* scene = targetScene(rule.getSwitchId());
+		if (!scene)
+			return;
+		if (rule.toggle())
+			applyScene(*scene, !scene->getBatch().isApplied(switchStates()));
+		else
+			applyScene(*scene, rule.turnOn());
+		return;
+	}
+
 	if (rule.getSwitchId() >= MAX_SWITCHES)
 		return;
 
@@ -291,93 +1051,199 @@ void applyEventRules(const EventRule& rule, unsigned long id)
 		doSwitch(sw, !sw.isOn());
 	else
 		doManualSwitch(sw, rule.turnOn());
+
+	if (rule.getDuration()) {
+		byte op = rule.toggle() ? RuleProgram::TOGGLE : 
+			rule.turnOn() ? RuleProgram::SWITCH_OFF : RuleProgram::SWITCH_ON;
+		armAutoOff(rule.getSwitchId(), op, rule.getDuration() * 1000UL);
+	}
 }
 
-void applySchedule(const Schedule& sched)
+// false if every timer is in use
+bool armAutoOff(switch_id_t id, byte op, unsigned long ms)
 {
-	if (!sched.isActive())
-		return;
+	timers.cancel(autoOff[id]);
+	autoOff[id] = timers.add(ms, TIMER_AUTO_OFF | timerTag(id, op));
+	return autoOff[id] != TimerWheel::NONE;
+}
+
+// switch op and id of a timer, decoded in loop()
+uint16_t timerTag(switch_id_t id, byte op)
+{
+	return (op - RuleProgram::SWITCH_ON) << 12 | id;
+}
+
+byte undoOp(byte op)
+{
+	if (op == RuleProgram::SWITCH_ON)
+		return RuleProgram::SWITCH_OFF;
+	if (op == RuleProgram::SWITCH_OFF)
+		return RuleProgram::SWITCH_ON;
+	return op;
+}
+
+bool switchIsOn(switch_id_t id)
+{
+	return id < MAX_SWITCHES && switches[id].isOn();
+}
 
-	if (sched.getSwitchId() >= MAX_SWITCHES)
+float sensorValue(byte id)
+{
+	return id < MAX_SENSORS ? sensors[id]->read() : Sensor::ERROR;
+}
+
+void ruleAction(switch_id_t id, byte op)
+{
+	if (id >= MAX_SWITCHES)
 		return;
 
-	Switch& sw = switches[sched.getSwitchId()];
+	Switch& sw = switches[id];
 
 	if (!sw.isActive())
 		return;
 
-	DateTime curr = time.getTime();
+	if (op == RuleProgram::TOGGLE)
+		doSwitch(sw, !sw.isOn());
+	else
+		doSwitch(sw, op == RuleProgram::SWITCH_ON);
+}
+
+void applySchedule(const Schedule& sched)
+{
+	if (!sched.isActive())
+		return;
+
+	const Scene* scene = targetScene(sched.getSwitchId());
+
+	if (!scene && (sched.getSwitchId() >= MAX_SWITCHES || 
+			!switches[sched.getSwitchId()].isActive()))
+		return;
+
+	DateTime curr = rtc.getTime();
 
 	if (curr < sched.getTime() || !curr.isSameDay(sched.getDays())) 
 		return;
 
 	DateTime from = sched.getTime() % 86400L;
 	DateTime until = (sched.getTime() + sched.getDuration()) % 86400L;
-	DateTime now = time.getTime().getUnix() % 86400L;
+	DateTime now = rtc.getTime().getUnix() % 86400L;
 	
-	bool change = false;
-
 	Sensor* sensor = sched.getSensorId() < MAX_SENSORS ?
 		sensors[sched.getSensorId()] : NULL;
 
-	if (sensor) {
-		if (sensor->read() < sched.getThreshold()) {
-			if  (sched.turnOn() == sw.isOn()) {
-				change = true;
-			}
-		} else if (sched.turnOn() != sw.isOn()) {
-			change = true;
-		}
-	} else if (from < now && now < until) {
-		if  (sched.turnOn() != sw.isOn()) {
-			change = true;
-		}
-	} else if (sched.turnOn() == sw.isOn()) {
-		change = true;
+	// the schedule's action while the sensor is at the threshold or 
+	// inside the time window, the other one otherwise
+	bool on;
+	if (sensor)
+		on = sensor->read() < sched.getThreshold() ? !sched.turnOn() : sched.turnOn();
+	else
+		on = from < now && now < until ? sched.turnOn() : !sched.turnOn();
+
+	// a scene sends only what is not in its state yet
+	if (scene) {
+		applyScene(*scene, on);
+		return;
 	}
 
-	if (change) 
-		doSwitch(sw, !sw.isOn());
+	Switch& sw = switches[sched.getSwitchId()];
+
+	if (on != sw.isOn()) 
+		doSwitch(sw, on);
 }
 
-void handleGetRequest(EthernetClient& client)
+// false for the pages, they only read
+bool handleGetRequest(Client& client)
 {
 	ClientHelper webClient(&client);
 	const char* uri = webClient.getRequestURI('c');
-	DEBUG_PRINT(uri);
+	TRACE(uri);
 
-	if (!uri || strcmp(uri, URI_STATUS) == 0) {
-		sendStatus(client);
-	} else if (strcmp(uri, URI_CONTROL) == 0) {
+	if (uri && strcmp(uri, URI_CONTROL) == 0) {
+		profiler.countRoute(ROUTE_CONTROL);
 		handleControl(client);
+	} else if (uri && strcmp(uri, URI_LOGOUT) == 0) {
+		profiler.countRoute(ROUTE_LOGOUT);
+		handleLogout(client);
+	} else if (uri && strcmp(uri, URI_BATCH) == 0) {
+		profiler.countRoute(ROUTE_BATCH);
+		handleBatch(client);
+	} else {
+		sendPage(client, webClient, uri);
+		return false;
+	}
+	return true;
+}
+
+void sendPage(Client& conn, ClientHelper& webClient, const char* uri)
+{
+	StateView view;
+	const State& st = view.get();
+	BufferedPrint client(conn);
+
+	byte route = ROUTE_OTHER;
+
+	if (!uri || strcmp(uri, URI_STATUS) == 0) {
+		route = ROUTE_STATUS;
+		sendStatus(client, st);
 	} else if (strcmp(uri, URI_MOBILE) == 0) {
-		sendMobile(client);
+		route = ROUTE_MOBILE;
+		sendMobile(client, st);
+	} else if (strcmp(uri, URI_METRICS) == 0) {
+		route = ROUTE_METRICS;
+		sendMetrics(client);
 	} else if (strcmp(uri, URI_FAVICON) == 0) {
 		sendError(client);
-	} else if (!webClient.isAuthorized(webServer.getPassw())) {
+	} else if (strcmp(uri, URI_LOGIN) == 0) {
+		route = ROUTE_LOGIN;
+		sendLogin(client, st);
+	} else if (!webClient.isAuthorized(st.webServer.getPasswDigest(), &st.session)) {
 		sendAuth(client);
 	} else if (strcmp(uri, URI_SWITCH) == 0) {
-		sendSwitches(client);
+		route = ROUTE_SWITCH;
+		sendSwitches(client, st);
 	} else if (strcmp(uri, URI_SCHEDULE) == 0) {
-		sendSchedules(client);
+		route = ROUTE_SCHEDULE;
+		sendSchedules(client, st);
 	} else if (strcmp(uri, URI_EVENT) == 0) {
-		sendEvents(client);
+		route = ROUTE_EVENT;
+		sendEvents(client, st);
 	} else if (strcmp(uri, URI_EVENT_RULES) == 0) {
-		sendEventRules(client);
+		route = ROUTE_EVENT_RULES;
+		sendEventRules(client, st);
 	} else if (strcmp(uri, URI_SETTING) == 0) {
-		sendSettings(client);
+		route = ROUTE_SETTING;
+		sendSettings(client, st);
+	} else if (strcmp(uri, URI_TRACE) == 0) {
+		route = ROUTE_TRACE;
+		sendTrace(client);
+	} else if (strcmp(uri, URI_PROGRAM) == 0) {
+		route = ROUTE_PROGRAM;
+		sendPrograms(client, st);
+	} else if (strcmp(uri, URI_SCENE) == 0) {
+		route = ROUTE_SCENE;
+		sendScenes(client, st);
+	} else if (strcmp(uri, URI_API_EVENTS) == 0) {
+		route = ROUTE_API_EVENTS;
+		sendEventsApi(client, webClient.getQuery());
 	} else {
 		sendError(client);
 	}
+	profiler.countRoute(route);
 }
 
-void handlePostRequest(EthernetClient& client)
+void handlePostRequest(Client& client)
 {
 	ClientHelper webClient(&client);
 	const char* uri = webClient.getRequestURI();
-	DEBUG_PRINT(uri);
+	TRACE(uri);
+	profiler.countRoute(ROUTE_POST);
 
-	if (!webClient.isAuthorized(webServer.getPassw())) {
+	if (strcmp(uri, URI_LOGIN) == 0) {
+		webClient.skipHeader();
+		handleLogin(client);
+		return;
+	}
+	if (!webClient.isAuthorized(webServer.getPasswDigest(), &session)) {
 		sendAuth(client);
 		return;
 	}
@@ -393,68 +1259,219 @@ void handlePostRequest(EthernetClient& client)
 		handleEventRules(client);
 	} else if (strcmp(uri, URI_SCHEDULE) == 0) {
 		handleSchedules(client);
+	} else if (strcmp(uri, URI_LEARN) == 0) {
+		handleLearn(client);
+	} else if (strcmp(uri, URI_PROGRAM) == 0) {
+		handlePrograms(client);
+	} else if (strcmp(uri, URI_SCENE) == 0) {
+		handleScenes(client);
+	} else if (strcmp(uri, URI_RADIO) == 0) {
+		handleRadio(client);
 	} else {
 		sendError(client);
 	}
 }
 
-void handleControl(EthernetClient& client)
+// after=s delays the switch keys that follow, for=s undoes the one 
+// before it that much later, e.g. control?switchon=3&for=600
+void handleControl(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
+	switch_id_t id = Switch::NONE;
+	byte op = 0;
+	unsigned long after = 0;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
-		if (strcmp(key, "switchon") == 0) {
-			byte id = webClient.getValueInt();
+		TRACE(key);
+		if (strcmp(key, "switchon") == 0 || strcmp(key, "switchoff") == 0 ||
+				strcmp(key, "toggle") == 0) {
+			op = key[0] == 't' ? RuleProgram::TOGGLE : 
+				strcmp(key, "switchon") == 0 ? RuleProgram::SWITCH_ON : RuleProgram::SWITCH_OFF;
+			id = webClient.getValueInt();
 			if (id >= switches.getSize())
 				goto ERROR;
-			doManualSwitch(switches[id], true);
-		} else if (strcmp(key, "switchoff") == 0) {
-			byte id = webClient.getValueInt();
-			if (id >= switches.getSize())
+			Switch& sw = switches[id];
+			if (after) {
+				if (timers.add(after, timerTag(id, op)) == TimerWheel::NONE)
+					goto ERROR;
+			} else if (op == RuleProgram::TOGGLE) {
+				doSwitch(sw, !sw.isOn());
+			} else {
+				doManualSwitch(sw, op == RuleProgram::SWITCH_ON);
+			}
+		} else if (strcmp(key, "after") == 0) {
+			after = webClient.getValueInt() * 1000UL;
+		} else if (strcmp(key, "for") == 0) {
+			unsigned long ms = webClient.getValueInt() * 1000UL;
+			if (id >= switches.getSize() || !armAutoOff(id, undoOp(op), after + ms))
 				goto ERROR;
-			doManualSwitch(switches[id], false);
-		} else if (strcmp(key, "toggle") == 0) {
-			byte id = webClient.getValueInt();
-			if (id >= switches.getSize())
+		} else if (strcmp(key, "redirect") == 0) {
+			redirect(client, webClient.getValue());
+			return;
+		} else {
+			webClient.getValue(); // consume value of unknown key
+		}
+	}
+	sendHtmlHeader(client);
+	return;
+ERROR:
+	sendBadConfig(client);
+}
+
+// ids separated by commas or spaces, "+" in a form, or "all" for every
+// active switch, any unknown or inactive one rejects the list
+bool addSwitches(SwitchBatch& batch, const char* list, bool on)
+{
+	if (strcmp(list, "all") == 0) {
+		for (switch_id_t k = 0; k < registry.getCount(); k++)
+			batch.set(registry[k], on);
+		return true;
+	}
+	for (;;) {
+		char* end;
+		long id = strtol(list, &end, 10);
+		if (end == list || id < 0 || !registry.isActive(id))
+			return false;
+		batch.set(id, on);
+		if (*end == '\0')
+			return true;
+		if (*end != ',' && *end != ' ')
+			return false;
+		list = end + 1;
+	}
+}
+
+// control/batch?off=all&on=2,5&scene=1&redirect=status& switches
+// nothing unless every key is valid, later keys win. Switches already
+// in their state are skipped, force=1 sends them anyway, e.g. after
+// they were switched by hand.
+void handleBatch(Client& client)
+{
+	ClientHelper webClient(&client);
+	SwitchBatch batch;
+	bool force = false;
+	char* key = NULL;
+
+	while ((key = webClient.getKey()) != NULL) {
+		TRACE(key);
+		if (strcmp(key, "on") == 0 || strcmp(key, "off") == 0) {
+			bool on = key[1] == 'n';
+			const char* list = webClient.getValueDecoded();
+			if (!list || !addSwitches(batch, list, on))
 				goto ERROR;
-			Switch& sw = switches[id];
-			doSwitch(sw, !sw.isOn());
+		} else if (strcmp(key, "scene") == 0) {
+			int id = webClient.getValueInt();
+			if (id < 0 || id >= scenes.getSize() || !scenes[id].isActive())
+				goto ERROR;
+			batch.merge(scenes[id].getBatch());
+		} else if (strcmp(key, "force") == 0) {
+			force = webClient.getValueInt();
 		} else if (strcmp(key, "redirect") == 0) {
+			// the last key, as for control
+			applyBatch(batch, force);
 			redirect(client, webClient.getValue());
 			return;
 		} else {
 			webClient.getValue(); // consume value of unknown key
 		}
 	}
+	applyBatch(batch, force);
 	sendHtmlHeader(client);
 	return;
 ERROR:
 	sendBadConfig(client);
 }
 
-void handleTime(EthernetClient& client)
+// form login, the user never sees the Basic auth dialog
+void handleLogin(Client& client)
+{
+	ClientHelper webClient(&client);
+	const byte MAX_RAW = WebServer::MAX_PASSW_SIZE / 4 * 3;
+	char user[MAX_RAW+1] = "";
+	char passw[MAX_RAW+1] = "";
+	char* key = NULL;
+
+	while ((key = webClient.getKey()) != NULL) {
+		if (strcmp(key, "user") == 0 || strcmp(key, "passw") == 0) {
+			char* dst = key[0] == 'u' ? user : passw;
+			const char* v = webClient.getValueDecoded();
+			strncpy(dst, v ? v : "", MAX_RAW);
+			dst[MAX_RAW] = '\0';
+		} else {
+			webClient.getValue();
+		}
+	}
+
+	// the stored digest is of base64("user:passw"), as Basic auth sends it
+	char cred[MAX_RAW+1];
+	char base64[WebServer::MAX_PASSW_SIZE+1];
+	byte len = strlen(user) + 1 + strlen(passw);
+	if (len > MAX_RAW) {
+		redirect(client, URI_LOGIN);
+		return;
+	}
+	strcpy(cred, user);
+	strcat(cred, ":");
+	strcat(cred, passw);
+	char* end = Format::base64(base64, cred, len);
+
+	byte hash[Sha256::SIZE];
+	Sha256 sha;
+	sha.update(base64, end - base64);
+	sha.finish(hash);
+	if (!Sha256::equals(hash, webServer.getPasswDigest())) {
+		TRACE_MSG("login failed");
+		redirect(client, URI_LOGIN);
+		return;
+	}
+
+	char token[Session::TOKEN_SIZE+1];
+	session.issue(token);
+	client << F("HTTP/1.0 303 See Other\r\n") << 
+		F("Set-Cookie: ") << Session::COOKIE << '=' << token << 
+		F("; Path=/; Max-Age=") << Session::TTL/1000 << 
+		F("; HttpOnly; SameSite=Strict\r\n") <<
+		F("Location: /") << URI_STATUS <<
+		F("\r\n\r\n");
+}
+
+void handleLogout(Client& client)
+{
+	ClientHelper webClient(&client);
+
+	if (webClient.isAuthorized(webServer.getPasswDigest(), &session) && 
+			webClient.getToken())
+		session.revoke(webClient.getToken());
+
+	client << F("HTTP/1.0 303 See Other\r\n") << 
+		F("Set-Cookie: ") << Session::COOKIE << 
+		F("=; Path=/; Max-Age=0\r\n") <<
+		F("Location: /") << URI_LOGIN <<
+		F("\r\n\r\n");
+}
+
+void handleTime(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
+		TRACE(key);
 		if (strcmp(key, "server") == 0) {
 			IPAddress addr(webClient.getValueIP());
 			if (!(addr == INADDR_NONE))
-				time.setTimeServer(addr);
+				rtc.setTimeServer(addr);
 		} else if (strcmp(key, "interval") == 0) {
 			time_t v = webClient.getValueInt();
 			v *= 3600;
 			if (v < 3600 || v > 864000)	// 1h-10d
 				goto ERROR;
-			time.setSyncInterval(v);
+			rtc.setSyncInterval(v);
 		} else if (strcmp(key, "offset") == 0) {
 			int v = webClient.getValueInt();
 			v *= 3600;
-			time.setOffset(v);
+			rtc.setOffset(v);
 		} else
 			webClient.getValue(); // consume value of unknown key
 	}
@@ -465,7 +1482,29 @@ ERROR:
 	sendBadConfig(client);
 }
 
-void handleServer(EthernetClient& client)
+void handleRadio(Client& client)
+{
+	ClientHelper webClient(&client);
+	char* key = NULL;
+
+	while ((key = webClient.getKey()) != NULL) {
+		TRACE(key);
+		if (strcmp(key, "resync") == 0) {
+			int v = webClient.getValueInt();
+			if (v < 0 || v > Resync::MAX_PERIOD)
+				goto ERROR;
+			resync.setPeriod(v);
+		} else
+			webClient.getValue(); // consume value of unknown key
+	}
+	resyncConf.save();
+	redirect(client, URI_SETTING);
+	return;
+ERROR:
+	sendBadConfig(client);
+}
+
+void handleServer(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
@@ -474,7 +1513,7 @@ void handleServer(EthernetClient& client)
 		clear = false;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
+		TRACE(key);
 		if (strcmp(key, "dhcp") == 0) { // checkbox
 			webClient.getValue();
 			dhcp = true;
@@ -495,8 +1534,9 @@ void handleServer(EthernetClient& client)
 			if (!(addr == INADDR_NONE))
 				webServer.setDNS(addr);
 		} else if (strcmp(key, "host") == 0) { 
-			webServer.setPassw(webClient.getValue());
-			DEBUG_PRINT(webServer.getPassw());
+			// logs every session out, including this one
+			if (webServer.setPassw(webClient.getValueDecoded()))
+				session.begin(webServer.getPasswDigest(), sessionSeed());
 		} else if (strcmp(key, "clear") == 0) {
 			webClient.getValue();
 			clear = true;
@@ -507,9 +1547,9 @@ void handleServer(EthernetClient& client)
 			webClient.getValue(); // consume value of unknown key
 	}
 	if (clear) {
-		eeprom_write_dword(&magic_ee, MAGIC + 5);
+		writeMagic(MAGIC + 5);
 		reboot = true;
-		DEBUG_PRINT("cleared eeprom");
+		TRACE_MSG("cleared eeprom");
 	} else {
 		webServer.setDHCP(dhcp);
 		serverConf.save();
@@ -517,19 +1557,16 @@ void handleServer(EthernetClient& client)
 	if (reboot)
 		reset();
 	redirect(client, URI_SETTING);
-	return;
-ERROR:
-	sendBadConfig(client);
 }
 
-void handleEventRules(EthernetClient& client)
+void handleEventRules(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
 	byte id = 0;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
+		TRACE(key);
 		if (strcmp(key, "id") == 0) {
 			id = webClient.getValueInt();
 			if (id >= eventRules.getSize())
@@ -537,47 +1574,156 @@ void handleEventRules(EthernetClient& client)
 		} else if (strcmp(key, "active") == 0) {
 			eventRules[id].setActive(webClient.getValueInt());
 		} else if (strcmp(key, "name") == 0) {
-			eventRules[id].setName(webClient.getValue());
+			if (!setName(eventRules[id], webClient.getValue())) {
+				sendNamesFull(client);
+				return;
+			}
 		} else if (strcmp(key, "eventId") == 0) {
-			eventRules[id].setEventId(atol(webClient.getValue()));
+			eventRules[id].setEventId(strtoul(webClient.getValue(), NULL, 10));
 		} else if (strcmp(key, "switchId") == 0) {
 			eventRules[id].setSwitchId(webClient.getValueInt());
+		} else if (strcmp(key, "for") == 0) {
+			eventRules[id].setDuration(webClient.getValueInt());
 		} else if (strcmp(key, "action") == 0) {
 			int v = webClient.getValueInt();
-			if (v == 2)
-				eventRules[id].setToggle(true);
-			else
-				eventRules[id].setOn(v);
+			EventRule& rule = eventRules[id];
+			rule.setToggle(v == 2);
+			rule.setFeedback(v >= 3);
+			rule.setOn(v == 1 || v == 3);
 		} else if (strcmp(key, "clearLog") == 0) {
 			if (webClient.getValueInt())
-				eventLog.clear();
+				eventStore.clear();
 		} else
 			webClient.getValue(); // consume value of unknown key
 	}
 	eventRules.save();
+	nameConf.save();
 	redirect(client, URI_EVENT_RULES);
 	return;
 ERROR:
 	sendBadConfig(client);
 }
 
-void handleSwitches(EthernetClient& client)
+void handleLearn(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
+
+	while ((key = webClient.getKey()) != NULL) {
+		TRACE(key);
+		if (strcmp(key, "id") == 0) {
+			int id = webClient.getValueInt();
+			if (id < 0 || id >= eventRules.getSize())
+				goto ERROR;
+			learnRule = id;
+			learnStart = millis();
+		} else
+			webClient.getValue(); // consume value of unknown key
+	}
+	redirect(client, URI_EVENT_RULES);
+	return;
+ERROR:
+	sendBadConfig(client);
+}
+
+// every field but id, active and name goes to the compiler in posted order
+void handlePrograms(Client& client)
+{
+	ClientHelper webClient(&client);
+	RuleCompiler compiler;
+	char* key = NULL;
 	byte id = 0;
-	bool pin = false;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
+		TRACE(key);
 		if (strcmp(key, "id") == 0) {
 			id = webClient.getValueInt();
+			if (id >= programs.getSize())
+				goto ERROR;
+		} else if (strcmp(key, "active") == 0) {
+			programs[id].setActive(webClient.getValueInt());
+		} else if (strcmp(key, "name") == 0) {
+			if (!setName(programs[id], webClient.getValue())) {
+				sendNamesFull(client);
+				return;
+			}
+		} else {
+			// key is overwritten by the value
+			char k[10];
+			strncpy(k, key, sizeof(k)-1);
+			k[sizeof(k)-1] = '\0';
+			compiler.add(k, webClient.getValue());
+		}
+	}
+	if (!compiler.isEmpty() && !compiler.compile(programs[id]))
+		goto ERROR;
+	ruleEngine.cancel(id);
+	programs.save();
+	nameConf.save();
+	redirect(client, URI_PROGRAM);
+	return;
+ERROR:
+	sendBadConfig(client);
+}
+
+// a scene is replaced as a whole, without any switches it is deleted
+void handleScenes(Client& client)
+{
+	ClientHelper webClient(&client);
+	SwitchBatch batch;
+	char* key = NULL;
+	byte id = 0;
+
+	while ((key = webClient.getKey()) != NULL) {
+		TRACE(key);
+		if (strcmp(key, "id") == 0) {
+			id = webClient.getValueInt();
+			if (id >= scenes.getSize())
+				goto ERROR;
+		} else if (strcmp(key, "name") == 0) {
+			if (!setName(scenes[id], webClient.getValue())) {
+				sendNamesFull(client);
+				return;
+			}
+		} else if (strcmp(key, "on") == 0 || strcmp(key, "off") == 0) {
+			bool on = key[1] == 'n';
+			const char* list = webClient.getValueDecoded();
+			if (list && !addSwitches(batch, list, on))
+				goto ERROR;
+		} else
+			webClient.getValue(); // consume value of unknown key
+	}
+	scenes[id].setBatch(batch);
+	scenes.save();
+	nameConf.save();
+	redirect(client, URI_SCENE);
+	return;
+ERROR:
+	sendBadConfig(client);
+}
+
+// an empty id takes a free one
+void handleSwitches(Client& client)
+{
+	ClientHelper webClient(&client);
+	char* key = NULL;
+	switch_id_t id = 0;
+	bool pin = false;
+
+	while ((key = webClient.getKey()) != NULL) {
+		TRACE(key);
+		if (strcmp(key, "id") == 0) {
+			const char* v = webClient.getValue();
+			id = v ? atoi(v) : registry.getFree();
 			if (id >= switches.getSize())
 				goto ERROR;
 		} else if (strcmp(key, "active") == 0) {
 			switches[id].setActive(webClient.getValueInt());
 		} else if (strcmp(key, "name") == 0) {
-			switches[id].setName(webClient.getValue());
+			if (!setName(switches[id], webClient.getValue())) {
+				sendNamesFull(client);
+				return;
+			}
 		} else if (strcmp(key, "group") == 0) {
 			switches[id].setGroup(webClient.getValue());
 		} else if (strcmp(key, "device") == 0) {
@@ -587,28 +1733,37 @@ void handleSwitches(EthernetClient& client)
 			pin = true;
 		} else if (strcmp(key, "pinId") == 0) {
 			switches[id].setId((byte)webClient.getValueInt());
+		} else if (strcmp(key, "fbSensor") == 0) {
+			byte v = webClient.getValueInt();
+			feedback[id].setSensorId(v < MAX_SENSORS ? v : 255);
+		} else if (strcmp(key, "fbLevel") == 0) {
+			feedback[id].setLevel(webClient.getValueFloat());
 		} else
 			webClient.getValue(); // consume value of unknown key
 	}
 	switches[id].setPin(pin);
+	registry.setActive(id, switches[id].isActive());
 	switches.save();
+	feedback.save();
+	nameConf.save();
 	redirect(client, URI_SWITCH);
 	return;
 ERROR:
 	sendBadConfig(client);
 }
 
-void handleSchedules(EthernetClient& client)
+void handleSchedules(Client& client)
 {
 	ClientHelper webClient(&client);
 	char* key = NULL;
-	byte id = 0, swid = 0;
+	byte id = 0;
+	switch_id_t swid = Switch::NONE;
 	bool active = false;
 	Week_t w;
 	w.days = 0;
 
 	while ((key = webClient.getKey()) != NULL) {
-		DEBUG_PRINT(key);
+		TRACE(key);
 		if (strcmp(key, "id") == 0) {
 			id = webClient.getValueInt();
 			if (id >= schedules.getSize())
@@ -617,10 +1772,13 @@ void handleSchedules(EthernetClient& client)
 			active = webClient.getValueInt();
 			schedules[id].setActive(active);
 		} else if (strcmp(key, "name") == 0) {
-			schedules[id].setName(webClient.getValue());
+			if (!setName(schedules[id], webClient.getValue())) {
+				sendNamesFull(client);
+				return;
+			}
 		} else if (strcmp(key, "switch") == 0) {
 			swid = webClient.getValueInt();
-			if (swid < switches.getSize())
+			if (swid < switches.getSize() || targetScene(swid))
 				schedules[id].setSwitchId(swid);
 		} else if (strcmp(key, "sensor") == 0) {
 			byte v = webClient.getValueInt();
@@ -641,7 +1799,7 @@ void handleSchedules(EthernetClient& client)
 			byte min = client.parseInt();
 			DateTime dt(0,min,hour,0,day,month,year);
 			schedules[id].setTime(dt.getUnix());
-			DEBUG_PRINT(dt);
+			TRACE(dt.getUnix());
 		} else if (strcmp(key, "duration") == 0) {
 			time_t v = webClient.getValueInt();
 			v *= 60;
@@ -675,18 +1833,20 @@ void handleSchedules(EthernetClient& client)
 	}
 	if (w.days != 0)
 		schedules[id].setDays(w);
-	switches[swid].setScheduled(active);
+	if (swid < switches.getSize())
+		switches[swid].setScheduled(active);
 	switches.save();
 	schedules.save();
+	nameConf.save();
 	redirect(client, URI_SCHEDULE);
 	return;
 ERROR:
 	sendBadConfig(client);
 }
 
-void sendError(EthernetClient& client)
+void sendError(Print& client)
 {
-	DEBUG_PRINT();
+	TRACE();
 	client << F("HTTP/1.0 400 Bad Request\r\n") << 
 		F("Content-Type: text/html\r\n") << 
 		F("Connection: close\r\n") << 
@@ -697,18 +1857,18 @@ void sendError(EthernetClient& client)
 
 }
 
-void sendHtmlHeader(EthernetClient& client)
+void sendHtmlHeader(Print& client)
 {
-	DEBUG_PRINT();
+	TRACE();
 	client << F("HTTP/1.0 200 OK\r\n") << 
 		F("Content-Type: text/html\r\n") << 
 		F("Connection: close\r\n") << 
 		F("\r\n");
 }
 
-void sendHeader(EthernetClient& client)
+void sendHeader(Print& client)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHtmlHeader(client);
 	client << F("<!DOCTYPE html><html><head><title>HomeControl</title>") <<
 		F("<style type='text/css'>") <<
@@ -724,23 +1884,30 @@ void sendHeader(EthernetClient& client)
 		F("<a href='eventRules'>Rules</a> | ") <<
 		F("<a href='switch'>Switches</a> | ") <<
 		F("<a href='schedule'>Schedules</a> | ") <<
-		F("<a href='setting'>Settings</a><hr></nav>\n");
+		F("<a href='program'>Programs</a> | ") <<
+		F("<a href='scene'>Scenes</a> | ") <<
+		F("<a href='setting'>Settings</a> | ") <<
+		F("<a href='login'>Login</a> | ") <<
+		F("<a href='logout'>Logout</a><hr></nav>\n");
 }
 
-void sendFooter(EthernetClient& client)
+void sendFooter(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
+	MemStat mem = st.memory();
 	client << F("<footer><hr>") <<
 		F("<a href='mobile'>Mobile</a> | <a href='status'>Desktop</a>") <<
-		F("<br>Free RAM: ") << freeRam() <<
-		F("<br>Time: ") << time.getTime() <<
+		F("<br>Free RAM: ") << st.freeMemory() <<
+		F(" (low ") << mem.lowFree <<
+		F(", heap peak ") << mem.heapPeak << ')' <<
+		F("<br>Time: ") << st.now() <<
 		F("<br>Uptime: ") << millis()/1000 <<
 		F("</footer></body></html>\n");
 }
 
-void sendMobile(EthernetClient& client)
+void sendMobile(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHtmlHeader(client);
 	client << F("<!DOCTYPE html><html><head><title>HomeControl</title>") <<
 		F("<meta name='viewport' content='width=device-width, initial-scale=1, maximum-scale=1'>") <<
@@ -752,23 +1919,33 @@ void sendMobile(EthernetClient& client)
 		F("</style></head>") <<
 		F("<body><section id='main'><center>\n");
 
-	for (int i = 0; i < switches.getSize(); i++) {
-		Switch& sw = switches[i];
+	for (switch_id_t k = 0; k < st.registry.getCount(); k++) {
+		switch_id_t i = st.registry[k];
+		const Switch& sw = st.switches[i];
 
-		if (!sw.isActive() || sw.isScheduled())
+		if (sw.isScheduled())
 			continue;
 
 		client << F("<a class='btn") << (sw.isOn() ? " on" : "") <<
 			F("' href='control?toggle=") << i <<
-			F("&redirect=mobile&'>") << sw.getName() << F("</a>\n");
+			F("&redirect=mobile&'>") << st.names.get(sw.getNameId()) << F("</a>\n");
+	}
+	for (int i = 0; i < st.scenes.getSize(); i++) {
+		const Scene& scene = st.scenes[i];
+
+		if (!scene.isActive())
+			continue;
+
+		client << F("<a class='btn' href='control/batch?scene=") << i <<
+			F("&redirect=mobile&'>") << st.names.get(scene.getNameId()) << F("</a>\n");
 	}
 	client << F("</center></section>\n");
-	sendFooter(client);
+	sendFooter(client, st);
 }
 
-void sendStatus(EthernetClient& client)
+void sendStatus(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHeader(client);
 	client << F("<section id='main'><table>") <<
 		F("<tr><th>Id</th><th>Name</th><th>Value</th></tr>");
@@ -777,168 +1954,336 @@ void sendStatus(EthernetClient& client)
 		client << F("<tr><td>") <<
 			i << F("</td><td>") <<
 			sensors[i]->getName() << F("</td><td>") <<
-			sensors[i]->read() << F("</td></tr>\n"); 
+			Fixed(st.readSensor(i)) << F("</td></tr>\n"); 
 	}
 
-	for (int i = 0; i < switches.getSize(); i++) {
-		Switch& sw = switches[i];
-
-		if (!sw.isActive())
-			continue;
+	for (switch_id_t k = 0; k < st.registry.getCount(); k++) {
+		switch_id_t i = st.registry[k];
+		const Switch& sw = st.switches[i];
 
 		client << F("<tr><td>") <<
 			i << F("</td><td>") <<
-			sw.getName() << F("</td><td>") <<
+			st.names.get(sw.getNameId()) << F("</td><td>") <<
 			F("<a href='control?switchon=") << i << F("&redirect=status&'>On</a> | ") <<
 			F("<a href='control?switchoff=") << i << F("&redirect=status&'>Off</a> | ") <<
 			F("<a href='control?toggle=") << i << F("&redirect=status&'>Toggle</a>") <<
 			F("</td></tr>\n");
 	}
+
+	for (int i = 0; i < st.scenes.getSize(); i++) {
+		const Scene& scene = st.scenes[i];
+
+		if (!scene.isActive())
+			continue;
+
+		client << F("<tr><td>Scene ") <<
+			i << F("</td><td>") <<
+			st.names.get(scene.getNameId()) << F("</td><td>") <<
+			F("<a href='control/batch?scene=") << i << F("&redirect=status&'>Apply</a>") <<
+			F("</td></tr>\n");
+	}
 	client << F("</table></section>\n");
-	sendFooter(client);
+	sendFooter(client, st);
+}
+
+const char TPL_SWITCHES[] PROGMEM = 
+	"<section id='main'>"
+	"<form action='/switch' method='POST'>"
+	"<fieldset class='inline-block'><legend>New Switch</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' placeholder='new'>"
+	"<select name='active'><option value='1' selected>Enable</option>"
+	"<option value='0'>Disable</option></select><br>"
+	"<label>Name: </label><input type='text' name='name' value='My Switch'><br>"
+	"<label>Group: </label><input type='text' name='group' value='11111'><br>"
+	"<label>Device: </label><input type='text' name='device' value='10000'><br>"
+	"<label>Pin: </label><input type='checkbox' name='pin'>"
+	" Id: <input type='number' name='pinId' min='14' max='49'><br>"
+	"<label>Feedback: </label>SensorId <input type='number' name='fbSensor' min='0' max='255' value='255'>"
+	" On at <input type='text' name='fbLevel' size='5' value='0'><br>"
+	"<label></label><input type='submit' value='Add'>"
+	"</fieldset></form>\n"
+
+	"<table><tr><th>Id</th><th>Name</th><th>Group</th>"
+	"<th>Device</th><th>Pin</th><th>State</th><th>Feedback</th></tr>\n"
+	TPL_ROWS
+	"<tr><td>" TPL_FIELD(0) "</td><td>" TPL_FIELD(1) "</td><td>" 
+	TPL_FIELD(2) "</td><td>" TPL_FIELD(3) "</td><td>" 
+	TPL_FIELD(4) "</td><td>" TPL_FIELD(5) "</td><td>" 
+	TPL_FIELD(6) "</td></tr>\n"
+	TPL_END
+	"</table></section>\n";
+
+void switchField(Print& client, const State& st, const Switch& sw, uint16_t i, byte field)
+{
+	switch (field) {
+		case 0: client << i; break;
+		case 1: client << st.names.get(sw.getNameId()); break;
+		case 2: client << sw.getGroup(); break;
+		case 3: client << sw.getDevice(); break;
+		case 4: client << (sw.isPin() ? "Yes/" : "No/") << sw.getId(); break;
+		case 5: client << (sw.isOn() ? "On" : "Off"); break;
+		case 6: 
+			if (st.feedback[i].getSensorId() < MAX_SENSORS) {
+				client << F("Sensor ") << st.feedback[i].getSensorId() << 
+					F(" at ") << Fixed(st.feedback[i].getLevel());
+			}
+			break;
+	}
 }
 
-void sendSwitches(EthernetClient& client)
+void sendSwitches(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHeader(client);
-	client << F("<section id='main'>") <<
-		F("<form action='/switch' method='POST'>") <<
-		F("<fieldset class='inline-block'><legend>New Switch</legend>") <<
-		F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>") <<
-		F("<select name='active'><option value='1' selected>Enable</option>") <<
-		F("<option value='0'>Disable</option></select><br>") <<
-		F("<label>Name: </label><input type='text' name='name' value='My Switch'><br>") <<
-		F("<label>Group: </label><input type='text' name='group' value='11111'><br>") <<
-		F("<label>Device: </label><input type='text' name='device' value='10000'><br>") <<
-		F("<label>Pin: </label><input type='checkbox' name='pin'>") <<
-		F(" Id: <input type='number' name='pinId' min='14' max='49'><br>") <<
-		F("<label></label><input type='submit' value='Add'>") <<
-		F("</fieldset></form>\n") <<
-
-		F("<table><tr><th>Id</th><th>Name</th><th>Group</th>") <<
-		F("<th>Device</th><th>Pin</th><th>State</th><th></th></tr>\n");
-
-	for (int i = 0; i < switches.getSize(); i++) {
-		Switch& sw = switches[i];
-
-		if (!sw.isActive())
-			continue;
+	PageTemplate::render(client, TPL_SWITCHES, 
+		registryRows(st.switches, st.registry, st, switchField));
+	sendFooter(client, st);
+}
 
-		client << F("<tr><td>") << 
-			i << F("</td><td>") <<
-			sw.getName() << F("</td><td>") <<
-			sw.getGroup() << F("</td><td>") <<
-			sw.getDevice() << F("</td><td>") <<
-			(sw.isPin() ? "Yes/" : "No/") << sw.getId() << F("</td><td>") <<
-			(sw.isOn() ? "On" : "Off") << F("</td></tr>\n");
+const char TPL_SCHEDULES[] PROGMEM = 
+	"<section id='main'>"
+	"<form action='/schedule' method='POST'>"
+	"<fieldset class='inline-block'><legend>New Schedule</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>"
+	"<select name='active'><option value='1' selected>Enable</option>"
+	"<option value='0'>Disable</option></select><br>"
+	"<label>Name: </label><input type='text' name='name' value='My Schedule'><br>"
+	"<label>Time: </label><input type='datetime-local' autocomplete='on' name='time'><br>"
+	"<label>Duration: </label><input type='number' name='duration' min='1' max='1440' value='60'>min<br>"
+	"Sun <input type='checkbox' name='sun'>"
+	"Mon <input type='checkbox' name='mon'>"
+	"Tue <input type='checkbox' name='tue'>"
+	"Wed <input type='checkbox' name='wed'>"
+	"Thu <input type='checkbox' name='thu'>"
+	"Fri <input type='checkbox' name='fri'>"
+	"Sat <input type='checkbox' name='sat'>"
+	"All <input type='checkbox' name='all'><br>"
+	"<label>SwitchId: </label><input type='number' name='switch' min='0' max='65535' value='65535'><br>"
+	"<label>SensorId: </label><input type='number' name='sensor' min='0' max='255' value='255'><br>"
+	"<label>Threshold: </label><input type='text' name='threshold' value='100'><br>"
+	"<label>Action: </label><select name='on'><option value='1' selected>On</option>"
+	"<option value='0'>Off</option></select><br>"
+	"<label></label><input type='submit' value='Add'>"
+	"</fieldset></form>\n"
+
+	"<table><tr><th>Id</th><th>Name</th><th>Time</th>"
+	"<th>Duration</th><th>Days</th><th>SwitchId</th>"
+	"<th>SensorId</th><th>Threshold</th><th>Action</th></tr>\n"
+	TPL_ROWS
+	"<tr><td>" TPL_FIELD(0) "</td><td>" TPL_FIELD(1) "</td><td>" 
+	TPL_FIELD(2) "</td><td>" TPL_FIELD(3) "</td><td>" 
+	TPL_FIELD(4) "</td><td>" TPL_FIELD(5) "</td><td>" 
+	TPL_FIELD(6) "</td><td>" TPL_FIELD(7) "</td><td>" 
+	TPL_FIELD(8) "</td></tr>\n"
+	TPL_END
+	"</table></section>\n";
+
+void scheduleField(Print& client, const State& st, const Schedule& sched, uint16_t i, byte field)
+{
+	switch (field) {
+		case 0: client << i; break;
+		case 1: client << st.names.get(sched.getNameId()); break;
+		case 2: client << DateTime(sched.getTime()); break;
+		case 3: client << sched.getDuration()/60; break;
+		case 4: client << sched.getDays().days; break;
+		case 5: client << sched.getSwitchId(); break;
+		case 6: client << sched.getSensorId(); break;
+		case 7: client << Fixed(sched.getThreshold()); break;
+		case 8: client << (sched.turnOn() ? "On" : "Off"); break;
 	}
-	client << F("</table></section>\n");
-	sendFooter(client);
 }
 
-void sendSchedules(EthernetClient& client)
+void sendSchedules(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHeader(client);
-	client << F("<section id='main'>") <<
-		F("<form action='/schedule' method='POST'>") <<
-		F("<fieldset class='inline-block'><legend>New Schedule</legend>") <<
-		F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>") <<
-		F("<select name='active'><option value='1' selected>Enable</option>") <<
-		F("<option value='0'>Disable</option></select><br>") <<
-		F("<label>Name: </label><input type='text' name='name' value='My Schedule'><br>") <<
-		F("<label>Time: </label><input type='datetime-local' autocomplete='on' name='time'><br>") <<
-		F("<label>Duration: </label><input type='number' name='duration' min='1' max='1440' value='60'>min<br>") <<
-		F("Sun <input type='checkbox' name='sun'>") <<
-		F("Mon <input type='checkbox' name='mon'>") <<
-		F("Tue <input type='checkbox' name='tue'>") <<
-		F("Wed <input type='checkbox' name='wed'>") <<
-		F("Thu <input type='checkbox' name='thu'>") <<
-		F("Fri <input type='checkbox' name='fri'>") <<
-		F("Sat <input type='checkbox' name='sat'>") <<
-		F("All <input type='checkbox' name='all'><br>") <<
-		F("<label>SwitchId: </label><input type='number' name='switch' min='0' max='255' value='255'><br>") <<
-		F("<label>SensorId: </label><input type='number' name='sensor' min='0' max='255' value='255'><br>") <<
-		F("<label>Threshold: </label><input type='text' name='threshold' value='100'><br>") <<
-		F("<label>Action: </label><select name='on'><option value='1' selected>On</option>") <<
-		F("<option value='0'>Off</option></select><br>") <<
-		F("<label></label><input type='submit' value='Add'>") <<
-		F("</fieldset></form>\n") <<
-
-		F("<table><tr><th>Id</th><th>Name</th><th>Time</th>") <<
-		F("<th>Duration</th><th>Days</th><th>SwitchId</th>") <<
-		F("<th>SensorId</th><th>Threshold</th><th>Action</th></tr>\n");
-
-	for (int i = 0; i < schedules.getSize(); i++) {
-		Schedule& sched = schedules[i];
-
-		if (!sched.isActive())
-			continue;
+	PageTemplate::render(client, TPL_SCHEDULES, arrayRows(st.schedules, st, scheduleField));
+	sendFooter(client, st);
+}
 
-		client << F("<tr><td>") << 
-			i << F("</td><td>") <<
-			sched.getName() << F("</td><td>") <<
-			DateTime(sched.getTime()) << F("</td><td>") <<
-			sched.getDuration()/60 << F("</td><td>") <<
-			sched.getDays().days << F("</td><td>") <<
-			sched.getSwitchId() << F("</td><td>") <<
-			sched.getSensorId() << F("</td><td>") <<
-			sched.getThreshold() << F("</td><td>") <<
-			(sched.turnOn() ? "On" : "Off") << F("</td></tr>\n");
+const char TPL_EVENT_RULE_FORMS[] PROGMEM = 
+	"<section id='main'>"
+	"<form action='/eventRules' method='POST'>"
+	"<fieldset class='inline-block'><legend>New Event Rule</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>"
+	"<select name='active'><option value='1' selected>Enable</option>"
+	"<option value='0'>Disable</option></select><br>"
+	"<label>Name: </label><input type='text' name='name' value='My Rule'><br>"
+	"<label>EventId: </label><input type='text' name='eventId'><br>"
+	"<label>SwitchId: </label><input type='number' name='switchId' min='0' max='65535' value='65535'><br>"
+	"<label>Action: </label><select name='action'><option value='1' selected>On</option>"
+	"<option value='0'>Off</option><option value='2'>Toggle</option>"
+	"<option value='3'>Reports On</option><option value='4'>Reports Off</option></select><br>"
+	"<label>For: </label><input type='number' name='for' min='0' max='65535' value='0'>s<br>"
+	"<label></label><input type='submit' value='Add'>"
+	"</fieldset></form>\n"
+	"<form action='/learn' method='POST'>"
+	"<fieldset class='inline-block'><legend>Learn EventId</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'><br>"
+	"<label></label><input type='submit' value='Learn'>"
+	"</fieldset></form>\n";
+
+const char TPL_EVENT_RULES[] PROGMEM = 
+	"<table><tr><th>Id</th><th>Name</th><th>EventId</th>"
+	"<th>SwitchId</th><th>Toggle</th><th>Action</th><th>For</th></tr>\n"
+	TPL_ROWS
+	"<tr><td>" TPL_FIELD(0) "</td><td>" TPL_FIELD(1) "</td><td>" 
+	TPL_FIELD(2) "</td><td>" TPL_FIELD(3) "</td><td>" 
+	TPL_FIELD(4) "</td><td>" TPL_FIELD(5) "</td><td>" 
+	TPL_FIELD(6) "</td></tr>\n"
+	TPL_END
+	"</table></section>\n";
+
+void eventRuleField(Print& client, const State& st, const EventRule& rule, uint16_t i, byte field)
+{
+	switch (field) {
+		case 0: client << i; break;
+		case 1: client << st.names.get(rule.getNameId()); break;
+		case 2: client << rule.getEventId(); break;
+		case 3: client << rule.getSwitchId(); break;
+		case 4: client << (rule.toggle() ? "Yes" : "No"); break;
+		case 5: 
+			if (rule.isFeedback())
+				client << F("Reports ");
+			client << (rule.turnOn() ? "On" : "Off"); 
+			break;
+		case 6: client << rule.getDuration(); break;
 	}
-	client << F("</table></section>\n");
-	sendFooter(client);
 }
 
-void sendEventRules(EthernetClient& client)
+void sendEventRules(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHeader(client);
-	client << F("<section id='main'>") <<
-		F("<form action='/eventRules' method='POST'>") <<
-		F("<fieldset class='inline-block'><legend>New Event Rule</legend>") <<
-		F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>") <<
-		F("<select name='active'><option value='1' selected>Enable</option>") <<
-		F("<option value='0'>Disable</option></select><br>") <<
-		F("<label>Name: </label><input type='text' name='name' value='My Rule'><br>") <<
-		F("<label>EventId: </label><input type='text' name='eventId'><br>") <<
-		F("<label>SwitchId: </label><input type='number' name='switchId' min='0' max='255' value='255'><br>") <<
-		F("<label>Action: </label><select name='action'><option value='1' selected>On</option>") <<
-		F("<option value='0'>Off</option><option value='2'>Toggle</option></select><br>") <<
-		F("<label></label><input type='submit' value='Add'>") <<
-		F("</fieldset></form>\n") <<
-
-		F("<table><tr><th>Id</th><th>Name</th><th>EventId</th>") <<
-		F("<th>SwitchId</th><th>Toggle</th><th>Action</th></tr>\n");
+	PageTemplate::render(client, TPL_EVENT_RULE_FORMS);
 
-	for (int i = 0; i < eventRules.getSize(); i++) {
-		EventRule& rule = eventRules[i];
+	if (st.learnRule != NO_RULE) {
+		client << F("<p>Press a button on the remote to bind it to rule ") << 
+			st.learnRule << F("</p>\n");
+	}
 
-		if (!rule.isActive())
-			continue;
+	PageTemplate::render(client, TPL_EVENT_RULES, arrayRows(st.eventRules, st, eventRuleField));
+	sendFooter(client, st);
+}
 
-		client << F("<tr><td>") << 
-			i << F("</td><td>") <<
-			rule.getName() << F("</td><td>") <<
-			rule.getEventId() << F("</td><td>") <<
-			rule.getSwitchId() << F("</td><td>") <<
-			(rule.toggle() ? "Yes" : "No") << F("</td><td>") <<
-			(rule.turnOn() ? "On" : "Off") << F("</td></tr>\n");
+const char TPL_PROGRAMS[] PROGMEM = 
+	"<section id='main'>"
+	"<form action='/program' method='POST'>"
+	"<fieldset class='inline-block'><legend>New Program</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>"
+	"<select name='active'><option value='1' selected>Enable</option>"
+	"<option value='0'>Disable</option></select><br>"
+	"<label>Name: </label><input type='text' name='name' value='My Program'><br>"
+	"<label>On EventId: </label><input type='text' name='rf'><br>"
+	"<label>Or At: </label><input type='time' name='at'><br>"
+	"<label>Or SensorId: </label><input type='number' name='sensor' min='0' max='255'>"
+	"<select name='cmp'><option value='1'>Above</option><option value='0'>Below</option></select>"
+	"<input type='text' name='level' size='5'><br>"
+	"<label>If From: </label><input type='time' name='from'>"
+	" Until: <input type='time' name='until'><br>"
+	"Sun <input type='checkbox' name='sun'>"
+	"Mon <input type='checkbox' name='mon'>"
+	"Tue <input type='checkbox' name='tue'>"
+	"Wed <input type='checkbox' name='wed'>"
+	"Thu <input type='checkbox' name='thu'>"
+	"Fri <input type='checkbox' name='fri'>"
+	"Sat <input type='checkbox' name='sat'><br>"
+	"<label>If SwitchId: </label><input type='number' name='ifSwitch' min='0' max='65535'>"
+	"<select name='is'><option value='0'>Off</option><option value='1'>On</option></select><br>"
+	"<label>Then: </label><select name='act'><option value='1' selected>On</option>"
+	"<option value='0'>Off</option><option value='2'>Toggle</option></select>"
+	" SwitchId: <input type='number' name='switch' min='0' max='65535'><br>"
+	"<label>Wait: </label><input type='number' name='wait' min='0' max='65535'>s<br>"
+	"<label>Then: </label><select name='act'><option value='0' selected>Off</option>"
+	"<option value='1'>On</option><option value='2'>Toggle</option></select>"
+	" SwitchId: <input type='number' name='switch' min='0' max='65535'><br>"
+	"<label></label><input type='submit' value='Add'>"
+	"</fieldset></form>\n"
+
+	"<table><tr><th>Id</th><th>Name</th><th>Program</th></tr>\n"
+	TPL_ROWS
+	"<tr><td>" TPL_FIELD(0) "</td><td>" TPL_FIELD(1) "</td><td>" 
+	TPL_FIELD(2) "</td></tr>\n"
+	TPL_END
+	"</table></section>\n";
+
+void programField(Print& client, const State& st, const RuleProgram& prog, uint16_t i, byte field)
+{
+	switch (field) {
+		case 0: client << i; break;
+		case 1: client << st.names.get(prog.getNameId()); break;
+		case 2: client << RuleText(prog); break;
 	}
-	client << F("</table></section>\n");
-	sendFooter(client);
 }
 
-void sendEvents(EthernetClient& client)
+void sendPrograms(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
+	sendHeader(client);
+	PageTemplate::render(client, TPL_PROGRAMS, arrayRows(st.programs, st, programField));
+	sendFooter(client, st);
+}
+
+const char TPL_SCENES[] PROGMEM = 
+	"<section id='main'>"
+	"<form action='/scene' method='POST'>"
+	"<fieldset class='inline-block'><legend>New Scene</legend>"
+	"<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'><br>"
+	"<label>Name: </label><input type='text' name='name' value='My Scene'><br>"
+	"<label>On: </label><input type='text' name='on' placeholder='1 2 5 or all'><br>"
+	"<label>Off: </label><input type='text' name='off' placeholder='3 4'><br>"
+	"<label></label><input type='submit' value='Save'>"
+	"</fieldset></form>\n"
+	"<p>A scene without switches is deleted. Rules and schedules "
+	"apply scene n as SwitchId 1000+n, Off sets the other states.</p>\n"
+
+	"<table><tr><th>Id</th><th>Name</th><th>On</th><th>Off</th><th></th></tr>\n"
+	TPL_ROWS
+	"<tr><td>" TPL_FIELD(0) "</td><td>" TPL_FIELD(1) "</td><td>" 
+	TPL_FIELD(2) "</td><td>" TPL_FIELD(3) "</td><td>"
+	"<a href='control/batch?scene=" TPL_FIELD(0) "&redirect=scene&'>Apply</a>"
+	"</td></tr>\n"
+	TPL_END
+	"</table></section>\n";
+
+// ids of the switches the batch turns on or off, separated by spaces
+void printSwitchIds(Print& client, const SwitchBatch& batch, bool on)
+{
+	for (switch_id_t i = 0; i < SwitchBatch::MAX; i++) {
+		if (batch.has(i) && batch.turnOn(i) == on)
+			client << i << ' ';
+	}
+}
+
+void sceneField(Print& client, const State& st, const Scene& scene, uint16_t i, byte field)
+{
+	switch (field) {
+		case 0: client << i; break;
+		case 1: client << st.names.get(scene.getNameId()); break;
+		case 2: printSwitchIds(client, scene.getBatch(), true); break;
+		case 3: printSwitchIds(client, scene.getBatch(), false); break;
+	}
+}
+
+void sendScenes(Print& client, const State& st)
+{
+	TRACE();
+	sendHeader(client);
+	PageTemplate::render(client, TPL_SCENES, arrayRows(st.scenes, st, sceneField));
+	sendFooter(client, st);
+}
+
+void sendEvents(Print& client, const State& st)
+{
+	TRACE();
 	sendHeader(client);
 	client << F("<section id='main'><table><tr><th>Id</th><th>Time</th></tr>\n");
 
-	for (int i = 0; i < eventLog.getSize(); i++) {
-		Event& ev = eventLog[i];
-		const char* name = getEventName(ev);
+	EventStore::Cursor cursor(eventStore);
+	Event ev;
+
+	while (cursor.next(ev)) {
+		const char* name = getEventName(st, ev);
 
 		client << F("<tr><td>");
 		if (name)
@@ -956,57 +2301,330 @@ void sendEvents(EthernetClient& client)
 		F("<input type='submit' value='Clear'></form>") <<
 		F("</section>\n");
 
-	sendFooter(client);
+	sendFooter(client, st);
+}
+
+// e.g. api/events?since=1700000000&code=1234, oldest first
+void sendEventsApi(Print& client, const char* query)
+{
+	TRACE();
+	unsigned long since = 0;
+	unsigned long code = EventStore::ANY;
+	ClientHelper::getParam(query, "since", since);
+	ClientHelper::getParam(query, "code", code);
+
+	client << F("HTTP/1.0 200 OK\r\n") << 
+		F("Content-Type: application/json\r\n") << 
+		F("Connection: close\r\n") << 
+		F("\r\n[");
+
+	EventStore::Cursor cursor(eventStore, since, code);
+	Event ev;
+	bool first = true;
+
+	while (cursor.next(ev)) {
+		client << (first ? "\n" : ",\n") << 
+			F("{\"time\":") << ev.getTime() << 
+			F(",\"code\":") << ev.getId() << '}';
+		first = false;
+	}
+	client << F("\n]\n");
+}
+
+void sendLogin(Print& client, const State& st)
+{
+	TRACE();
+	sendHeader(client);
+	client << F("<section id='main'>") <<
+		F("<form action='/login' method='POST'>") <<
+		F("<fieldset class='inline-block'><legend>Login</legend>") <<
+		F("<label>User: </label><input type='text' name='user' autocomplete='username'><br>") <<
+		F("<label>Password: </label><input type='password' name='passw' autocomplete='current-password'><br>") <<
+		F("<label></label><input type='submit' value='Login'>") <<
+		F("</fieldset></form></section>\n");
+	sendFooter(client, st);
 }
 
-void sendSettings(EthernetClient& client)
+void sendSettings(Print& client, const State& st)
 {
-	DEBUG_PRINT();
+	TRACE();
 	sendHeader(client);
 	client << F("<section id='main'>") <<
 		F("<form action='/time' method='POST'>") <<
 		F("<fieldset class='inline-block'><legend>Time</legend>") <<
-		F("<label>NTP Server: </label><input type='text' name='server' value='") << time.getTimeServer() << F("'><br>") <<
-		F("<label>Sync Interval: </label><input type='number' name='interval' min='1' max='240' value='") << time.getSyncInterval()/3600 << F("'><br>") <<
-		F("<label>UTC Offset: </label><input type='number' name='offset' min='-12' max='12' value='") << time.getOffset()/3600 << F("'><br>") <<
+		F("<label>NTP Server: </label><input type='text' name='server' value='") << st.time.getTimeServer() << F("'><br>") <<
+		F("<label>Sync Interval: </label><input type='number' name='interval' min='1' max='240' value='") << st.time.getSyncInterval()/3600 << F("'><br>") <<
+		F("<label>UTC Offset: </label><input type='number' name='offset' min='-12' max='12' value='") << st.time.getOffset()/3600 << F("'><br>") <<
+		F("<label></label><input type='submit' value='Save'>") <<
+		F("</fieldset></form>") <<
+
+		F("<form action='/radio' method='POST'>") <<
+		F("<fieldset class='inline-block'><legend>Radio</legend>") <<
+		F("<label>Resync Every: </label><input type='number' name='resync' min='0' max='1440' value='") << st.resync.getPeriod() << F("'>min, 0 for off<br>") <<
 		F("<label></label><input type='submit' value='Save'>") <<
 		F("</fieldset></form>") <<
 
+		F("<fieldset class='inline-block'><legend>Names</legend>") <<
+		st.names.getSlotsFree() << F(" of ") << NAME_POOL_SLOTS << F(" names and ") <<
+		st.names.getFree() << F(" of ") << NAME_POOL_SIZE << F(" characters free,<br>") <<
+		F("records with the same name share it") <<
+		F("</fieldset>") <<
+
 		F("<form action='/server' method='POST'>") <<
 		F("<fieldset class='inline-block'><legend>Server</legend>") <<
-		F("<label>DHCP: </label><input type='checkbox' name='dhcp' ") << (webServer.getDHCP() ? "checked" : "") << F("><br>") <<
-		F("<label>IP Address: </label><input type='text' name='ip' value='") << webServer.getIP() << F("'><br>") <<
-		F("<label>Gateway: </label><input type='text' name='gw' value='") << webServer.getGW() << F("'><br>") <<
-		F("<label>Subnet: </label><input type='text' name='mask' value='") << webServer.getMask() << F("'><br>") <<
-		F("<label>DNS Server: </label><input type='text' name='dns' value='") << webServer.getDNS() << F("'><br>") <<
+		F("<label>DHCP: </label><input type='checkbox' name='dhcp' ") << (st.webServer.getDHCP() ? "checked" : "") << F("><br>") <<
+		F("<label>IP Address: </label><input type='text' name='ip' value='") << st.webServer.getIP() << F("'><br>") <<
+		F("<label>Gateway: </label><input type='text' name='gw' value='") << st.webServer.getGW() << F("'><br>") <<
+		F("<label>Subnet: </label><input type='text' name='mask' value='") << st.webServer.getMask() << F("'><br>") <<
+		F("<label>DNS Server: </label><input type='text' name='dns' value='") << st.webServer.getDNS() << F("'><br>") <<
 		F("<label>Password: </label><input type='password' name='host'><br>") << 
 		F("<label>Clear Settings: </label><input type='checkbox' name='clear'><br>") <<
 		F("<label>Reboot: </label><input type='checkbox' name='reboot'><br>") <<
 		F("<label></label><input type='submit' value='Save'>") <<
 		F("</fieldset></form></section>\n");
 
-	sendFooter(client);
+	sendFooter(client, st);
+}
+
+const __FlashStringHelper* getPhaseName(byte phase)
+{
+	switch (phase) {
+		case Profiler::HTTP: return F("http");
+		case Profiler::RF: return F("rf");
+		case Profiler::RULES: return F("rules");
+		case Profiler::SCHEDULE: return F("schedule");
+		case Profiler::NTP: return F("ntp");
+		case Profiler::ETHERNET: return F("ethernet");
+	}
+	return F("");
+}
+
+const __FlashStringHelper* getMilestoneName(byte milestone)
+{
+	switch (milestone) {
+		case Profiler::BOOT_RADIO: return F("radio");
+		case Profiler::BOOT_CONFIG: return F("config");
+		case Profiler::BOOT_NETWORK: return F("network");
+	}
+	return F("");
 }
 
-void sendBadConfig(EthernetClient& client)
+const char* getRouteName(byte route)
 {
-	DEBUG_PRINT();
+	switch (route) {
+		case ROUTE_STATUS: return URI_STATUS;
+		case ROUTE_MOBILE: return URI_MOBILE;
+		case ROUTE_SWITCH: return URI_SWITCH;
+		case ROUTE_SCHEDULE: return URI_SCHEDULE;
+		case ROUTE_EVENT: return URI_EVENT;
+		case ROUTE_EVENT_RULES: return URI_EVENT_RULES;
+		case ROUTE_SETTING: return URI_SETTING;
+		case ROUTE_METRICS: return URI_METRICS;
+		case ROUTE_TRACE: return URI_TRACE;
+		case ROUTE_CONTROL: return URI_CONTROL;
+		case ROUTE_POST: return "post";
+		case ROUTE_PROGRAM: return URI_PROGRAM;
+		case ROUTE_API_EVENTS: return URI_API_EVENTS;
+		case ROUTE_LOGIN: return URI_LOGIN;
+		case ROUTE_LOGOUT: return URI_LOGOUT;
+		case ROUTE_BATCH: return URI_BATCH;
+		case ROUTE_SCENE: return URI_SCENE;
+	}
+	return "other";
+}
+
+// per radio switch, from the SendTracker
+void sendSwitchCounter(Print& client, const __FlashStringHelper* name, 
+	uint16_t SendTracker::Stats::* count)
+{
+	client << F("# TYPE homecontrol_switch_") << name << F("_total counter\n");
+	for (switch_id_t k = 0; k < registry.getCount(); k++) {
+		switch_id_t i = registry[k];
+		if (switches[i].isPin())
+			continue;
+		client << F("homecontrol_switch_") << name << F("_total{switch=\"") << 
+			i << F("\"} ") << tracker.getStats(i).*count << '\n';
+	}
+}
+
+// Prometheus text format, from the live state and so only in loop()
+void sendMetrics(Print& client)
+{
+	TRACE();
+	memSample();
+	client << F("HTTP/1.0 200 OK\r\n") << 
+		F("Content-Type: text/plain; version=0.0.4\r\n") << 
+		F("Connection: close\r\n") << 
+		F("\r\n");
+
+	client << F("# TYPE homecontrol_uptime_seconds counter\n") <<
+		F("homecontrol_uptime_seconds ") << millis()/1000 << '\n' <<
+		F("# TYPE homecontrol_free_ram_bytes gauge\n") <<
+		F("homecontrol_free_ram_bytes ") << freeRam() << '\n' <<
+		F("# TYPE homecontrol_free_ram_low_bytes gauge\n") <<
+		F("homecontrol_free_ram_low_bytes ") << memStat().lowFree << '\n' <<
+		F("# TYPE homecontrol_heap_peak_bytes gauge\n") <<
+		F("homecontrol_heap_peak_bytes ") << memStat().heapPeak << '\n' <<
+		F("# TYPE homecontrol_stack_untouched_bytes gauge\n") <<
+		F("homecontrol_stack_untouched_bytes ") << Profiler::getStackFree() << '\n' <<
+		F("# TYPE homecontrol_rf_codes_total counter\n") <<
+		F("homecontrol_rf_codes_total ") << 
+			profiler.getCount(Profiler::RF_CODES) << '\n' <<
+		F("# TYPE homecontrol_rf_repeats_total counter\n") <<
+		F("homecontrol_rf_repeats_total ") << 
+			profiler.getCount(Profiler::RF_REPEATS) << '\n' <<
+		F("# TYPE homecontrol_rf_dedup_evictions_total counter\n") <<
+		F("homecontrol_rf_dedup_evictions_total ") << dedup.getEvictions() << '\n' <<
+		F("# TYPE homecontrol_rf_missed_total counter\n") <<
+		F("homecontrol_rf_missed_total ") << receiver.getMissed() << '\n' <<
+		F("# TYPE homecontrol_rf_overruns_total counter\n") <<
+		F("homecontrol_rf_overruns_total ") << receiver.getOverruns() << '\n' <<
+		F("# TYPE homecontrol_rule_runs_total counter\n") <<
+		F("homecontrol_rule_runs_total ") << ruleEngine.getRuns() << '\n' <<
+		F("# TYPE homecontrol_rule_waits gauge\n") <<
+		F("homecontrol_rule_waits ") << ruleEngine.getPending() << '\n' <<
+		F("# TYPE homecontrol_rule_waits_dropped_total counter\n") <<
+		F("homecontrol_rule_waits_dropped_total ") << ruleEngine.getDropped() << '\n' <<
+		F("# TYPE homecontrol_events_stored gauge\n") <<
+		F("homecontrol_events_stored ") << eventStore.getEvents() << '\n' <<
+		F("# TYPE homecontrol_event_codes gauge\n") <<
+		F("homecontrol_event_codes ") << eventStore.getCodes() << '\n' <<
+		F("# TYPE homecontrol_timers gauge\n") <<
+		F("homecontrol_timers ") << timers.getUsed() << '\n' <<
+		F("# TYPE homecontrol_sent_bytes_total counter\n") <<
+		F("homecontrol_sent_bytes_total ") << bytesSent() << '\n' <<
+		F("# TYPE homecontrol_http_admitted_total counter\n") <<
+		F("homecontrol_http_admitted_total ") << limiter.getAdmitted() << '\n' <<
+		F("# TYPE homecontrol_http_rejected_total counter\n") <<
+		F("homecontrol_http_rejected_total{reason=\"client\"} ") << 
+			limiter.getLimited() << '\n' <<
+		F("homecontrol_http_rejected_total{reason=\"budget\"} ") << 
+			limiter.getShed() << '\n' <<
+		F("# TYPE homecontrol_http_limiter_clients gauge\n") <<
+		F("homecontrol_http_limiter_clients ") << limiter.getClients() << '\n' <<
+		F("# TYPE homecontrol_http_limiter_evictions_total counter\n") <<
+		F("homecontrol_http_limiter_evictions_total ") << limiter.getEvictions() << '\n';
+
+	sendSwitchCounter(client, F("commands"), &SendTracker::Stats::commands);
+	sendSwitchCounter(client, F("bursts"), &SendTracker::Stats::bursts);
+	sendSwitchCounter(client, F("confirmed"), &SendTracker::Stats::confirmed);
+	sendSwitchCounter(client, F("retries"), &SendTracker::Stats::retries);
+	sendSwitchCounter(client, F("failed"), &SendTracker::Stats::failed);
+	client << F("# TYPE homecontrol_resync_sends_total counter\n") <<
+		F("homecontrol_resync_sends_total ") << resync.getSent() << '\n';
+	client << F("# TYPE homecontrol_switch_repeat gauge\n");
+	for (switch_id_t k = 0; k < registry.getCount(); k++) {
+		switch_id_t i = registry[k];
+		if (switches[i].isPin())
+			continue;
+		client << F("homecontrol_switch_repeat{switch=\"") << i << F("\"} ") << 
+			tracker.getRepeat(i) << '\n';
+	}
+
+	client << F("# TYPE homecontrol_requests_total counter\n");
+	for (byte r = 0; r < ROUTES; r++) {
+		client << F("homecontrol_requests_total{route=\"") << 
+			getRouteName(r) << F("\"} ") << 
+			profiler.getRouteCount(r) << '\n';
+	}
+
+	client << F("# TYPE homecontrol_phase_microseconds histogram\n");
+	for (byte p = 0; p < Profiler::PHASES; p++) {
+		const Profiler::Timing& t = profiler.getTiming(p);
+		unsigned long n = 0;
+		for (byte b = 0; b < Profiler::BUCKETS; b++) {
+			n += t.hist[b];
+			client << F("homecontrol_phase_microseconds_bucket{phase=\"") << 
+				getPhaseName(p) << F("\",le=\"");
+			if (b < Profiler::BUCKETS-1)
+				client << Profiler::getBucketLimit(b);
+			else
+				client << F("+Inf");
+			client << F("\"} ") << n << '\n';
+		}
+		client << F("homecontrol_phase_microseconds_sum{phase=\"") << 
+				getPhaseName(p) << F("\"} ") << t.sum << '\n' <<
+			F("homecontrol_phase_microseconds_count{phase=\"") << 
+				getPhaseName(p) << F("\"} ") << t.count << '\n';
+	}
+
+	client << F("# TYPE homecontrol_phase_min_microseconds gauge\n");
+	for (byte p = 0; p < Profiler::PHASES; p++) {
+		client << F("homecontrol_phase_min_microseconds{phase=\"") << 
+			getPhaseName(p) << F("\"} ") << profiler.getTiming(p).min << '\n';
+	}
+	client << F("# TYPE homecontrol_phase_avg_microseconds gauge\n");
+	for (byte p = 0; p < Profiler::PHASES; p++) {
+		const Profiler::Timing& t = profiler.getTiming(p);
+		client << F("homecontrol_phase_avg_microseconds{phase=\"") << 
+			getPhaseName(p) << F("\"} ") << 
+			(t.count ? t.sum/t.count : 0) << '\n';
+	}
+	client << F("# TYPE homecontrol_phase_max_microseconds gauge\n");
+	for (byte p = 0; p < Profiler::PHASES; p++) {
+		client << F("homecontrol_phase_max_microseconds{phase=\"") << 
+			getPhaseName(p) << F("\"} ") << profiler.getTiming(p).max << '\n';
+	}
+
+	// ms after reset each stage of setup() and the first passes was done
+	client << F("# TYPE homecontrol_boot_milliseconds gauge\n");
+	for (byte m = 0; m < Profiler::MILESTONES; m++) {
+		if (!profiler.isReached(m))
+			continue;
+		client << F("homecontrol_boot_milliseconds{stage=\"") << 
+			getMilestoneName(m) << F("\"} ") << profiler.getMilestone(m) << '\n';
+	}
+	client << F("# TYPE homecontrol_dhcp_discovers_total counter\n") <<
+		F("homecontrol_dhcp_discovers_total ") << dhcp.getDiscovers() << '\n';
+}
+
+// decode with tools/trace_decode.py
+void sendTrace(Print& client)
+{
+	client << F("HTTP/1.0 200 OK\r\n") << 
+		F("Content-Type: text/plain\r\n") << 
+		F("Connection: close\r\n") << 
+		F("\r\n");
+	traceLog.drain(client);
+}
+
+void sendBadConfig(Client& client)
+{
+	TRACE();
 	sendError(client);
 }
 
-void redirect(EthernetClient& client, const char* uri)
+// the record keeps its old name, see NamePool for the limits
+void sendNamesFull(Client& client)
 {
-	DEBUG_PRINT();
+	TRACE();
+	client << F("HTTP/1.0 507 Insufficient Storage\r\n") << 
+		F("Content-Type: text/html\r\n") << 
+		F("Connection: close\r\n") << 
+		F("\r\n") << 
+		F("<!DOCTYPE html><html><head><title></title></head>") <<
+		F("<body><h1>507 Names Full</h1>") <<
+		F("<p>There is room for ") << NAME_POOL_SLOTS << 
+		F(" different names of ") << NAME_POOL_SIZE << 
+		F(" characters in all. Records with the same name share it.</p>") <<
+		F("</body></html>\n");
+}
+
+void redirect(Client& client, const char* uri)
+{
+	TRACE();
 	client << F("HTTP/1.0 303 See Other\r\n") << 
 		F("Location: /") << uri <<
 		F("\r\n\r\n");
 }
 
-void sendAuth(EthernetClient& client)
+void sendAuth(Print& client)
 {
-	DEBUG_PRINT();
+	TRACE();
 	client << F("HTTP/1.0 401 Authorization Required\r\n") <<
 		F("WWW-Authenticate: Basic realm='HomeControl'\r\n") <<
-		F("\r\n");
+		F("Content-Type: text/html\r\n") << 
+		F("\r\n") <<
+		F("<a href='/login'>Login</a>\n");
 }
 
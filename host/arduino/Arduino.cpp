@@ -0,0 +1,280 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Arduino.h"
+#include "HostBoard.h"
+
+#include <time.h>
+
+
+namespace {
+	// interrupts 0-5 of a Mega and their pins
+	const uint8_t INTERRUPT_PIN[HostBoard::INTERRUPTS] = { 2, 3, 21, 20, 19, 18 };
+	const uint8_t NO_PIN = 0xff;
+
+	bool simulated = false;
+	unsigned long simulatedUs = 0;
+	unsigned long realOffset = 0;
+	struct timespec startTime;
+
+	uint8_t mode[HostBoard::PINS];
+	uint8_t level[HostBoard::PINS];
+	int analog[16] = { 
+		512, 512, 512, 512, 512, 512, 512, 512, 
+		512, 512, 512, 512, 512, 512, 512, 512 
+	};
+
+	void (*isr[HostBoard::INTERRUPTS])();
+	bool pending[HostBoard::INTERRUPTS];
+	bool enabled = true;
+
+	uint8_t radioPin = NO_PIN;
+	unsigned long radioEdges = 0;
+
+	float temperature = 21.5;
+	float humidity = 45;
+
+	void trigger(uint8_t i)
+	{
+		if (!isr[i])
+			return;
+		if (enabled)
+			isr[i]();
+		else
+			pending[i] = true;
+	}
+
+	unsigned long realMicros()
+	{
+		struct timespec now;
+
+		if (startTime.tv_sec == 0 && startTime.tv_nsec == 0)
+			clock_gettime(CLOCK_MONOTONIC, &startTime);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (now.tv_sec - startTime.tv_sec) * 1000000UL + 
+			(now.tv_nsec - startTime.tv_nsec) / 1000;
+	}
+}
+
+unsigned long millis()
+{
+	return micros() / 1000;
+}
+
+unsigned long micros()
+{
+	return simulated ? simulatedUs : realMicros() + realOffset;
+}
+
+void delay(unsigned long ms)
+{
+	if (simulated) {
+		simulatedUs += ms * 1000;
+		return;
+	}
+
+	struct timespec t = { time_t(ms / 1000), long(ms % 1000) * 1000000L };
+	while (nanosleep(&t, &t) != 0)
+		;
+}
+
+// busy waits like the core does, pulses of a few hundred us would
+// take much longer with a sleep
+void delayMicroseconds(unsigned int us)
+{
+	if (simulated) {
+		simulatedUs += us;
+		return;
+	}
+
+	unsigned long start = realMicros();
+	while (realMicros() - start < us)
+		;
+}
+
+void pinMode(uint8_t pin, uint8_t m)
+{
+	if (pin < HostBoard::PINS)
+		mode[pin] = m;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+	if (pin >= HostBoard::PINS)
+		return;
+
+	value = value != LOW;
+	if (mode[pin] != OUTPUT || level[pin] == value) {
+		level[pin] = value;
+		return;
+	}
+	level[pin] = value;
+
+	if (pin == radioPin) {
+		radioEdges++;
+		for (uint8_t i = 0; i < HostBoard::INTERRUPTS; i++)
+			trigger(i);
+	}
+}
+
+int digitalRead(uint8_t pin)
+{
+	return pin < HostBoard::PINS ? level[pin] : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+	return pin < sizeof(analog)/sizeof(*analog) ? analog[pin] : 0;
+}
+
+void attachInterrupt(uint8_t i, void (*handler)(), int)
+{
+	if (i < HostBoard::INTERRUPTS) {
+		isr[i] = handler;
+		pending[i] = false;
+	}
+}
+
+void detachInterrupt(uint8_t i)
+{
+	if (i < HostBoard::INTERRUPTS)
+		isr[i] = NULL;
+}
+
+// like the flags of the chip, one edge per interrupt is kept while 
+// interrupts are off
+void interrupts()
+{
+	enabled = true;
+	for (uint8_t i = 0; i < HostBoard::INTERRUPTS; i++) {
+		if (pending[i]) {
+			pending[i] = false;
+			trigger(i);
+		}
+	}
+}
+
+void noInterrupts()
+{
+	enabled = false;
+}
+
+long random(long howbig)
+{
+	return howbig > 0 ? ::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+	return howsmall < howbig ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+	if (seed)
+		srandom(seed);
+}
+
+
+void HostBoard::useSimulatedClock(unsigned long us)
+{
+	simulated = true;
+	simulatedUs = us;
+}
+
+void HostBoard::useRealClock()
+{
+	if (simulated)
+		realOffset = simulatedUs - realMicros();
+	simulated = false;
+}
+
+bool HostBoard::isSimulatedClock()
+{
+	return simulated;
+}
+
+void HostBoard::advance(unsigned long us)
+{
+	if (simulated)
+		simulatedUs += us;
+}
+
+void HostBoard::setInput(uint8_t pin, uint8_t value)
+{
+	if (pin >= PINS || mode[pin] == OUTPUT)
+		return;
+
+	value = value != LOW;
+	if (level[pin] == value)
+		return;
+	level[pin] = value;
+
+	for (uint8_t i = 0; i < INTERRUPTS; i++) {
+		if (INTERRUPT_PIN[i] == pin)
+			trigger(i);
+	}
+}
+
+void HostBoard::setAnalog(uint8_t pin, int value)
+{
+	if (pin < sizeof(analog)/sizeof(*analog))
+		analog[pin] = value;
+}
+
+uint8_t HostBoard::getOutput(uint8_t pin)
+{
+	return pin < PINS && mode[pin] == OUTPUT ? level[pin] : LOW;
+}
+
+void HostBoard::connectRadio(uint8_t pin)
+{
+	radioPin = pin;
+}
+
+void HostBoard::putEdge(unsigned long us)
+{
+	advance(us);
+	for (uint8_t i = 0; i < INTERRUPTS; i++)
+		trigger(i);
+}
+
+unsigned long HostBoard::getRadioEdges()
+{
+	return radioEdges;
+}
+
+void HostBoard::setTemperature(float t)
+{
+	temperature = t;
+}
+
+void HostBoard::setHumidity(float h)
+{
+	humidity = h;
+}
+
+float HostBoard::getTemperature()
+{
+	return temperature;
+}
+
+float HostBoard::getHumidity()
+{
+	return humidity;
+}
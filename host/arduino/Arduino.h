@@ -0,0 +1,91 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Arduino core for the Linux host build, the parts the sketch and the 
+// library use. Pins, interrupts and the clock are simulated, see 
+// HostBoard.h.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avr/pgmspace.h"
+
+#define ARDUINO 105
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) \
+	((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+inline word makeWord(byte h, byte l)
+{
+	return h << 8 | l;
+}
+
+#define word(h, l) makeWord(h, l)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int analogRead(uint8_t);
+
+void attachInterrupt(uint8_t, void (*)(), int);
+void detachInterrupt(uint8_t);
+void interrupts();
+void noInterrupts();
+
+long random(long);
+long random(long, long);
+void randomSeed(unsigned long);
+
+#include "HardwareSerial.h"
+
+#endif
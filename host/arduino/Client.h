@@ -0,0 +1,44 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include "Stream.h"
+#include "IPAddress.h"
+
+
+class Client : public Stream {
+public:
+	virtual int connect(IPAddress, uint16_t) = 0;
+	virtual int connect(const char*, uint16_t) = 0;
+	virtual size_t write(uint8_t) = 0;
+	virtual size_t write(const uint8_t*, size_t) = 0;
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int read(uint8_t*, size_t) = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+	virtual void stop() = 0;
+	virtual uint8_t connected() = 0;
+	virtual operator bool() = 0;
+
+	using Print::write;
+};
+
+#endif
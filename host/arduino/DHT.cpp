@@ -0,0 +1,52 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DHT.h"
+#include "HostBoard.h"
+
+
+DHT::DHT(uint8_t _pin, uint8_t _type, uint8_t):
+	pin(_pin), type(_type)
+{}
+
+void DHT::begin()
+{
+	pinMode(pin, INPUT);
+}
+
+// a DHT11 reports whole numbers, the others tenths
+float DHT::quantize(float v) const
+{
+	return type == DHT11 ? floor(v) : floor(v * 10) / 10;
+}
+
+float DHT::readTemperature(bool fahrenheit)
+{
+	float t = quantize(HostBoard::getTemperature());
+	return fahrenheit ? convertCtoF(t) : t;
+}
+
+float DHT::readHumidity()
+{
+	return quantize(HostBoard::getHumidity());
+}
+
+float DHT::convertCtoF(float c)
+{
+	return c * 9 / 5 + 32;
+}
@@ -0,0 +1,46 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DHT_H
+#define DHT_H
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT22 22
+#define DHT21 21
+#define AM2301 21
+
+
+// DHT sensor that measures HostBoard::getTemperature() and 
+// getHumidity(), with the resolution of the type.
+class DHT {
+	uint8_t pin;
+	uint8_t type;
+
+	float quantize(float) const;
+public:
+	DHT(uint8_t, uint8_t, uint8_t count = 6);
+
+	void begin();
+	float readTemperature(bool fahrenheit = false);
+	float readHumidity();
+	float convertCtoF(float);
+};
+
+#endif
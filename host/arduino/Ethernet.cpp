@@ -0,0 +1,334 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Ethernet.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace {
+	// W5100 socket states status() reports
+	const uint8_t SOCK_CLOSED = 0x00;
+	const uint8_t SOCK_ESTABLISHED = 0x17;
+
+	IPAddress systemAddress(bool mask)
+	{
+		struct ifaddrs* list;
+		IPAddress addr;
+
+		if (getifaddrs(&list) != 0)
+			return addr;
+
+		for (struct ifaddrs* i = list; i; i = i->ifa_next) {
+			if (!i->ifa_addr || i->ifa_addr->sa_family != AF_INET ||
+					(i->ifa_flags & IFF_LOOPBACK))
+				continue;
+			struct sockaddr* sa = mask ? i->ifa_netmask : i->ifa_addr;
+			addr = uint32_t(((struct sockaddr_in*)sa)->sin_addr.s_addr);
+			break;
+		}
+		freeifaddrs(list);
+		return addr;
+	}
+}
+
+EthernetClass Ethernet;
+
+int EthernetClass::begin(uint8_t*)
+{
+	ip = dns = gateway = subnet = INADDR_NONE;
+	return 1;
+}
+
+void EthernetClass::begin(uint8_t* mac, IPAddress _ip)
+{
+	IPAddress dns(_ip);
+	dns[3] = 1;
+	begin(mac, _ip, dns);
+}
+
+void EthernetClass::begin(uint8_t* mac, IPAddress _ip, IPAddress _dns)
+{
+	IPAddress gateway(_ip);
+	gateway[3] = 1;
+	begin(mac, _ip, _dns, gateway);
+}
+
+void EthernetClass::begin(uint8_t* mac, IPAddress _ip, IPAddress _dns, 
+	IPAddress _gateway)
+{
+	begin(mac, _ip, _dns, _gateway, IPAddress(255, 255, 255, 0));
+}
+
+void EthernetClass::begin(uint8_t*, IPAddress _ip, IPAddress _dns, 
+	IPAddress _gateway, IPAddress _subnet)
+{
+	ip = _ip;
+	dns = _dns;
+	gateway = _gateway;
+	subnet = _subnet;
+}
+
+int EthernetClass::maintain()
+{
+	return 0;
+}
+
+IPAddress EthernetClass::localIP()
+{
+	return uint32_t(ip) ? ip : systemAddress(false);
+}
+
+IPAddress EthernetClass::subnetMask()
+{
+	return uint32_t(ip) ? subnet : systemAddress(true);
+}
+
+IPAddress EthernetClass::gatewayIP()
+{
+	return gateway;
+}
+
+IPAddress EthernetClass::dnsServerIP()
+{
+	return dns;
+}
+
+
+EthernetClient::EthernetClient():
+	fd(-1), pending(-1)
+{}
+
+EthernetClient::EthernetClient(int _fd):
+	fd(_fd), pending(-1)
+{}
+
+uint8_t EthernetClient::status()
+{
+	return fd < 0 ? SOCK_CLOSED : SOCK_ESTABLISHED;
+}
+
+int EthernetClient::getFd() const
+{
+	return fd;
+}
+
+int EthernetClient::connect(IPAddress ip, uint16_t port)
+{
+	struct sockaddr_in addr;
+
+	stop();
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = uint32_t(ip);
+	addr.sin_port = htons(port);
+
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return 0;
+	if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		stop();
+		return 0;
+	}
+	return 1;
+}
+
+int EthernetClient::connect(const char* host, uint16_t port)
+{
+	struct addrinfo hints;
+	struct addrinfo* res;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+
+	if (getaddrinfo(host, NULL, &hints, &res) != 0)
+		return 0;
+	IPAddress ip(uint32_t(((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr));
+	freeaddrinfo(res);
+	return connect(ip, port);
+}
+
+size_t EthernetClient::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t EthernetClient::write(const uint8_t* buf, size_t size)
+{
+	size_t n = 0;
+
+	while (fd >= 0 && n < size) {
+		ssize_t r = send(fd, buf + n, size - n, MSG_NOSIGNAL);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		n += r;
+	}
+	return n;
+}
+
+int EthernetClient::available()
+{
+	int n = 0;
+
+	if (fd < 0)
+		return 0;
+	ioctl(fd, FIONREAD, &n);
+	return n + (pending >= 0);
+}
+
+int EthernetClient::read()
+{
+	uint8_t c;
+
+	if (pending >= 0) {
+		c = pending;
+		pending = -1;
+		return c;
+	}
+	return read(&c, 1) == 1 ? c : -1;
+}
+
+int EthernetClient::read(uint8_t* buf, size_t size)
+{
+	if (fd < 0 || size == 0)
+		return -1;
+
+	size_t n = 0;
+
+	if (pending >= 0) {
+		buf[n++] = pending;
+		pending = -1;
+	}
+
+	ssize_t r = recv(fd, buf + n, size - n, MSG_DONTWAIT);
+	if (r > 0)
+		n += r;
+	else if (r == 0)
+		stop();
+	return n ? int(n) : -1;
+}
+
+int EthernetClient::peek()
+{
+	if (pending < 0)
+		pending = read();
+	return pending;
+}
+
+void EthernetClient::flush()
+{
+	int on = 1;
+
+	if (fd >= 0)
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+void EthernetClient::stop()
+{
+	if (fd < 0)
+		return;
+	close(fd);
+	fd = -1;
+	pending = -1;
+}
+
+uint8_t EthernetClient::connected()
+{
+	if (fd < 0)
+		return 0;
+	if (pending >= 0)
+		return 1;
+
+	uint8_t c;
+	ssize_t r = recv(fd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+	return r != 0;
+}
+
+EthernetClient::operator bool()
+{
+	return fd >= 0;
+}
+
+
+EthernetServer::EthernetServer(uint16_t _port):
+	port(_port), fd(-1)
+{}
+
+void EthernetServer::begin()
+{
+	struct sockaddr_in addr;
+	int on = 1;
+
+	if (fd >= 0)
+		return;
+
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || 
+			listen(fd, 8) != 0) {
+		perror("EthernetServer");
+		close(fd);
+		fd = -1;
+	}
+}
+
+// like the shield, the first call starts listening
+EthernetClient EthernetServer::available()
+{
+	if (fd < 0)
+		begin();
+	if (fd < 0)
+		return EthernetClient();
+
+	int client = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+	return EthernetClient(client);
+}
+
+size_t EthernetServer::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+// the shield sends to every connected client, here none are kept
+size_t EthernetServer::write(const uint8_t*, size_t size)
+{
+	return size;
+}
@@ -0,0 +1,99 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ETHERNET_H
+#define ETHERNET_H
+
+#include "Client.h"
+#include "IPAddress.h"
+#include "Server.h"
+#include "EthernetUdp.h"
+
+
+// The Ethernet shield on the host is the host network. The address 
+// belongs to the system, begin() only records a static configuration, 
+// DHCP is left to the system as well.
+class EthernetClass {
+	IPAddress ip;
+	IPAddress dns;
+	IPAddress gateway;
+	IPAddress subnet;
+public:
+	int begin(uint8_t*);
+	void begin(uint8_t*, IPAddress);
+	void begin(uint8_t*, IPAddress, IPAddress);
+	void begin(uint8_t*, IPAddress, IPAddress, IPAddress);
+	void begin(uint8_t*, IPAddress, IPAddress, IPAddress, IPAddress);
+	int maintain();
+
+	// the configured address, or the first one of the system
+	IPAddress localIP();
+	IPAddress subnetMask();
+	IPAddress gatewayIP();
+	IPAddress dnsServerIP();
+};
+
+extern EthernetClass Ethernet;
+
+
+// TCP connection on a POSIX socket
+class EthernetClient : public Client {
+	int fd;
+	int pending;
+public:
+	EthernetClient();
+	EthernetClient(int);
+
+	uint8_t status();
+	int getFd() const;
+
+	virtual int connect(IPAddress, uint16_t);
+	virtual int connect(const char*, uint16_t);
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+	virtual int available();
+	virtual int read();
+	virtual int read(uint8_t*, size_t);
+	virtual int peek();
+	virtual void flush();
+	virtual void stop();
+	virtual uint8_t connected();
+	virtual operator bool();
+
+	using Print::write;
+};
+
+
+// Listens on the port, available() accepts one waiting connection 
+// without blocking. Unlike on the shield, clients are not shared 
+// between calls, every accepted one has to be stopped.
+class EthernetServer : public Server {
+	uint16_t port;
+	int fd;
+public:
+	EthernetServer(uint16_t);
+
+	EthernetClient available();
+	virtual void begin();
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+
+	using Print::write;
+};
+
+#endif
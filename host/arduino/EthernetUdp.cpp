@@ -0,0 +1,207 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EthernetUdp.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace {
+	// HOMECONTROL_DHCP_PORT moves DHCP to loopback, the server port 67
+	// to its value and the client port 68 to the one after, so a DHCP
+	// stand-in needs no privileges and nothing leaves the host
+	uint16_t dhcpPort(uint16_t port)
+	{
+		const char* env = getenv("HOMECONTROL_DHCP_PORT");
+
+		if (!env || (port != 67 && port != 68))
+			return 0;
+		return atoi(env) + port - 67;
+	}
+}
+
+EthernetUDP::EthernetUDP():
+	fd(-1), outLen(0), outAddr(0), outPort(0), inLen(0), inPos(0),
+	remoteAddr(0), remotePortNumber(0)
+{}
+
+// 0 if the port is taken or needs privileges, e.g. 68 for DHCP
+uint8_t EthernetUDP::begin(uint16_t port)
+{
+	struct sockaddr_in addr;
+	int on = 1;
+
+	stop();
+	fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return 0;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(dhcpPort(port) ? dhcpPort(port) : port);
+
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		stop();
+		return 0;
+	}
+	return 1;
+}
+
+void EthernetUDP::stop()
+{
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+	inLen = inPos = outLen = 0;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+	outAddr = uint32_t(ip);
+	outPort = port;
+	outLen = 0;
+	return fd >= 0;
+}
+
+int EthernetUDP::beginPacket(const char* host, uint16_t port)
+{
+	struct addrinfo hints;
+	struct addrinfo* res;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	if (getaddrinfo(host, NULL, &hints, &res) != 0)
+		return 0;
+	IPAddress ip(uint32_t(((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr));
+	freeaddrinfo(res);
+	return beginPacket(ip, port);
+}
+
+int EthernetUDP::endPacket()
+{
+	struct sockaddr_in addr;
+
+	if (fd < 0)
+		return 0;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = outAddr;
+	addr.sin_port = htons(outPort);
+	if (dhcpPort(outPort)) {
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(dhcpPort(outPort));
+	}
+
+	ssize_t n = sendto(fd, out, outLen, 0, (struct sockaddr*)&addr, sizeof(addr));
+	outLen = 0;
+	return n >= 0;
+}
+
+size_t EthernetUDP::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t EthernetUDP::write(const uint8_t* buf, size_t size)
+{
+	if (size > PACKET_SIZE - outLen)
+		size = PACKET_SIZE - outLen;
+	memcpy(out + outLen, buf, size);
+	outLen += size;
+	return size;
+}
+
+// size of the next packet, 0 if none is waiting, the rest of the 
+// previous one is dropped
+int EthernetUDP::parsePacket()
+{
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+
+	inLen = inPos = 0;
+	if (fd < 0)
+		return 0;
+
+	ssize_t n = recvfrom(fd, in, sizeof(in), 0, (struct sockaddr*)&addr, &len);
+	if (n <= 0)
+		return 0;
+
+	inLen = n;
+	remoteAddr = addr.sin_addr.s_addr;
+	remotePortNumber = ntohs(addr.sin_port);
+	return n;
+}
+
+int EthernetUDP::available()
+{
+	return inLen - inPos;
+}
+
+int EthernetUDP::read()
+{
+	return inPos < inLen ? in[inPos++] : -1;
+}
+
+int EthernetUDP::read(unsigned char* buf, size_t size)
+{
+	size_t n = inLen - inPos < size ? inLen - inPos : size;
+
+	if (n == 0)
+		return -1;
+	memcpy(buf, in + inPos, n);
+	inPos += n;
+	return n;
+}
+
+int EthernetUDP::read(char* buf, size_t size)
+{
+	return read((unsigned char*)buf, size);
+}
+
+int EthernetUDP::peek()
+{
+	return inPos < inLen ? in[inPos] : -1;
+}
+
+void EthernetUDP::flush()
+{
+	inLen = inPos = 0;
+}
+
+IPAddress EthernetUDP::remoteIP()
+{
+	return IPAddress(remoteAddr);
+}
+
+uint16_t EthernetUDP::remotePort()
+{
+	return remotePortNumber;
+}
@@ -0,0 +1,67 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ETHERNET_UDP_H
+#define ETHERNET_UDP_H
+
+#include "IPAddress.h"
+#include "Stream.h"
+
+
+// UDP on a non-blocking POSIX socket. Packets are sent and received as
+// a whole, like the shield does it.
+class EthernetUDP : public Stream {
+	static const int PACKET_SIZE = 1472;
+
+	int fd;
+	uint8_t out[PACKET_SIZE];
+	size_t outLen;
+	uint32_t outAddr;
+	uint16_t outPort;
+	uint8_t in[PACKET_SIZE];
+	size_t inLen;
+	size_t inPos;
+	uint32_t remoteAddr;
+	uint16_t remotePortNumber;
+public:
+	EthernetUDP();
+
+	uint8_t begin(uint16_t);
+	void stop();
+
+	int beginPacket(IPAddress, uint16_t);
+	int beginPacket(const char*, uint16_t);
+	int endPacket();
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+
+	int parsePacket();
+	virtual int available();
+	virtual int read();
+	int read(unsigned char*, size_t);
+	int read(char*, size_t);
+	virtual int peek();
+	virtual void flush();
+
+	IPAddress remoteIP();
+	uint16_t remotePort();
+
+	using Print::write;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HardwareSerial.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+
+namespace {
+	int pending = -1;
+}
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long)
+{
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+}
+
+void HardwareSerial::end()
+{
+	fflush(stdout);
+}
+
+int HardwareSerial::available()
+{
+	return peek() < 0 ? 0 : 1;
+}
+
+int HardwareSerial::read()
+{
+	int c = peek();
+
+	pending = -1;
+	return c;
+}
+
+int HardwareSerial::peek()
+{
+	unsigned char c;
+
+	if (pending < 0 && ::read(STDIN_FILENO, &c, 1) == 1)
+		pending = c;
+	return pending;
+}
+
+void HardwareSerial::flush()
+{
+	fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+	return putchar(c) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+	return fwrite(buffer, 1, size, stdout);
+}
+
+HardwareSerial::operator bool()
+{
+	return true;
+}
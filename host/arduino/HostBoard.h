@@ -0,0 +1,60 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include "Arduino.h"
+
+
+// The simulated board of the host build. The clock runs in real time 
+// until a test takes it over, then it only moves with delay() and 
+// advance(). Pins keep their levels, a level change of an input pin 
+// triggers its interrupt like on a Mega. Edges of the radio pin are 
+// heard by every attached interrupt, the transmitter loops back into 
+// the receiver.
+class HostBoard {
+public:
+	static const uint8_t PINS = 70;
+	static const uint8_t INTERRUPTS = 6;
+
+	static void useSimulatedClock(unsigned long us = 0);
+	// real time again, going on from the simulated time
+	static void useRealClock();
+	static bool isSimulatedClock();
+	static void advance(unsigned long us);
+
+	static void setInput(uint8_t pin, uint8_t level);
+	static void setAnalog(uint8_t pin, int value);
+	static uint8_t getOutput(uint8_t pin);
+
+	// the pin the transmitter sends on, 0xff for none
+	static void connectRadio(uint8_t pin);
+	// a remote sends an edge us after the previous one
+	static void putEdge(unsigned long us);
+	// edges the radio pin has sent so far
+	static unsigned long getRadioEdges();
+
+	// what the DS18B20 and the DHT11 measure
+	static void setTemperature(float);
+	static void setHumidity(float);
+	static float getTemperature();
+	static float getHumidity();
+};
+
+#endif
@@ -0,0 +1,96 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IPAddress.h"
+#include "Print.h"
+
+#include <string.h>
+
+
+IPAddress::IPAddress()
+{
+	memset(address, 0, sizeof(address));
+}
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+	address[0] = a;
+	address[1] = b;
+	address[2] = c;
+	address[3] = d;
+}
+
+IPAddress::IPAddress(uint32_t addr)
+{
+	memcpy(address, &addr, sizeof(address));
+}
+
+IPAddress::IPAddress(const uint8_t* addr)
+{
+	memcpy(address, addr, sizeof(address));
+}
+
+IPAddress::operator uint32_t() const
+{
+	uint32_t addr;
+	memcpy(&addr, address, sizeof(addr));
+	return addr;
+}
+
+bool IPAddress::operator==(const IPAddress& addr) const
+{
+	return memcmp(address, addr.address, sizeof(address)) == 0;
+}
+
+bool IPAddress::operator==(const uint8_t* addr) const
+{
+	return memcmp(address, addr, sizeof(address)) == 0;
+}
+
+uint8_t IPAddress::operator[](int i) const
+{
+	return address[i];
+}
+
+uint8_t& IPAddress::operator[](int i)
+{
+	return address[i];
+}
+
+IPAddress& IPAddress::operator=(const uint8_t* addr)
+{
+	memcpy(address, addr, sizeof(address));
+	return *this;
+}
+
+IPAddress& IPAddress::operator=(uint32_t addr)
+{
+	memcpy(address, &addr, sizeof(address));
+	return *this;
+}
+
+size_t IPAddress::printTo(Print& p) const
+{
+	size_t n = 0;
+
+	for (int i = 0; i < 3; i++) {
+		n += p.print(address[i], DEC);
+		n += p.print('.');
+	}
+	return n + p.print(address[3], DEC);
+}
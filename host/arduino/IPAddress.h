@@ -0,0 +1,51 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IP_ADDRESS_H
+#define IP_ADDRESS_H
+
+#include <stdint.h>
+
+#include "Printable.h"
+
+
+// IPv4 address in network order, as in the Arduino 1.0 core.
+class IPAddress : public Printable {
+	uint8_t address[4];
+public:
+	IPAddress();
+	IPAddress(uint8_t, uint8_t, uint8_t, uint8_t);
+	IPAddress(uint32_t);
+	IPAddress(const uint8_t*);
+
+	operator uint32_t() const;
+	bool operator==(const IPAddress&) const;
+	bool operator==(const uint8_t*) const;
+
+	uint8_t operator[](int) const;
+	uint8_t& operator[](int);
+
+	IPAddress& operator=(const uint8_t*);
+	IPAddress& operator=(uint32_t);
+
+	virtual size_t printTo(Print&) const;
+};
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+#endif
@@ -0,0 +1,138 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OneWire.h"
+#include "HostBoard.h"
+
+
+namespace {
+	const uint8_t ROM[8] = { 0x28, 0x48, 0x4f, 0x4d, 0x45, 0x00, 0x00, 0x00 };
+
+	const uint8_t CONVERT = 0x44;
+	const uint8_t READ_SCRATCHPAD = 0xBE;
+	const uint8_t NONE = 0;
+}
+
+OneWire::OneWire(uint8_t _pin):
+	pin(_pin), searched(false), selected(false), command(NONE), readPos(0)
+{
+	memset(scratchpad, 0, sizeof(scratchpad));
+}
+
+// 1 if a device answered the reset pulse
+uint8_t OneWire::reset()
+{
+	selected = false;
+	command = NONE;
+	return 1;
+}
+
+void OneWire::select(const uint8_t rom[8])
+{
+	uint8_t id[8];
+
+	memcpy(id, ROM, 7);
+	id[7] = crc8(ROM, 7);
+	selected = memcmp(rom, id, sizeof(id)) == 0;
+}
+
+void OneWire::skip()
+{
+	selected = true;
+}
+
+// converting is instant, the scratchpad holds the temperature in 1/16
+// degrees, 12 bit resolution
+void OneWire::write(uint8_t v, uint8_t)
+{
+	if (!selected)
+		return;
+
+	command = v;
+	if (command == CONVERT) {
+		int16_t raw = int16_t(HostBoard::getTemperature() * 16);
+		scratchpad[0] = raw;
+		scratchpad[1] = raw >> 8;
+		scratchpad[2] = 0x4b;
+		scratchpad[3] = 0x46;
+		scratchpad[4] = 0x7f;
+		scratchpad[5] = 0xff;
+		scratchpad[6] = 0x00;
+		scratchpad[7] = 0x10;
+		scratchpad[8] = crc8(scratchpad, 8);
+	} else if (command == READ_SCRATCHPAD) {
+		readPos = 0;
+	}
+}
+
+void OneWire::write_bytes(const uint8_t* buf, uint16_t count, bool power)
+{
+	for (uint16_t i = 0; i < count; i++)
+		write(buf[i], power);
+}
+
+// an idle bus reads as ones
+uint8_t OneWire::read()
+{
+	if (command != READ_SCRATCHPAD || readPos >= sizeof(scratchpad))
+		return 0xff;
+	return scratchpad[readPos++];
+}
+
+void OneWire::read_bytes(uint8_t* buf, uint16_t count)
+{
+	for (uint16_t i = 0; i < count; i++)
+		buf[i] = read();
+}
+
+void OneWire::depower()
+{}
+
+void OneWire::reset_search()
+{
+	searched = false;
+}
+
+uint8_t OneWire::search(uint8_t* newAddr)
+{
+	if (searched)
+		return 0;
+
+	memcpy(newAddr, ROM, 7);
+	newAddr[7] = crc8(ROM, 7);
+	searched = true;
+	return 1;
+}
+
+// Dallas/Maxim CRC-8, polynomial x^8 + x^5 + x^4 + 1
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len)
+{
+	uint8_t crc = 0;
+
+	while (len--) {
+		uint8_t in = *addr++;
+		for (uint8_t i = 0; i < 8; i++) {
+			uint8_t mix = (crc ^ in) & 0x01;
+			crc >>= 1;
+			if (mix)
+				crc ^= 0x8C;
+			in >>= 1;
+		}
+	}
+	return crc;
+}
@@ -0,0 +1,52 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ONE_WIRE_H
+#define ONE_WIRE_H
+
+#include "Arduino.h"
+
+
+// 1-Wire bus with one simulated DS18B20 that reads 
+// HostBoard::getTemperature().
+class OneWire {
+	uint8_t pin;
+	bool searched;
+	bool selected;
+	uint8_t command;
+	uint8_t scratchpad[9];
+	uint8_t readPos;
+public:
+	OneWire(uint8_t);
+
+	uint8_t reset();
+	void select(const uint8_t rom[8]);
+	void skip();
+	void write(uint8_t, uint8_t power = 0);
+	void write_bytes(const uint8_t*, uint16_t, bool power = 0);
+	uint8_t read();
+	void read_bytes(uint8_t*, uint16_t);
+	void depower();
+
+	void reset_search();
+	uint8_t search(uint8_t* newAddr);
+
+	static uint8_t crc8(const uint8_t*, uint8_t);
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Print.h"
+
+#include <math.h>
+#include <string.h>
+
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+	size_t n = 0;
+
+	while (size--)
+		n += write(*buffer++);
+	return n;
+}
+
+size_t Print::write(const char* str)
+{
+	return str ? write((const uint8_t*)str, strlen(str)) : 0;
+}
+
+size_t Print::write(const char* buffer, size_t size)
+{
+	return write((const uint8_t*)buffer, size);
+}
+
+size_t Print::print(const __FlashStringHelper* s)
+{
+	return write(reinterpret_cast<const char*>(s));
+}
+
+size_t Print::print(const char s[])
+{
+	return write(s);
+}
+
+size_t Print::print(char c)
+{
+	return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char b, int base)
+{
+	return print((unsigned long)b, base);
+}
+
+size_t Print::print(int n, int base)
+{
+	return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base)
+{
+	return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base)
+{
+	if (base == 0)
+		return write((uint8_t)n);
+	if (base == 10 && n < 0)
+		return print('-') + printNumber(-(unsigned long)n, 10);
+	return printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+	if (base == 0)
+		return write((uint8_t)n);
+	return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+	return printFloat(n, digits);
+}
+
+size_t Print::print(const Printable& x)
+{
+	return x.printTo(*this);
+}
+
+size_t Print::println(const __FlashStringHelper* s)
+{
+	return print(s) + println();
+}
+
+size_t Print::println(const char s[])
+{
+	return print(s) + println();
+}
+
+size_t Print::println(char c)
+{
+	return print(c) + println();
+}
+
+size_t Print::println(unsigned char b, int base)
+{
+	return print(b, base) + println();
+}
+
+size_t Print::println(int n, int base)
+{
+	return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base)
+{
+	return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base)
+{
+	return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base)
+{
+	return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits)
+{
+	return print(n, digits) + println();
+}
+
+size_t Print::println(const Printable& x)
+{
+	return print(x) + println();
+}
+
+size_t Print::println()
+{
+	return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+	char buf[8 * sizeof(long) + 1];
+	char* str = &buf[sizeof(buf) - 1];
+
+	*str = '\0';
+	if (base < 2)
+		base = 10;
+
+	do {
+		char c = n % base;
+		n /= base;
+		*--str = c < 10 ? c + '0' : c + 'A' - 10;
+	} while (n);
+
+	return write(str);
+}
+
+// rounds to the digits like the Arduino core, "nan", "inf" and "ovf"
+// for what does not fit into an unsigned long
+size_t Print::printFloat(double number, uint8_t digits)
+{
+	if (isnan(number))
+		return print("nan");
+	if (isinf(number))
+		return print("inf");
+	if (number > 4294967040.0 || number < -4294967040.0)
+		return print("ovf");
+
+	size_t n = 0;
+
+	if (number < 0.0) {
+		n += print('-');
+		number = -number;
+	}
+
+	double rounding = 0.5;
+	for (uint8_t i = 0; i < digits; i++)
+		rounding /= 10.0;
+	number += rounding;
+
+	unsigned long whole = (unsigned long)number;
+	double remainder = number - (double)whole;
+	n += print(whole);
+
+	if (digits > 0)
+		n += print('.');
+
+	while (digits-- > 0) {
+		remainder *= 10.0;
+		int digit = int(remainder);
+		n += print(digit);
+		remainder -= digit;
+	}
+	return n;
+}
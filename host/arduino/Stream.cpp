@@ -0,0 +1,186 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Stream.h"
+#include "Arduino.h"
+
+
+namespace {
+	const unsigned long DEFAULT_TIMEOUT = 1000;
+}
+
+Stream::Stream():
+	timeout(DEFAULT_TIMEOUT)
+{}
+
+int Stream::timedRead()
+{
+	unsigned long start = millis();
+
+	do {
+		int c = read();
+		if (c >= 0)
+			return c;
+	} while (millis() - start < timeout);
+	return -1;
+}
+
+int Stream::timedPeek()
+{
+	unsigned long start = millis();
+
+	do {
+		int c = peek();
+		if (c >= 0)
+			return c;
+	} while (millis() - start < timeout);
+	return -1;
+}
+
+// skips to the next digit or minus sign, -1 on timeout
+int Stream::peekNextDigit()
+{
+	for (;;) {
+		int c = timedPeek();
+		if (c < 0 || c == '-' || (c >= '0' && c <= '9'))
+			return c;
+		read();
+	}
+}
+
+void Stream::setTimeout(unsigned long ms)
+{
+	timeout = ms;
+}
+
+bool Stream::find(const char* target)
+{
+	return findUntil(target, strlen(target), NULL, 0);
+}
+
+bool Stream::find(const char* target, size_t length)
+{
+	return findUntil(target, length, NULL, 0);
+}
+
+bool Stream::findUntil(const char* target, const char* terminator)
+{
+	return findUntil(target, strlen(target), terminator, strlen(terminator));
+}
+
+bool Stream::findUntil(const char* target, size_t targetLen, 
+	const char* terminator, size_t termLen)
+{
+	size_t index = 0;
+	size_t termIndex = 0;
+	int c;
+
+	if (targetLen == 0)
+		return true;
+
+	while ((c = timedRead()) >= 0) {
+		if (c != target[index])
+			index = 0;
+		if (c == target[index] && ++index >= targetLen)
+			return true;
+
+		if (termLen > 0 && c == terminator[termIndex]) {
+			if (++termIndex >= termLen)
+				return false;
+		} else {
+			termIndex = 0;
+		}
+	}
+	return false;
+}
+
+long Stream::parseInt()
+{
+	bool negative = false;
+	long value = 0;
+	int c = peekNextDigit();
+
+	if (c < 0)
+		return 0;
+
+	do {
+		if (c == '-')
+			negative = true;
+		else
+			value = value * 10 + c - '0';
+		read();
+		c = timedPeek();
+	} while (c >= '0' && c <= '9');
+
+	return negative ? -value : value;
+}
+
+float Stream::parseFloat()
+{
+	bool negative = false;
+	bool fraction = false;
+	long value = 0;
+	float scale = 1.0;
+	int c = peekNextDigit();
+
+	if (c < 0)
+		return 0;
+
+	do {
+		if (c == '-') {
+			negative = true;
+		} else if (c == '.') {
+			fraction = true;
+		} else if (c >= '0' && c <= '9') {
+			value = value * 10 + c - '0';
+			if (fraction)
+				scale *= 0.1;
+		}
+		read();
+		c = timedPeek();
+	} while ((c >= '0' && c <= '9') || (c == '.' && !fraction));
+
+	float v = fraction ? value * scale : value;
+	return negative ? -v : v;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length)
+{
+	size_t n = 0;
+
+	while (n < length) {
+		int c = timedRead();
+		if (c < 0)
+			break;
+		buffer[n++] = c;
+	}
+	return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length)
+{
+	size_t n = 0;
+
+	while (n < length) {
+		int c = timedRead();
+		if (c < 0 || c == terminator)
+			break;
+		buffer[n++] = c;
+	}
+	return n;
+}
@@ -0,0 +1,55 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+
+// Stream of the Arduino 1.0 core. The parsing functions wait up to the
+// timeout, one second by default, for each character.
+class Stream : public Print {
+	unsigned long timeout;
+
+	int timedRead();
+	int timedPeek();
+	int peekNextDigit();
+protected:
+	Stream();
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+
+	void setTimeout(unsigned long);
+
+	bool find(const char*);
+	bool find(const char*, size_t);
+	bool findUntil(const char*, const char*);
+	bool findUntil(const char*, size_t, const char*, size_t);
+
+	long parseInt();
+	float parseFloat();
+
+	size_t readBytes(char*, size_t);
+	size_t readBytesUntil(char, char*, size_t);
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Wire.h"
+#include "Arduino.h"
+
+#include <time.h>
+
+
+namespace {
+	const uint8_t DS1307_ADDRESS = 0x68;
+	const uint8_t TIME_REGISTERS = 7;
+	const uint8_t CLOCK_HALT = 0x80;
+	// end transmission results
+	const uint8_t SUCCESS = 0;
+	const uint8_t ADDRESS_NACK = 2;
+
+	// the chip: time registers, control and 56 bytes of RAM
+	uint8_t reg[64];
+	uint8_t pointer;
+	// the time the registers were set and the millis() then
+	time_t setTime;
+	unsigned long setMillis;
+	bool started;
+
+	uint8_t bcd(int v)
+	{
+		return v / 10 << 4 | v % 10;
+	}
+
+	int dec(uint8_t v)
+	{
+		return (v >> 4) * 10 + (v & 0x0f);
+	}
+
+	void start()
+	{
+		if (started)
+			return;
+		time_t now = time(NULL);
+		struct tm local;
+		localtime_r(&now, &local);
+		setTime = timegm(&local);
+		setMillis = millis();
+		started = true;
+	}
+
+	// the registers hold the time they were set to, the clock is 
+	// derived from millis() unless it was halted
+	void readTime()
+	{
+		time_t t = setTime;
+
+		if (!(reg[0] & CLOCK_HALT))
+			t += (millis() - setMillis) / 1000;
+
+		struct tm tm;
+		gmtime_r(&t, &tm);
+		reg[0] = (reg[0] & CLOCK_HALT) | bcd(tm.tm_sec);
+		reg[1] = bcd(tm.tm_min);
+		reg[2] = bcd(tm.tm_hour);
+		reg[3] = bcd(tm.tm_wday + 1);
+		reg[4] = bcd(tm.tm_mday);
+		reg[5] = bcd(tm.tm_mon + 1);
+		reg[6] = bcd(tm.tm_year - 100);
+	}
+
+	void writeTime()
+	{
+		struct tm tm;
+
+		memset(&tm, 0, sizeof(tm));
+		tm.tm_sec = dec(reg[0] & ~CLOCK_HALT);
+		tm.tm_min = dec(reg[1]);
+		tm.tm_hour = dec(reg[2] & 0x3f);
+		tm.tm_mday = dec(reg[4]);
+		tm.tm_mon = dec(reg[5]) - 1;
+		tm.tm_year = dec(reg[6]) + 100;
+		setTime = timegm(&tm);
+		setMillis = millis();
+	}
+}
+
+TwoWire Wire;
+
+TwoWire::TwoWire():
+	txAddress(0), txLen(0), rxLen(0), rxPos(0)
+{}
+
+void TwoWire::begin()
+{
+	start();
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	txAddress = address;
+	txLen = 0;
+}
+
+void TwoWire::beginTransmission(int address)
+{
+	beginTransmission((uint8_t)address);
+}
+
+// the first byte sets the register pointer, the rest is written 
+// from there
+uint8_t TwoWire::endTransmission()
+{
+	if (txAddress != DS1307_ADDRESS)
+		return ADDRESS_NACK;
+	if (txLen == 0)
+		return SUCCESS;
+
+	start();
+	readTime();
+	pointer = txBuffer[0] & 0x3f;
+
+	bool timeSet = false;
+	for (uint8_t i = 1; i < txLen; i++) {
+		timeSet |= pointer < TIME_REGISTERS;
+		reg[pointer] = txBuffer[i];
+		pointer = (pointer + 1) & 0x3f;
+	}
+	if (timeSet)
+		writeTime();
+	txLen = 0;
+	return SUCCESS;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+	rxLen = rxPos = 0;
+
+	if (address != DS1307_ADDRESS)
+		return 0;
+
+	start();
+	readTime();
+	if (quantity > BUFFER_SIZE)
+		quantity = BUFFER_SIZE;
+
+	for (uint8_t i = 0; i < quantity; i++) {
+		rxBuffer[rxLen++] = reg[pointer];
+		pointer = (pointer + 1) & 0x3f;
+	}
+	return rxLen;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity)
+{
+	return requestFrom((uint8_t)address, (uint8_t)quantity);
+}
+
+size_t TwoWire::write(uint8_t b)
+{
+	if (txLen >= BUFFER_SIZE)
+		return 0;
+	txBuffer[txLen++] = b;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t* buf, size_t size)
+{
+	size_t n = 0;
+
+	while (n < size && write(buf[n]))
+		n++;
+	return n;
+}
+
+int TwoWire::available()
+{
+	return rxLen - rxPos;
+}
+
+int TwoWire::read()
+{
+	return rxPos < rxLen ? rxBuffer[rxPos++] : -1;
+}
+
+int TwoWire::peek()
+{
+	return rxPos < rxLen ? rxBuffer[rxPos] : -1;
+}
+
+void TwoWire::flush()
+{}
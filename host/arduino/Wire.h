@@ -0,0 +1,59 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TWO_WIRE_H
+#define TWO_WIRE_H
+
+#include "Stream.h"
+
+
+// I2C bus with a simulated DS1307 at 0x68. The clock starts at the 
+// local time of the host and runs with millis().
+class TwoWire : public Stream {
+	static const uint8_t BUFFER_SIZE = 32;
+
+	uint8_t txAddress;
+	uint8_t txBuffer[BUFFER_SIZE];
+	uint8_t txLen;
+	uint8_t rxBuffer[BUFFER_SIZE];
+	uint8_t rxLen;
+	uint8_t rxPos;
+public:
+	TwoWire();
+
+	void begin();
+	void beginTransmission(uint8_t);
+	void beginTransmission(int);
+	uint8_t endTransmission();
+	uint8_t requestFrom(uint8_t, uint8_t);
+	uint8_t requestFrom(int, int);
+
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+	virtual int available();
+	virtual int read();
+	virtual int peek();
+	virtual void flush();
+
+	inline size_t write(int n) { return write((uint8_t)n); }
+	using Print::write;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// The eeprom is the file MappedStorage maps, EEMEM addresses work as
+// well as plain offsets.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MappedStorage.h"
+
+#define E2END 4095
+
+inline uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+	uint8_t v;
+	MappedStorage::read(&v, addr, sizeof(v));
+	return v;
+}
+
+inline uint32_t eeprom_read_dword(const uint32_t* addr)
+{
+	uint32_t v;
+	MappedStorage::read(&v, addr, sizeof(v));
+	return v;
+}
+
+inline void eeprom_read_block(void* data, const void* addr, size_t size)
+{
+	MappedStorage::read(data, addr, size);
+}
+
+inline void eeprom_write_byte(uint8_t* addr, uint8_t v)
+{
+	MappedStorage::write(&v, addr, sizeof(v));
+}
+
+inline void eeprom_write_dword(uint32_t* addr, uint32_t v)
+{
+	MappedStorage::write(&v, addr, sizeof(v));
+}
+
+inline void eeprom_write_block(const void* data, void* addr, size_t size)
+{
+	MappedStorage::write(data, addr, size);
+}
+
+inline void eeprom_update_byte(uint8_t* addr, uint8_t v)
+{
+	if (eeprom_read_byte(addr) != v)
+		eeprom_write_byte(addr, v);
+}
+
+inline void eeprom_update_block(const void* data, void* addr, size_t size)
+{
+	eeprom_write_block(data, addr, size);
+}
+
+#endif
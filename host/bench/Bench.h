@@ -0,0 +1,77 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// Benchmarks of the host build. The runner repeats a BENCH body with a
+// growing count until it takes a while and prints the time per 
+// iteration. A BENCH_REPORT runs once and prints its own results, and
+// may fail() a bound it checks, the runner then exits with 1.
+//
+//   BENCH(formatTimestamp, n)
+//   {
+//   	for (unsigned long i = 0; i < n; i++)
+//   		...
+//   }
+
+#include <Arduino.h>
+
+class Bench {
+	typedef void (*Function)(unsigned long);
+
+	const char* name;
+	Function function;
+	bool report;
+	Bench* next;
+
+	static Bench* first;
+	static Bench* last;
+	static int failures;
+public:
+	Bench(const char*, Function, bool);
+
+	// the benchmarks whose name starts with the prefix, all for NULL
+	static void run(const char*);
+	static void fail(const char*);
+	static int getFailures();
+	// monotonic clock in ns
+	static unsigned long long now();
+	// setup() of the sketch, once per process, on the simulated clock
+	// and with the sketch's server on an ephemeral port
+	static void boot();
+};
+
+// keeps the compiler from dropping a result nobody reads
+template<class T>
+inline void keep(const T& v)
+{
+	__asm__ __volatile__("" : : "g"(&v) : "memory");
+}
+
+#define BENCH(name, n) \
+	void bench_##name(unsigned long); \
+	Bench register_##name(#name, bench_##name, false); \
+	void bench_##name(unsigned long n)
+
+#define BENCH_REPORT(name) \
+	void bench_##name(unsigned long); \
+	Bench register_##name(#name, bench_##name, true); \
+	void bench_##name(unsigned long)
+
+#endif
@@ -0,0 +1,113 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+#include "HostBoard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+void setup();
+
+
+namespace {
+	const unsigned long long MIN_TIME = 200000000ULL;	// ns
+}
+
+Bench* Bench::first = NULL;
+Bench* Bench::last = NULL;
+int Bench::failures = 0;
+
+Bench::Bench(const char* _name, Function _function, bool _report):
+	name(_name), function(_function), report(_report), next(NULL)
+{
+	if (last)
+		last->next = this;
+	else
+		first = this;
+	last = this;
+}
+
+unsigned long long Bench::now()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+void Bench::boot()
+{
+	static bool booted = false;
+
+	if (booted)
+		return;
+	setenv("HOMECONTROL_PORT", "0", 0);
+	HostBoard::useSimulatedClock();
+	setup();
+	booted = true;
+}
+
+void Bench::run(const char* prefix)
+{
+	for (Bench* b = first; b; b = b->next) {
+		if (prefix && strncmp(prefix, b->name, strlen(prefix)) != 0)
+			continue;
+		if (b->report) {
+			printf("%s\n", b->name);
+			b->function(0);
+			continue;
+		}
+
+		unsigned long n = 1;
+		unsigned long long t;
+		for (;;) {
+			unsigned long long start = now();
+			b->function(n);
+			t = now() - start;
+			if (t >= MIN_TIME)
+				break;
+			n *= t < MIN_TIME / 10 ? 10 : 2;
+		}
+		printf("%-32s %12.1f ns %12lu runs\n", b->name, double(t) / n, n);
+	}
+}
+
+void Bench::fail(const char* what)
+{
+	printf("FAIL %s\n", what);
+	failures++;
+}
+
+int Bench::getFailures()
+{
+	return failures;
+}
+
+int main(int argc, char** argv)
+{
+	// the bench tables must not grow the daemon's eeprom file
+	setenv("HOMECONTROL_EEPROM", "HomeControl.bench.eep", 0);
+
+	if (argc < 2)
+		Bench::run(NULL);
+	for (int i = 1; i < argc; i++)
+		Bench::run(argv[i]);
+	return Bench::getFailures() != 0;
+}
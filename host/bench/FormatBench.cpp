@@ -0,0 +1,146 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+
+#include <DateTime.h>
+#include <Format.h>
+#include <Util.h>
+#include <stdio.h>
+
+
+namespace {
+	// counts the writes a value takes, the text is dropped
+	class Sink : public Print {
+	public:
+		unsigned long writes;
+
+		Sink(): writes(0) {}
+
+		virtual size_t write(uint8_t)
+		{
+			writes++;
+			return 1;
+		}
+
+		virtual size_t write(const uint8_t*, size_t n)
+		{
+			writes++;
+			return n;
+		}
+	};
+
+	const char* const DAYS[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
+	size_t printField(Print& p, int value, const char* del)
+	{
+		size_t n = 0;
+		if (value < 10)
+			n += p.print(0);
+		n += p.print(value);
+		if (del)
+			n += p.print(del);
+		return n;
+	}
+
+	// DateTime::printTo before Format, a print per field and delimiter
+	size_t printTimestamp(Print& p, const DateTime& dt)
+	{
+		size_t n = p.print(DAYS[dt.getDayOfWeek() - 1]);
+		n += p.print(" ");
+		n += printField(p, dt.getDay(), ".");
+		n += printField(p, dt.getMonth(), ".");
+		n += printField(p, dt.getYear(), " ");
+		n += printField(p, dt.getHour(), ":");
+		n += printField(p, dt.getMinute(), ":");
+		n += printField(p, dt.getSecond(), NULL);
+		return n;
+	}
+
+	const unsigned int VALUES = 256;
+	DateTime times[VALUES];
+	float readings[VALUES];
+
+	void makeValues()
+	{
+		uint32_t r = 12345;
+		for (unsigned int i = 0; i < VALUES; i++) {
+			r = r * 1103515245 + 12345;
+			times[i] = DateTime(time_t(1400000000 + r % 400000000));
+			readings[i] = int(r >> 8 & 0xFFFF) / 100.0f - 100.0f;
+		}
+	}
+}
+
+// "Sun 02.03.2014 04:05:06" through Format, one write
+BENCH(formatTimestamp, n)
+{
+	Sink sink;
+	makeValues();
+	for (unsigned long i = 0; i < n; i++)
+		sink << times[i % VALUES];
+	keep(sink.writes);
+}
+
+// the same text as the old printTo wrote it
+BENCH(formatTimestampPrints, n)
+{
+	Sink sink;
+	makeValues();
+	for (unsigned long i = 0; i < n; i++)
+		printTimestamp(sink, times[i % VALUES]);
+	keep(sink.writes);
+}
+
+// a sensor value with two decimals through Fixed
+BENCH(formatSensorValue, n)
+{
+	Sink sink;
+	makeValues();
+	for (unsigned long i = 0; i < n; i++)
+		sink << Fixed(readings[i % VALUES], 2);
+	keep(sink.writes);
+}
+
+// the same value through Print::print(double)
+BENCH(formatSensorValuePrint, n)
+{
+	Sink sink;
+	makeValues();
+	for (unsigned long i = 0; i < n; i++)
+		sink.print(readings[i % VALUES], 2);
+	keep(sink.writes);
+}
+
+// writes per value, each a packet or a copy on the board
+BENCH_REPORT(formatWrites)
+{
+	Sink timestamp, timestampPrints, value, valuePrint;
+	makeValues();
+	for (unsigned int i = 0; i < VALUES; i++) {
+		timestamp << times[i];
+		printTimestamp(timestampPrints, times[i]);
+		value << Fixed(readings[i], 2);
+		valuePrint.print(readings[i], 2);
+	}
+	printf("  %-12s %10s %10s\n", "", "Format", "print");
+	printf("  %-12s %10.1f %10.1f\n", "timestamp",
+		double(timestamp.writes) / VALUES, double(timestampPrints.writes) / VALUES);
+	printf("  %-12s %10.1f %10.1f\n", "sensor",
+		double(value.writes) / VALUES, double(valuePrint.writes) / VALUES);
+}
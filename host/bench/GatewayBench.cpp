@@ -0,0 +1,290 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+#include "HostBoard.h"
+
+#include <ClientHelper.h>
+#include <GatewayServer.h>
+#include <Profiler.h>
+#include <RateLimiter.h>
+#include <Util.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+void loop();
+void sendPage(Client&, ClientHelper&, const char*);
+
+// the sketch's
+extern GatewayServer server;
+extern RateLimiter limiter;
+extern Profiler profiler;
+
+
+namespace {
+	const uint16_t FIRST_PORT = 18080;
+	const int CLIENTS = 16;
+	const int WORKERS[] = { 1, 2, 4, 8 };
+	const int MAX_SAMPLES = 100000;
+	const unsigned long long DURATION = 500000000ULL;	// ns per worker count
+	const char REQUEST[] = "GET /status HTTP/1.0\r\nHost: bench\r\n\r\n";
+	// left to loop() by the workers
+	const char METRICS[] = "GET /metrics HTTP/1.0\r\nHost: bench\r\n\r\n";
+	const int FLOODERS = 8;
+	const int ADMITTERS = 2;
+	const unsigned long long FLOOD_TIME = 1000000000ULL;	// ns
+	// a schedule tick that comes due waits for the loop() pass under way
+	const unsigned long long MAX_JITTER = 5000000ULL;		// ns
+
+	struct Load {
+		uint16_t port;
+		unsigned long long end;
+		unsigned latency[MAX_SAMPLES];	// us
+		int count;
+		int errors;
+	};
+
+	Load loads[CLIENTS];
+	unsigned all[CLIENTS * MAX_SAMPLES];
+
+	int compare(const void* a, const void* b)
+	{
+		unsigned x = *static_cast<const unsigned*>(a);
+		unsigned y = *static_cast<const unsigned*>(b);
+		return x < y ? -1 : x > y;
+	}
+
+	// the worker handler of the sketch without its rate limiter, which
+	// would turn away most of a load from a single address
+	bool handler(Client& client)
+	{
+		ClientHelper webClient(&client);
+
+		if (webClient.getRequestType() != ClientHelper::GET)
+			return false;
+		sendPage(client, webClient, webClient.getRequestURI('c'));
+		return true;
+	}
+
+	bool request(uint16_t port, const char* text = REQUEST)
+	{
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+
+		bool ok = connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 &&
+			send(fd, text, strlen(text), MSG_NOSIGNAL) > 0;
+
+		char buf[4096];
+		ssize_t n;
+		size_t total = 0;
+		while (ok && (n = recv(fd, buf, sizeof(buf), 0)) > 0)
+			total += n;
+		close(fd);
+		return ok && total;
+	}
+
+	void* client(void* arg)
+	{
+		Load& load = *static_cast<Load*>(arg);
+
+		while (load.count < MAX_SAMPLES) {
+			unsigned long long start = Bench::now();
+			if (start >= load.end)
+				break;
+			if (request(load.port))
+				load.latency[load.count++] = (Bench::now() - start) / 1000;
+			else
+				load.errors++;
+		}
+		return NULL;
+	}
+
+	volatile bool flooding;
+	// flood threads still running
+	volatile int running;
+
+	void* flood(void* arg)
+	{
+		uint16_t port = *static_cast<uint16_t*>(arg);
+
+		for (unsigned i = 0; flooding; i++)
+			request(port, i % 2 ? METRICS : REQUEST);
+		__sync_fetch_and_sub(&running, 1);
+		return NULL;
+	}
+
+	// many addresses, so buckets are taken over all the time
+	void* admit(void* arg)
+	{
+		uint32_t addr = *static_cast<uint32_t*>(arg);
+
+		while (flooding)
+			limiter.admit(addr++, millis());
+		__sync_fetch_and_sub(&running, 1);
+		return NULL;
+	}
+
+	unsigned long long threadTime()
+	{
+		struct timespec t;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+		return t.tv_sec * 1000000000ULL + t.tv_nsec;
+	}
+
+	struct Passes {
+		unsigned long count;
+		unsigned long long longest;		// ns of work in one pass
+		unsigned long long longestGap;	// ns between passes, with waits for the cpu
+	};
+
+	// loop() for FLOOD_TIME, as a tick comes due at any time it is 
+	// late by at most the pass in progress
+	Passes runLoop()
+	{
+		Passes p = { 0, 0, 0 };
+		unsigned long long end = Bench::now() + FLOOD_TIME;
+		unsigned long long last = Bench::now();
+
+		while (last < end) {
+			unsigned long long start = threadTime();
+			loop();
+			unsigned long long t = threadTime() - start;
+			unsigned long long now = Bench::now();
+			if (t > p.longest)
+				p.longest = t;
+			if (now - last > p.longestGap)
+				p.longestGap = now - last;
+			last = now;
+			p.count++;
+		}
+		return p;
+	}
+
+	void printPasses(const char* load, const Passes& p)
+	{
+		printf("  %-8s %10lu %12.0f %12.0f\n", load, p.count, 
+			p.longest / 1e3, p.longestGap / 1e3);
+	}
+}
+
+// Closed loop load on the gateway server over loopback, CLIENTS 
+// connections at a time, one request per connection, each answered
+// with the status page from the published state.
+BENCH_REPORT(gatewayLoad)
+{
+	uint16_t port = FIRST_PORT;
+
+	Bench::boot();
+	// the servers of this run must not share a port
+	const char* env = getenv("HOMECONTROL_PORT");
+	bool restore = env;
+	char saved[8] = "";
+	if (restore)
+		strncpy(saved, env, sizeof(saved) - 1);
+	unsetenv("HOMECONTROL_PORT");
+	printf("  %-8s %10s %10s %10s %8s\n", "workers", "req/s", "p50 us", "p99 us", "errors");
+
+	for (unsigned w = 0; w < sizeof(WORKERS) / sizeof(WORKERS[0]); w++) {
+		int workers = WORKERS[w];
+
+		// the server threads run until the process ends
+		GatewayServer* server = new GatewayServer(port, handler, workers);
+		if (!server->begin())
+			break;
+
+		pthread_t threads[CLIENTS];
+		unsigned long long start = Bench::now();
+		int errors = 0;
+
+		for (int i = 0; i < CLIENTS; i++) {
+			loads[i].port = port;
+			loads[i].end = start + DURATION;
+			loads[i].count = loads[i].errors = 0;
+			pthread_create(&threads[i], NULL, client, &loads[i]);
+		}
+		int count = 0;
+		for (int i = 0; i < CLIENTS; i++) {
+			pthread_join(threads[i], NULL);
+			memcpy(all + count, loads[i].latency, loads[i].count * sizeof(unsigned));
+			count += loads[i].count;
+			errors += loads[i].errors;
+		}
+		double seconds = (Bench::now() - start) / 1e9;
+
+		qsort(all, count, sizeof(unsigned), compare);
+		if (count)
+			printf("  %-8d %10.0f %10u %10u %8d\n", workers, count / seconds,
+				all[count / 2], all[count * 99 / 100], errors);
+
+		port++;
+	}
+	if (restore)
+		setenv("HOMECONTROL_PORT", saved, 1);
+}
+
+// loop() on the real clock while clients flood the sketch's own server
+// and other threads the rate limiter. The work of the longest pass is
+// checked against MAX_JITTER, in thread cpu time so that the flood 
+// threads sharing the cpus do not count. The wall clock gap is shown
+// beside it.
+BENCH_REPORT(gatewayFlood)
+{
+	Bench::boot();
+	HostBoard::useRealClock();
+	while (!profiler.isReached(Profiler::BOOT_NETWORK))
+		loop();
+	uint16_t port = server.getPort();
+
+	printf("  %-8s %10s %12s %12s\n", "load", "passes", "longest us", "gap us");
+	printPasses("idle", runLoop());
+
+	unsigned long shed = limiter.getShed() + limiter.getLimited();
+	pthread_t threads[FLOODERS + ADMITTERS];
+	uint32_t addrs[ADMITTERS];
+	flooding = true;
+	running = FLOODERS + ADMITTERS;
+	for (int i = 0; i < FLOODERS; i++)
+		pthread_create(&threads[i], NULL, flood, &port);
+	for (int i = 0; i < ADMITTERS; i++) {
+		addrs[i] = 0x0a000000UL + i * 0x10000UL;
+		pthread_create(&threads[FLOODERS + i], NULL, admit, &addrs[i]);
+	}
+	Passes p = runLoop();
+	flooding = false;
+	// the last metrics requests wait for loop()
+	while (running)
+		loop();
+	for (int i = 0; i < FLOODERS + ADMITTERS; i++)
+		pthread_join(threads[i], NULL);
+	printPasses("flood", p);
+	printf("  %lu requests turned away\n", limiter.getShed() + limiter.getLimited() - shed);
+
+	if (p.longest > MAX_JITTER)
+		Bench::fail("gatewayFlood: a loop() pass took longer than MAX_JITTER");
+	HostBoard::useSimulatedClock(micros());
+}
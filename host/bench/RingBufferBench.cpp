@@ -0,0 +1,113 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+
+#include <RingBuffer.h>
+
+
+namespace {
+	// the ring before the masking, indices wrapped with %
+	template<class T, unsigned int sz> class ModuloRing {
+		unsigned int start;
+		unsigned int count;
+		T data[sz];
+	public:
+		ModuloRing(): start(0), count(0) {}
+
+		void put(const T& elem)
+		{
+			data[(start + count) % sz] = elem;
+			if (count == sz)
+				start = (start + 1) % sz;
+			else
+				count++;
+		}
+
+		T& get()
+		{
+			unsigned int i = start;
+			start = (start + 1) % sz;
+			count--;
+			return data[i];
+		}
+
+		unsigned int getSize() const { return count; }
+		T& operator[](unsigned int i) { return data[(start + i) % sz]; }
+	};
+
+	// a put and a get per iteration, the ring kept half full
+	template<class Ring>
+	void putGet(Ring& ring, unsigned long n)
+	{
+		for (byte i = 0; i < 32; i++)
+			ring.put(i);
+		for (unsigned long i = 0; i < n; i++) {
+			ring.put(byte(i));
+			keep(ring.get());
+		}
+	}
+
+	// a sum over every element by index, per element
+	template<class Ring>
+	void indexAll(Ring& ring, unsigned long n)
+	{
+		while (ring.getSize() < 64)
+			ring.put(byte(ring.getSize()));
+		unsigned long sum = 0;
+		for (unsigned long i = 0; i < n; i++)
+			sum += ring[i & 63];
+		keep(sum);
+	}
+}
+
+BENCH(ringPutGet64, n)
+{
+	RingBuffer<byte, 64> ring;
+	putGet(ring, n);
+}
+
+BENCH(ringPutGet64Modulo, n)
+{
+	ModuloRing<byte, 64> ring;
+	putGet(ring, n);
+}
+
+BENCH(ringPutGet100, n)
+{
+	RingBuffer<byte, 100> ring;
+	putGet(ring, n);
+}
+
+BENCH(ringPutGet100Modulo, n)
+{
+	ModuloRing<byte, 100> ring;
+	putGet(ring, n);
+}
+
+BENCH(ringIndex100, n)
+{
+	RingBuffer<byte, 100> ring;
+	indexAll(ring, n);
+}
+
+BENCH(ringIndex100Modulo, n)
+{
+	ModuloRing<byte, 100> ring;
+	indexAll(ring, n);
+}
@@ -0,0 +1,126 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+
+#include <RuleCompiler.h>
+#include <RuleEngine.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+namespace {
+	const int EVENTS = 100000;
+
+	// evening light: rf trigger, weekdays, time window, two conditions, 
+	// two actions
+	const char* const RULE[][2] = {
+		{ "mon", NULL }, { "tue", NULL }, { "wed", NULL }, { "thu", NULL },
+		{ "fri", NULL }, { "from", "18:00" }, { "until", "23:30" },
+		{ "ifSwitch", "2" }, { "is", "0" },
+		{ "sensor", "0" }, { "cmp", "0" }, { "level", "50" },
+		{ "act", "1" }, { "switch", "3" }, { "act", "0" }, { "switch", "4" }
+	};
+
+	TimerWheel timers;
+	RuleProgram programs[RuleEngine::MAX_PROGRAMS];
+	unsigned long actions;
+
+	bool isOn(switch_id_t) { return false; }
+	float sensor(byte) { return 12.5; }
+	void action(switch_id_t, byte) { actions++; }
+
+	// RULE with its own rf id, or one that reads the sensor every minute
+	void compile(RuleProgram& prog, unsigned long id, bool minute)
+	{
+		RuleCompiler compiler;
+		char rf[12];
+		snprintf(rf, sizeof(rf), "%lu", id);
+
+		if (minute) {
+			compiler.add("sensor", "1");
+			compiler.add("cmp", "1");
+			compiler.add("level", "20");
+		} else {
+			compiler.add("rf", rf);
+		}
+		for (byte i = 0; i < sizeof(RULE) / sizeof(RULE[0]); i++)
+			compiler.add(RULE[i][0], RULE[i][1]);
+		compiler.compile(prog);
+		prog.setActive(true);
+	}
+
+	byte length(const RuleProgram& prog)
+	{
+		const byte* code = prog.getCode();
+		byte n = 0;
+
+		while (n < RuleProgram::CODE_SIZE && code[n] != RuleProgram::END)
+			n += RuleProgram::getSize(code[n]);
+		return n;
+	}
+
+	double perEvent(RuleEngine& engine, unsigned long id, const DateTime& now, bool minute)
+	{
+		unsigned long long start = Bench::now();
+		for (int i = 0; i < EVENTS; i++) {
+			if (minute) {
+				// a new minute every call, the window check still holds
+				DateTime t(0, i % 30, 19, 3, 4, 5, 2022);
+				engine.onMinute(t);
+			} else {
+				engine.onCode(id, now);
+			}
+		}
+		return double(Bench::now() - start) / EVENTS;
+	}
+}
+
+// Evaluation cost of the rule programs per event and per rule. A code no
+// rule listens to is only compared with each trigger, a matching one 
+// runs the conditions and actions of its rule.
+BENCH_REPORT(ruleEvaluation)
+{
+	static const byte COUNTS[] = { 1, 8, RuleEngine::MAX_PROGRAMS };
+	DateTime now(0, 15, 19, 3, 4, 5, 2022);	// Tuesday evening
+
+	printf("  %-6s %14s %14s %14s %14s\n", "rules", 
+		"miss ns/rule", "match ns", "minute ns/rule", "code bytes");
+
+	for (byte c = 0; c < sizeof(COUNTS); c++) {
+		byte n = COUNTS[c];
+		RuleEngine engine(timers, isOn, sensor, action);
+
+		for (byte i = 0; i < n; i++)
+			compile(programs[i], 1000 + i, false);
+		byte size = length(programs[0]);
+		engine.begin(programs, n);
+
+		double miss = perEvent(engine, 1, now, false) / n;
+		actions = 0;
+		double match = perEvent(engine, 1000 + n / 2, now, false);
+		keep(actions);
+
+		for (byte i = 0; i < n; i++)
+			compile(programs[i], 0, true);
+		engine.begin(programs, n);
+		double minute = perEvent(engine, 0, now, true) / n;
+
+		printf("  %-6d %14.1f %14.1f %14.1f %14d\n", n, miss, match, minute, size);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+
+#include <SavedArray.h>
+#include <Schedule.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+namespace {
+	// a gateway with thousands of schedules, about 230 KB
+	const uint16_t RECORDS = 16384;
+	const int RUNS = 50;
+
+	EEMEM byte table_ee[sizeof(Schedule) * RECORDS];
+	SavedArray<Schedule, RECORDS> table(&table_ee);
+
+	// the baseline keeps the table in a file read and written whole
+	char whole[sizeof(Schedule) * RECORDS];
+
+	double since(unsigned long long start)
+	{
+		return (Bench::now() - start) / 1000.0 / RUNS;
+	}
+
+	void print(const char* what, double mapped, double file)
+	{
+		printf("  %-20s %10.1f us %10.1f us\n", what, mapped, file);
+	}
+}
+
+// startup and save latency of the mapped eeprom file against reading and
+// writing the whole file, a save changes one record
+BENCH_REPORT(storageLoadSave)
+{
+	char path[] = "/tmp/homecontrol_benchXXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0 || write(fd, whole, sizeof(whole)) != ssize_t(sizeof(whole))) {
+		perror(path);
+		return;
+	}
+	close(fd);
+	table.save();
+
+	unsigned long long start = Bench::now();
+	for (int i = 0; i < RUNS; i++)
+		table.load();
+	double mappedLoad = since(start);
+
+	// reading a record in place instead of loading the table
+	start = Bench::now();
+	for (int i = 0; i < RUNS; i++)
+		keep(table.view()[i * 331 % RECORDS].getDuration());
+	double mappedView = since(start);
+
+	start = Bench::now();
+	for (int i = 0; i < RUNS; i++) {
+		fd = open(path, O_RDONLY);
+		keep(read(fd, whole, sizeof(whole)));
+		close(fd);
+	}
+	double fileLoad = since(start);
+
+	start = Bench::now();
+	for (int i = 0; i < RUNS; i++) {
+		table[i * 331 % RECORDS].setDuration(i + 1);
+		table.save();
+	}
+	double mappedSave = since(start);
+
+	start = Bench::now();
+	for (int i = 0; i < RUNS; i++) {
+		whole[i * 331 % sizeof(whole)]++;
+		fd = open(path, O_WRONLY);
+		keep(write(fd, whole, sizeof(whole)));
+		fdatasync(fd);
+		close(fd);
+	}
+	double fileSave = since(start);
+
+	start = Bench::now();
+	for (int i = 0; i < RUNS; i++)
+		table.save();
+	double mappedClean = since(start);
+
+	unlink(path);
+
+	printf("  %-20s %13s %13s\n", "", "mapped", "whole file");
+	print("load", mappedLoad, fileLoad);
+	print("view one record", mappedView, fileLoad);
+	print("save one record", mappedSave, fileSave);
+	print("save unchanged", mappedClean, fileSave);
+}
@@ -0,0 +1,80 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Bench.h"
+
+#include <Switch.h>
+
+
+namespace {
+	const char* GROUPS[] = { "10101", "01100", "11111", "00010" };
+	const char* DEVICES[] = { "10000", "01000", "00100", "00010" };
+
+	// what switching did per repeat before the code was kept: the DIP
+	// strings rebuilt, turned into a tri-state word and parsed back
+	uint32_t codeFromStrings(const char* group, const char* device, bool on)
+	{
+		char dip[11];
+		char tri[13];
+
+		memcpy(dip, group, 5);
+		memcpy(dip + 5, device, 5);
+		dip[10] = '\0';
+
+		for (byte i = 0; i < 10; i++)
+			tri[i] = dip[i] == '1' ? '0' : 'F';
+		tri[10] = on ? '0' : 'F';
+		tri[11] = on ? 'F' : '0';
+		tri[12] = '\0';
+
+		uint32_t word = 0;
+		for (byte i = 0; tri[i]; i++)
+			word = word << 2 | (tri[i] == 'F' ? 1 : tri[i] == '1' ? 3 : 0);
+		return word;
+	}
+}
+
+// the word sent by doSwitch(), kept in the switch
+BENCH(switchCode, n)
+{
+	Switch sw;
+	sw.setGroup(GROUPS[0]);
+	sw.setDevice(DEVICES[1]);
+
+	for (unsigned long i = 0; i < n; i++)
+		keep(sw.getCode(i & 1));
+}
+
+// the same word built from the DIP strings, the old hot path
+BENCH(switchCodeFromStrings, n)
+{
+	for (unsigned long i = 0; i < n; i++)
+		keep(codeFromStrings(GROUPS[i & 3], DEVICES[i >> 2 & 3], i & 1));
+}
+
+// encoding once when a switch is configured
+BENCH(switchSetAddress, n)
+{
+	Switch sw;
+
+	for (unsigned long i = 0; i < n; i++) {
+		sw.setGroup(GROUPS[i & 3]);
+		sw.setDevice(DEVICES[i >> 2 & 3]);
+		keep(sw);
+	}
+}
@@ -0,0 +1,39 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The controller as a Linux daemon. The eeprom is the file in 
+// HOMECONTROL_EEPROM (default HomeControl.eep), the web server listens 
+// on HOMECONTROL_PORT (default 80).
+
+#include <Arduino.h>
+
+#include <unistd.h>
+
+void setup();
+void loop();
+
+int main()
+{
+	setup();
+	for (;;) {
+		loop();
+		// the board spins, a gateway should not
+		usleep(1000);
+	}
+	return 0;
+}
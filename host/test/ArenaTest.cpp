@@ -0,0 +1,75 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <Arena.h>
+
+
+namespace {
+	// counts its constructions, built only in an arena like Sensor
+	class Probe {
+		double value;
+	public:
+		static int built;
+
+		Probe(double _value): value(_value) { built++; }
+		double getValue() const { return value; }
+
+		void* operator new(size_t, void* p) throw() { return p; }
+		void operator delete(void*) {}
+	};
+
+	int Probe::built = 0;
+
+	bool aligned(const void* p)
+	{
+		return reinterpret_cast<uintptr_t>(p) % ARENA_ALIGN == 0;
+	}
+}
+
+TEST(Arena, allocationsAreAlignedAndCounted)
+{
+	Arena<4 * ARENA_ALIGN> arena;
+	CHECK_EQUAL(0u, arena.getUsed());
+
+	void* a = arena.alloc(1);
+	void* b = arena.alloc(ARENA_ALIGN + 1);
+	CHECK(aligned(a));
+	CHECK(aligned(b));
+	CHECK_EQUAL(static_cast<byte*>(a) + ARENA_ALIGN, static_cast<byte*>(b));
+	CHECK_EQUAL(3u * ARENA_ALIGN, arena.getUsed());
+	CHECK_EQUAL(1u * ARENA_ALIGN, arena.getFree());
+}
+
+TEST(Arena, fullArenaBuildsNothing)
+{
+	Arena<2 * ARENA_SIZEOF(Probe)> arena;
+	Probe::built = 0;
+
+	Probe* first = ARENA_NEW(arena, Probe)(1.5);
+	Probe* second = ARENA_NEW(arena, Probe)(2.5);
+	CHECK(first && second);
+	CHECK_EQUAL(0u, arena.getFree());
+
+	// no space left, the constructor is not run on NULL
+	CHECK(ARENA_NEW(arena, Probe)(3.5) == NULL);
+	CHECK_EQUAL(2, Probe::built);
+	CHECK(first->getValue() == 1.5);
+	CHECK(second->getValue() == 2.5);
+}
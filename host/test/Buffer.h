@@ -0,0 +1,48 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <Print.h>
+#include <string.h>
+
+
+// collects what is printed
+class Buffer : public Print {
+public:
+	char text[1024];
+	size_t len;
+
+	Buffer(): len(0) { text[0] = 0; }
+
+	void clear() { len = 0; text[0] = 0; }
+
+	virtual size_t write(uint8_t c)
+	{
+		if (len + 1 >= sizeof(text))
+			return 0;
+		text[len++] = c;
+		text[len] = 0;
+		return 1;
+	}
+
+	using Print::write;
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+
+#include <DhcpClient.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include <RfProtocol.h>
+#include <Transmitter.h>
+#include <sys/wait.h>
+
+extern DhcpClient dhcp;
+
+
+namespace {
+	const char PORT[] = "16767";	// of the stand-in, the client gets the next one
+	const uint8_t PIN_SEND = 5;
+	const unsigned long AWAY = 61000;	// ms the server is not there
+	const unsigned long DELAY = 2500;	// ms until it answers
+	const byte LEASE = 120;			// s
+	const byte ADDRESS[] = { 10, 0, 0, 42 };
+	const byte COOKIE[] = { 99, 130, 83, 99 };
+	const int PACKET_SIZE = 548;
+	const int OPTIONS = 240;
+
+	// DHCP server that is away at first, and slow once it is there
+	class SlowServer {
+		EthernetUDP udp;
+		byte packet[PACKET_SIZE];
+		byte answer;
+		unsigned long due;
+
+		void send(byte type)
+		{
+			packet[0] = 2;
+			memcpy(packet + 16, ADDRESS, 4);
+			memcpy(packet + OPTIONS - 4, COOKIE, 4);
+			byte options[] = {
+				53, 1, type,
+				54, 4, 10, 0, 0, 1,
+				51, 4, 0, 0, 0, LEASE,
+				1, 4, 255, 255, 255, 0,
+				3, 4, 10, 0, 0, 1,
+				6, 4, 10, 0, 0, 1,
+				255
+			};
+			memcpy(packet + OPTIONS, options, sizeof(options));
+			udp.beginPacket(IPAddress(255, 255, 255, 255), 68);
+			udp.write(packet, OPTIONS + sizeof(options));
+			udp.endPacket();
+		}
+	public:
+		unsigned long requests;
+
+		SlowServer(): answer(0), due(0), requests(0) {}
+
+		void begin() { udp.begin(67); }
+
+		void poll(unsigned long now)
+		{
+			if (udp.parsePacket() > 0) {
+				memset(packet, 0, sizeof(packet));
+				udp.read(packet, sizeof(packet));
+				byte type = packet[OPTIONS] == 53 ? packet[OPTIONS + 2] : 0;
+				if (type == 3)
+					requests++;
+				if (now >= AWAY && (type == 1 || type == 3)) {
+					answer = type == 1 ? 2 : 5;
+					due = now + DELAY;
+				}
+			}
+			if (answer && now >= due) {
+				send(answer);
+				answer = 0;
+			}
+		}
+	};
+
+	// what the child saw of its boot
+	struct Seen {
+		bool switched;		// by a rule, before the lease
+		bool scheduled;		// by a schedule, before the lease
+		bool early;			// the server started without an address
+		unsigned long leased;	// ms
+		bool applied;
+		unsigned long renewals;
+		bool kept;			// the address, across the renewal
+	};
+
+	Switch& addSwitch(switch_id_t id)
+	{
+		Switch& sw = switches[id];
+		sw.setGroup("10101");
+		sw.setDevice(id == 1 ? "01000" : "00100");
+		sw.setActive(true);
+		sw.setOn(false);
+		registry.setActive(id, true);
+		return sw;
+	}
+
+	void pass(SlowServer& server)
+	{
+		loop();
+		server.poll(millis());
+		HostBoard::advance(10000);
+	}
+
+	// a reset with DHCP against the stand-in, in the child
+	void boot(Seen& seen)
+	{
+		memset(&seen, 0, sizeof(seen));
+		setenv("HOMECONTROL_DHCP_PORT", PORT, 1);
+		setenv("HOMECONTROL_PORT", "0", 0);
+		HostBoard::useSimulatedClock(1000000);
+		HostBoard::connectRadio(PIN_SEND);
+		SlowServer server;
+		server.begin();
+		setup();
+		// the schedules load on the first passes of a later boot
+		while (!profiler.isReached(Profiler::BOOT_CONFIG))
+			pass(server);
+
+		// a rule that toggles a switch on the remote, and a schedule
+		// that is on while the temperature stays below its threshold
+		Switch& ruled = addSwitch(1);
+		Switch& scheduled = addSwitch(2);
+		RfCode code = { 1, 8, 0x5AUL };
+		EventRule& rule = eventRules[0];
+		rule.setEventId(code.getId());
+		rule.setSwitchId(1);
+		rule.setToggle(true);
+		rule.setActive(true);
+		Schedule& sched = schedules[0];
+		Week_t days;
+		days.days = 0xff;
+		sched.setDays(days);
+		sched.setSwitchId(2);
+		sched.setSensorId(0);
+		sched.setThreshold(100);
+		sched.setOn(false);
+		sched.setActive(true);
+		HostBoard::setTemperature(20);
+
+		for (byte i = 0; i < 100; i++)
+			pass(server);
+		Transmitter remote(PIN_SEND);
+		remote.begin();
+		remote.setRepeat(3);
+		remote.send(code);
+		HostBoard::putEdge(0);
+
+		while (!dhcp.isBound() && millis() < 300000) {
+			seen.early |= profiler.isReached(Profiler::BOOT_NETWORK);
+			pass(server);
+		}
+		seen.switched = ruled.isOn();
+		seen.scheduled = scheduled.isOn();
+		seen.leased = millis();
+		pass(server);
+		seen.applied = Ethernet.localIP() == IPAddress(ADDRESS) &&
+			profiler.isReached(Profiler::BOOT_NETWORK);
+
+		// renewed at half the lease, the address stays
+		unsigned long requests = server.requests;
+		while (millis() - seen.leased < LEASE * 1000UL)
+			pass(server);
+		seen.renewals = server.requests - requests;
+		seen.kept = dhcp.isBound() && Ethernet.localIP() == IPAddress(ADDRESS);
+	}
+}
+
+// Remotes and schedules work while the DHCP server is slow, the network
+// follows once it answers. The stand-in takes a minute to show up and
+// seconds for each answer. The boot runs in a fresh child, so this has
+// to come before any suite that booted the sketch in this process.
+TEST(Dhcp, radioAndSchedulesDoNotWaitForTheLease)
+{
+	CHECK(!profiler.isReached(Profiler::BOOT_RADIO));
+
+	int fds[2];
+	CHECK(pipe(fds) == 0);
+	pid_t child = fork();
+	if (child == 0) {
+		Seen seen;
+		boot(seen);
+		_exit(write(fds[1], &seen, sizeof(seen)) != sizeof(seen));
+	}
+	Seen seen;
+	memset(&seen, 0, sizeof(seen));
+	ssize_t n = read(fds[0], &seen, sizeof(seen));
+	waitpid(child, NULL, 0);
+	close(fds[0]);
+	close(fds[1]);
+	CHECK_EQUAL(ssize_t(sizeof(seen)), n);
+
+	CHECK(seen.switched);
+	CHECK(seen.scheduled);
+	CHECK(!seen.early);
+	CHECK(seen.leased > AWAY + 2 * DELAY);
+	CHECK(seen.leased < 300000);
+	CHECK(seen.applied);
+	// DhcpClient renews by itself, Ethernet.maintain() is not needed
+	CHECK_EQUAL(1UL, seen.renewals);
+	CHECK(seen.kept);
+}
@@ -0,0 +1,189 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <EventStore.h>
+#include <avr/eeprom.h>
+
+
+namespace {
+
+EEMEM byte events_ee[EventStore::STORAGE_SIZE];
+
+const time_t START = 1700000000;
+
+// the events the cursor yields, at most max
+int query(const EventStore& store, Event* ev, int max, 
+	time_t since = 0, unsigned long code = EventStore::ANY)
+{
+	EventStore::Cursor cursor(store, since, code);
+	int n = 0;
+
+	while (n < max && cursor.next(ev[n]))
+		n++;
+	return n;
+}
+
+}
+
+TEST(EventStore, eventsComeBackInOrder)
+{
+	EventStore store(&events_ee);
+	store.clear();
+
+	for (int i = 0; i < 10; i++)
+		store.add(100 + i % 3, START + i * 7);
+
+	Event ev[16];
+	CHECK_EQUAL(10, query(store, ev, 16));
+	for (int i = 0; i < 10; i++) {
+		CHECK_EQUAL(100UL + i % 3, ev[i].getId());
+		CHECK_EQUAL(START + i * 7, ev[i].getTime());
+	}
+	CHECK_EQUAL(10u, store.getEvents());
+	CHECK_EQUAL(3, store.getCodes());
+}
+
+TEST(EventStore, rangeQueries)
+{
+	EventStore store(&events_ee);
+	store.clear();
+
+	// several blocks, a few hours apart
+	for (int i = 0; i < 200; i++)
+		store.add(i % 5 == 0 ? 0x01ABCDEFUL : 0x01000000UL + i % 4, START + i * 600L);
+
+	Event ev[256];
+	time_t since = START + 150 * 600L;
+	int n = query(store, ev, 256, since);
+	CHECK_EQUAL(50, n);
+	CHECK_EQUAL(since, ev[0].getTime());
+
+	n = query(store, ev, 256, 0, 0x01ABCDEFUL);
+	CHECK_EQUAL(40, n);
+	for (int i = 0; i < n; i++) {
+		CHECK_EQUAL(0x01ABCDEFUL, ev[i].getId());
+		CHECK_EQUAL(START + i * 3000L, ev[i].getTime());
+	}
+
+	n = query(store, ev, 256, since, 0x01ABCDEFUL);
+	CHECK_EQUAL(10, n);
+	CHECK_EQUAL(0, query(store, ev, 256, 0, 12345));
+}
+
+TEST(EventStore, oldBlocksAreDropped)
+{
+	EventStore store(&events_ee);
+	store.clear();
+	const int total = 2000;
+
+	for (int i = 0; i < total; i++)
+		store.add(7, START + i);
+
+	Event ev[total];
+	int n = query(store, ev, total);
+	CHECK_EQUAL(int(store.getEvents()), n);
+	CHECK(n < total);
+	// roughly 2 bytes an event, all but the oldest blocks are kept
+	CHECK(n > (EventStore::BLOCKS - 1) * (EventStore::BLOCK_SIZE - 10) / 2);
+	CHECK_EQUAL(START + total - 1, ev[n-1].getTime());
+	for (int i = 1; i < n; i++)
+		CHECK_EQUAL(ev[i-1].getTime() + 1, ev[i].getTime());
+}
+
+TEST(EventStore, survivesARestart)
+{
+	Event ev[64];
+	{
+		EventStore store(&events_ee);
+		store.clear();
+		for (int i = 0; i < 40; i++)
+			store.add(i % 2 ? 11 : 22, START + i * 90);
+		store.flush();
+	}
+
+	EventStore store(&events_ee);
+	store.load();
+	CHECK_EQUAL(40u, store.getEvents());
+	CHECK_EQUAL(2, store.getCodes());
+
+	// appends continue where the old store ended
+	store.add(33, START + 40 * 90);
+	int n = query(store, ev, 64);
+	CHECK_EQUAL(41, n);
+	CHECK_EQUAL(22UL, ev[0].getId());
+	CHECK_EQUAL(START + 39 * 90, ev[39].getTime());
+	CHECK_EQUAL(33UL, ev[40].getId());
+	CHECK_EQUAL(START + 40 * 90, ev[40].getTime());
+}
+
+TEST(EventStore, touchMovesARepeat)
+{
+	EventStore store(&events_ee);
+	store.clear();
+
+	store.add(5, START);
+	store.add(6, START + 10);
+	CHECK(store.touch(6, START + 12, 5));
+	CHECK(!store.touch(6, START + 400, 300));
+	CHECK(!store.touch(6, START + 12, -1));
+	// only the last event moves
+	CHECK(!store.touch(5, START + 13, 5));
+	// to a delta that needs a longer varint
+	CHECK(store.touch(6, START + 200, 300));
+	store.add(6, START + 500);
+
+	Event ev[4];
+	CHECK_EQUAL(3, query(store, ev, 4));
+	CHECK_EQUAL(START + 200, ev[1].getTime());
+	CHECK_EQUAL(START + 500, ev[2].getTime());
+}
+
+TEST(EventStore, codesBeyondTheDictionaryAreInline)
+{
+	EventStore store(&events_ee);
+	store.clear();
+	const int codes = EventStore::CODES + 5;
+
+	for (int i = 0; i < codes; i++)
+		store.add(0x03000000UL + i, START + i);
+	CHECK_EQUAL(EventStore::CODES, store.getCodes());
+
+	Event ev[64];
+	CHECK_EQUAL(codes, query(store, ev, 64));
+	for (int i = 0; i < codes; i++)
+		CHECK_EQUAL(0x03000000UL + i, ev[i].getId());
+
+	CHECK_EQUAL(1, query(store, ev, 64, 0, 0x03000000UL + codes - 1));
+	CHECK_EQUAL(START + codes - 1, ev[0].getTime());
+}
+
+TEST(EventStore, brokenHeaderStartsEmpty)
+{
+	byte garbage[8];
+	memset(garbage, 0xFF, sizeof(garbage));
+	eeprom_write_block(garbage, events_ee, sizeof(garbage));
+
+	EventStore store(&events_ee);
+	store.load();
+	CHECK_EQUAL(0u, store.getEvents());
+
+	Event ev[1];
+	CHECK_EQUAL(0, query(store, ev, 1));
+}
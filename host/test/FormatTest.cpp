@@ -0,0 +1,125 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Buffer.h"
+
+#include <DateTime.h>
+#include <Format.h>
+#include <Util.h>
+
+
+namespace {
+	const char* const DAYS[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
+	// the text of DateTime::printTo before Format
+	void printTimestamp(Print& p, const DateTime& dt)
+	{
+		int fields[] = { dt.getDay(), dt.getMonth(), dt.getYear(),
+			dt.getHour(), dt.getMinute(), dt.getSecond() };
+		const char* dels[] = { ".", ".", " ", ":", ":", "" };
+
+		p.print(DAYS[dt.getDayOfWeek() - 1]);
+		p.print(" ");
+		for (byte i = 0; i < 6; i++) {
+			if (fields[i] < 10)
+				p.print(0);
+			p.print(fields[i]);
+			p.print(dels[i]);
+		}
+	}
+
+	const char* fixed(float v, byte decimals)
+	{
+		static char text[Format::FIXED_SIZE + 1];
+		*Format::fixed(text, v, decimals) = '\0';
+		return text;
+	}
+}
+
+TEST(Format, timestampsMatchThePrints)
+{
+	Buffer now, old;
+	uint32_t r = 1;
+
+	for (long i = 0; i < 20000; i++) {
+		r = r * 1103515245 + 12345;
+		DateTime dt(time_t(946684800 + r % 2000000000));
+		now.clear();
+		old.clear();
+		now << dt;
+		printTimestamp(old, dt);
+		if (strcmp(now.text, old.text) != 0) {
+			CHECK(strcmp(now.text, old.text) == 0);
+			break;
+		}
+	}
+	now.clear();
+	now << DateTime(5, 4, 3, 1, 2, 3, 2014);
+	CHECK(strcmp(now.text, "Sun 02.03.2014 03:04:05") == 0);
+}
+
+TEST(Format, sensorValuesMatchPrint)
+{
+	Buffer now, old;
+	uint32_t r = 7;
+
+	// a third of the last digit off, away from the ties
+	for (long i = 0; i < 20000; i++) {
+		r = r * 1103515245 + 12345;
+		float v = (long(r >> 8 & 0x1FFFFF) - 0x100000) / 100.0f + 0.0033f;
+		byte decimals = i % 3;
+		now.clear();
+		old.clear();
+		now << Fixed(v, decimals);
+		old.print(v, decimals);
+		if (strcmp(now.text, old.text) != 0) {
+			CHECK(strcmp(now.text, old.text) == 0);
+			break;
+		}
+	}
+}
+
+TEST(Format, fixedEdges)
+{
+	CHECK(strcmp(fixed(21.126, 2), "21.13") == 0);
+	CHECK(strcmp(fixed(0.999, 2), "1.00") == 0);
+	CHECK(strcmp(fixed(-0.004, 2), "-0.00") == 0);
+	CHECK(strcmp(fixed(3.14159, 0), "3") == 0);
+	CHECK(strcmp(fixed(1.5, 9), "1.5000") == 0);
+	CHECK(strcmp(fixed(5e9, 2), "ovf") == 0);
+	CHECK(strcmp(fixed(NAN, 2), "nan") == 0);
+	CHECK(strcmp(fixed(-INFINITY, 2), "inf") == 0);
+}
+
+TEST(Format, decimalAndBase64)
+{
+	char text[16];
+
+	*Format::decimal(text, 0) = '\0';
+	CHECK(strcmp(text, "0") == 0);
+	*Format::decimal(text, 4294967295UL) = '\0';
+	CHECK(strcmp(text, "4294967295") == 0);
+	*Format::twoDigits(text, 7) = '\0';
+	CHECK(strcmp(text, "07") == 0);
+
+	*Format::base64(text, "foob", 4) = '\0';
+	CHECK(strcmp(text, "Zm9vYg==") == 0);
+	*Format::base64(text, "foo", 3) = '\0';
+	CHECK(strcmp(text, "Zm9v") == 0);
+}
@@ -0,0 +1,179 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+
+#include <Transmitter.h>
+
+
+namespace {
+	const uint8_t PIN_SEND = 5;
+	const byte SEND_REPEAT = 3;
+
+	// switch 0, on as the eeprom recorded it
+	Switch& addSwitch()
+	{
+		Switch& sw = switches[0];
+		sw.setGroup("10101");
+		sw.setDevice("01000");
+		sw.setActive(true);
+		sw.setOn(true);
+		registry.setActive(0, true);
+		return sw;
+	}
+
+	void removeSwitch(Switch& sw)
+	{
+		registry.setActive(0, false);
+		sw.setActive(false);
+		resync.setPeriod(0);
+		HostBoard::connectRadio(0xff);
+	}
+
+	unsigned long edgesOfPass()
+	{
+		unsigned long edges = HostBoard::getRadioEdges();
+		loop();
+		return HostBoard::getRadioEdges() - edges;
+	}
+}
+
+// codes are handled while the tables still load, one per pass
+TEST(Loop, radioComesBeforeTheConfig)
+{
+	bootSketch();
+	CHECK(profiler.isReached(Profiler::BOOT_RADIO));
+	CHECK(!profiler.isReached(Profiler::BOOT_CONFIG));
+	CHECK(profiler.getMilestone(Profiler::BOOT_RADIO) - 1000 < 10);
+
+	Transmitter remote(PIN_SEND);
+	remote.begin();
+	remote.setRepeat(3);
+	// short frames, a pass polls a limited number of edges
+	RfCode sent = { 1, 8, 0x5AUL };
+	remote.send(sent);
+	// ends the last frame, like the next noise edge
+	HostBoard::putEdge(0);
+	unsigned long codes = profiler.getCount(Profiler::RF_CODES);
+	loop();
+	loop();
+	CHECK(profiler.getCount(Profiler::RF_CODES) > codes);
+	CHECK(!profiler.isReached(Profiler::BOOT_CONFIG));
+
+	loop();
+	// the gateway has its address from the system
+	CHECK(profiler.isReached(Profiler::BOOT_CONFIG));
+	CHECK(profiler.isReached(Profiler::BOOT_NETWORK));
+	HostBoard::connectRadio(0xff);
+}
+
+// after a reset the recorded state may be stale, a command sets it
+TEST(Loop, resyncSkipsStatesNotSetSinceBoot)
+{
+	bootSketch();
+	HostBoard::connectRadio(PIN_SEND);
+	CHECK_EQUAL(0, Resync().getPeriod());
+
+	Switch& sw = addSwitch();
+	resync.setPeriod(1);
+	resync.begin(millis());
+	HostBoard::advance(61000000UL);
+	unsigned long sent = resync.getSent();
+	for (byte i = 0; i < 10; i++)
+		CHECK_EQUAL(0UL, edgesOfPass());
+	CHECK_EQUAL(sent, resync.getSent());
+
+	doSwitch(sw, true, false);
+	HostBoard::advance(61000000UL);
+	for (byte i = 0; i < 10; i++)
+		edgesOfPass();
+	CHECK_EQUAL(sent + 1, resync.getSent());
+	removeSwitch(sw);
+}
+
+TEST(Loop, resyncSendsOneBurstPerIdlePass)
+{
+	bootSketch();
+	HostBoard::connectRadio(PIN_SEND);
+	Switch& sw = addSwitch();
+	doSwitch(sw, true, false);
+	resync.setPeriod(1);
+	resync.begin(millis());
+	CHECK_EQUAL(0UL, edgesOfPass());
+
+	// the switch is due after a minute, its bursts go out on as many
+	// passes
+	HostBoard::advance(61000000UL);
+	unsigned long sent = resync.getSent();
+	unsigned long burst = 0;
+	byte bursts = 0;
+	for (byte i = 0; i < 10; i++) {
+		unsigned long edges = edgesOfPass();
+		if (!edges)
+			continue;
+		if (!burst)
+			burst = edges;
+		CHECK_EQUAL(burst, edges);
+		bursts++;
+	}
+	CHECK(burst > 0);
+	CHECK_EQUAL(SEND_REPEAT, bursts);
+	CHECK_EQUAL(sent + 1, resync.getSent());
+	removeSwitch(sw);
+}
+
+// a pass that received a code sends nothing, the bursts wait for quiet
+TEST(Loop, resyncWaitsWhileCodesArrive)
+{
+	bootSketch();
+	HostBoard::connectRadio(PIN_SEND);
+	Switch& sw = addSwitch();
+	doSwitch(sw, true, false);
+	resync.setPeriod(1);
+	resync.begin(millis());
+	HostBoard::advance(61000000UL);
+
+	Transmitter remote(PIN_SEND);
+	remote.begin();
+	remote.setRepeat(3);
+	byte busy = 0;
+	byte bursts = 0;
+	for (byte i = 0; i < 20; i++) {
+		RfCode code = { 1, 8, 0x5AUL };
+		remote.send(code);
+		HostBoard::putEdge(0);
+		unsigned long codes = profiler.getCount(Profiler::RF_CODES);
+		unsigned long edges = edgesOfPass();
+		if (profiler.getCount(Profiler::RF_CODES) != codes) {
+			CHECK_EQUAL(0UL, edges);
+			busy++;
+		} else if (edges) {
+			bursts++;
+		}
+	}
+	CHECK(busy > 10);
+
+	// the rest once it is quiet
+	for (byte i = 0; i < 10; i++) {
+		if (edgesOfPass())
+			bursts++;
+	}
+	CHECK_EQUAL(SEND_REPEAT, bursts);
+	removeSwitch(sw);
+}
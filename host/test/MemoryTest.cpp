@@ -0,0 +1,64 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <Util.h>
+
+
+TEST(Memory, sensorsFillTheirArena)
+{
+	bootSketch();
+	CHECK(sensors[0] && sensors[1] && sensors[2]);
+	CHECK_EQUAL(0u, sensorArena.getFree());
+	CHECK(strcmp("DS18B20", sensors[0]->getName()) == 0);
+}
+
+TEST(Memory, marksHoldTheExtremes)
+{
+	memSample();
+	MemStat mem = memStat();
+	CHECK(mem.lowFree <= freeRam());
+	CHECK(mem.heapPeak >= heapUsed());
+
+	// a later sample never raises the low mark or lowers the peak
+	memSample();
+	CHECK(memStat().lowFree <= mem.lowFree);
+	CHECK(memStat().heapPeak >= mem.heapPeak);
+}
+
+TEST(Memory, footerAndMetricsShowTheMarks)
+{
+	bootSketch();
+	while (!profiler.isReached(Profiler::BOOT_CONFIG))
+		loop();
+	publishState(false);
+
+	TestClient page("GET /status HTTP/1.0\r\n\r\n");
+	handleRequest(page);
+	CHECK(strstr(page.text, "<br>Free RAM: "));
+	CHECK(strstr(page.text, " (low "));
+	CHECK(strstr(page.text, ", heap peak "));
+
+	TestClient metrics("GET /metrics HTTP/1.0\r\n\r\n");
+	handleRequest(metrics);
+	CHECK(strstr(metrics.text, "\nhomecontrol_free_ram_low_bytes "));
+	CHECK(strstr(metrics.text, "\nhomecontrol_heap_peak_bytes "));
+}
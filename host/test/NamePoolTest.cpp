@@ -0,0 +1,126 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <avr/eeprom.h>
+#include <NamePool.h>
+#include <Switch.h>
+#include <stdio.h>
+
+
+namespace {
+	const int RECORDS = 4;
+
+	EEMEM byte pool_ee[sizeof(NamePool)];
+	EEMEM byte switches_ee[sizeof(Switch) * RECORDS];
+}
+
+TEST(NamePool, equalNamesShareASlot)
+{
+	NamePool pool;
+	unsigned int free = pool.getFree();
+
+	byte a = pool.intern("Lamp");
+	byte b = pool.intern("Lamp");
+	CHECK(a != NamePool::NONE);
+	CHECK_EQUAL(a, b);
+	CHECK_EQUAL(free - 5, pool.getFree());
+	CHECK_EQUAL(NAME_POOL_SLOTS - 1, pool.getSlotsFree());
+
+	pool.release(a);
+	CHECK_EQUAL(0, strcmp("Lamp", pool.get(b)));
+	pool.release(b);
+	CHECK_EQUAL(0, strcmp("", pool.get(b)));
+	CHECK_EQUAL(free, pool.getFree());
+}
+
+TEST(NamePool, releaseCompactsTheData)
+{
+	NamePool pool;
+
+	byte a = pool.intern("Kitchen");
+	byte b = pool.intern("Hall");
+	byte c = pool.intern("Garden");
+
+	pool.release(b);
+	CHECK_EQUAL(0, strcmp("Kitchen", pool.get(a)));
+	CHECK_EQUAL(0, strcmp("Garden", pool.get(c)));
+	CHECK_EQUAL(NAME_POOL_SIZE - 15u, pool.getFree());
+
+	// names are cut to NAME_SIZE characters
+	byte d = pool.intern("LivingRoomLamp");
+	CHECK_EQUAL(0, strcmp("LivingRoom", pool.get(d)));
+}
+
+TEST(NamePool, renameKeepsTheNameIfFull)
+{
+	NamePool pool;
+	char name[NAME_SIZE];
+	byte id = pool.intern("Porch");
+	int count = 1;
+
+	for (;; count++) {
+		snprintf(name, sizeof(name), "n%d", count);
+		if (pool.intern(name) == NamePool::NONE)
+			break;
+	}
+	CHECK_EQUAL(NAME_POOL_SLOTS, count);
+
+	byte old = id;
+	CHECK(!pool.rename(id, "Terrace"));
+	CHECK_EQUAL(old, id);
+	CHECK_EQUAL(0, strcmp("Porch", pool.get(id)));
+
+	// an empty name always fits and frees the slot
+	CHECK(pool.rename(id, ""));
+	CHECK_EQUAL(NamePool::NONE, id);
+	CHECK(pool.rename(id, "Terrace"));
+	CHECK_EQUAL(0, strcmp("Terrace", pool.get(id)));
+}
+
+TEST(NamePool, roundTripThroughTheEeprom)
+{
+	NamePool pool;
+	Switch switches[RECORDS];
+	const char* names[RECORDS] = { "Lamp", "Fan", "Lamp", "Heater" };
+
+	for (int i = 0; i < RECORDS; i++) {
+		switches[i].setGroup("10101");
+		switches[i].setDevice(i % 2 ? "01000" : "00010");
+		switches[i].setId(i);
+		switches[i].setNameId(pool.intern(names[i]));
+	}
+	eeprom_write_block(&pool, pool_ee, sizeof(pool));
+	eeprom_write_block(switches, switches_ee, sizeof(switches));
+
+	NamePool loadedPool;
+	Switch loaded[RECORDS];
+
+	eeprom_read_block(&loadedPool, pool_ee, sizeof(loadedPool));
+	eeprom_read_block(loaded, switches_ee, sizeof(loaded));
+
+	CHECK_EQUAL(pool.getFree(), loadedPool.getFree());
+	for (int i = 0; i < RECORDS; i++) {
+		CHECK_EQUAL(0, strcmp(names[i], loadedPool.get(loaded[i].getNameId())));
+		CHECK_EQUAL(switches[i].getCode(true), loaded[i].getCode(true));
+		CHECK_EQUAL(i, loaded[i].getId());
+	}
+	// the records share the slot of their common name
+	CHECK_EQUAL(loaded[0].getNameId(), loaded[2].getNameId());
+}
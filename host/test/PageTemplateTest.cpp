@@ -0,0 +1,315 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <DateTime.h>
+#include <Format.h>
+#include <Util.h>
+
+
+// The table pages are rendered from templates, these are the same pages
+// written out as << chains the way the sketch built them before. The
+// part between the header and the footer has to match byte for byte.
+namespace {
+	const char AUTH[] = "Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n";
+
+	void render(TestClient& client)
+	{
+		ClientHelper webClient(&client);
+		webClient.getRequestType();
+		sendPage(client, webClient, webClient.getRequestURI('c'));
+	}
+
+	// from the start of the main section up to the footer
+	const char* main(TestClient& client)
+	{
+		char* start = strstr(client.text, "<section id='main'>");
+		char* end = strstr(client.text, "<footer>");
+		if (!start || !end)
+			return "";
+		*end = '\0';
+		return start;
+	}
+
+	void fill()
+	{
+		while (!profiler.isReached(Profiler::BOOT_CONFIG))
+			loop();
+
+		Switch& lamp = switches[7];
+		lamp.setGroup("10101");
+		lamp.setDevice("01000");
+		lamp.setNameId(names.intern("Lamp"));
+		lamp.setOn(true);
+		lamp.setActive(true);
+		Switch& fan = switches[3];
+		fan.setGroup("11111");
+		fan.setDevice("00010");
+		fan.setNameId(names.intern("Fan"));
+		fan.setPin(true);
+		fan.setActive(true);
+		// in the order they were added, not by id
+		registry.setActive(7, true);
+		registry.setActive(3, true);
+		feedback[7].setSensorId(1);
+		feedback[7].setLevel(2.5);
+
+		Schedule& night = schedules[2];
+		Week_t days;
+		days.days = 0x41;
+		night.setNameId(names.intern("Night"));
+		night.setTime(1420070400UL);
+		night.setDuration(5400);
+		night.setDays(days);
+		night.setSwitchId(3);
+		night.setSensorId(255);
+		night.setThreshold(12.75);
+		night.setOn(false);
+		night.setActive(true);
+
+		EventRule& button = eventRules[1];
+		button.setNameId(names.intern("Button"));
+		button.setEventId(0x5A5AUL);
+		button.setSwitchId(7);
+		button.setToggle(true);
+		button.setOn(true);
+		button.setDuration(30);
+		button.setActive(true);
+		EventRule& report = eventRules[4];
+		report.setNameId(names.intern("Report"));
+		report.setEventId(123456UL);
+		report.setSwitchId(3);
+		report.setFeedback(true);
+		report.setOn(false);
+		report.setActive(true);
+
+		publishState(false);
+	}
+
+	template<class T>
+	void drop(T& record)
+	{
+		names.release(record.getNameId());
+		record.setNameId(NamePool::NONE);
+		record.setActive(false);
+	}
+
+	void clear()
+	{
+		registry.setActive(7, false);
+		registry.setActive(3, false);
+		drop(switches[7]);
+		drop(switches[3]);
+		feedback[7] = Feedback();
+		drop(schedules[2]);
+		drop(eventRules[1]);
+		drop(eventRules[4]);
+		learnRule = 255;
+		publishState(false);
+	}
+
+	void sendSwitches(Print& client)
+	{
+		client << F("<section id='main'>") <<
+			F("<form action='/switch' method='POST'>") <<
+			F("<fieldset class='inline-block'><legend>New Switch</legend>") <<
+			F("<label>Id: </label><input type='number' name='id' min='0' placeholder='new'>") <<
+			F("<select name='active'><option value='1' selected>Enable</option>") <<
+			F("<option value='0'>Disable</option></select><br>") <<
+			F("<label>Name: </label><input type='text' name='name' value='My Switch'><br>") <<
+			F("<label>Group: </label><input type='text' name='group' value='11111'><br>") <<
+			F("<label>Device: </label><input type='text' name='device' value='10000'><br>") <<
+			F("<label>Pin: </label><input type='checkbox' name='pin'>") <<
+			F(" Id: <input type='number' name='pinId' min='14' max='49'><br>") <<
+			F("<label>Feedback: </label>SensorId <input type='number' name='fbSensor' min='0' max='255' value='255'>") <<
+			F(" On at <input type='text' name='fbLevel' size='5' value='0'><br>") <<
+			F("<label></label><input type='submit' value='Add'>") <<
+			F("</fieldset></form>\n") <<
+
+			F("<table><tr><th>Id</th><th>Name</th><th>Group</th>") <<
+			F("<th>Device</th><th>Pin</th><th>State</th><th>Feedback</th></tr>\n");
+
+		for (switch_id_t k = 0; k < registry.getCount(); k++) {
+			switch_id_t i = registry[k];
+			Switch& sw = switches[i];
+
+			client << F("<tr><td>") << 
+				i << F("</td><td>") <<
+				names.get(sw.getNameId()) << F("</td><td>") <<
+				sw.getGroup() << F("</td><td>") <<
+				sw.getDevice() << F("</td><td>") <<
+				(sw.isPin() ? "Yes/" : "No/") << sw.getId() << F("</td><td>") <<
+				(sw.isOn() ? "On" : "Off") << F("</td><td>");
+			if (feedback[i].getSensorId() < 3) {
+				client << F("Sensor ") << feedback[i].getSensorId() << 
+					F(" at ") << Fixed(feedback[i].getLevel());
+			}
+			client << F("</td></tr>\n");
+		}
+		client << F("</table></section>\n");
+	}
+
+	void sendSchedules(Print& client)
+	{
+		client << F("<section id='main'>") <<
+			F("<form action='/schedule' method='POST'>") <<
+			F("<fieldset class='inline-block'><legend>New Schedule</legend>") <<
+			F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>") <<
+			F("<select name='active'><option value='1' selected>Enable</option>") <<
+			F("<option value='0'>Disable</option></select><br>") <<
+			F("<label>Name: </label><input type='text' name='name' value='My Schedule'><br>") <<
+			F("<label>Time: </label><input type='datetime-local' autocomplete='on' name='time'><br>") <<
+			F("<label>Duration: </label><input type='number' name='duration' min='1' max='1440' value='60'>min<br>") <<
+			F("Sun <input type='checkbox' name='sun'>") <<
+			F("Mon <input type='checkbox' name='mon'>") <<
+			F("Tue <input type='checkbox' name='tue'>") <<
+			F("Wed <input type='checkbox' name='wed'>") <<
+			F("Thu <input type='checkbox' name='thu'>") <<
+			F("Fri <input type='checkbox' name='fri'>") <<
+			F("Sat <input type='checkbox' name='sat'>") <<
+			F("All <input type='checkbox' name='all'><br>") <<
+			F("<label>SwitchId: </label><input type='number' name='switch' min='0' max='65535' value='65535'><br>") <<
+			F("<label>SensorId: </label><input type='number' name='sensor' min='0' max='255' value='255'><br>") <<
+			F("<label>Threshold: </label><input type='text' name='threshold' value='100'><br>") <<
+			F("<label>Action: </label><select name='on'><option value='1' selected>On</option>") <<
+			F("<option value='0'>Off</option></select><br>") <<
+			F("<label></label><input type='submit' value='Add'>") <<
+			F("</fieldset></form>\n") <<
+
+			F("<table><tr><th>Id</th><th>Name</th><th>Time</th>") <<
+			F("<th>Duration</th><th>Days</th><th>SwitchId</th>") <<
+			F("<th>SensorId</th><th>Threshold</th><th>Action</th></tr>\n");
+
+		for (int i = 0; i < schedules.getSize(); i++) {
+			Schedule& sched = schedules[i];
+
+			if (!sched.isActive())
+				continue;
+
+			client << F("<tr><td>") << 
+				i << F("</td><td>") <<
+				names.get(sched.getNameId()) << F("</td><td>") <<
+				DateTime(sched.getTime()) << F("</td><td>") <<
+				sched.getDuration()/60 << F("</td><td>") <<
+				sched.getDays().days << F("</td><td>") <<
+				sched.getSwitchId() << F("</td><td>") <<
+				sched.getSensorId() << F("</td><td>") <<
+				Fixed(sched.getThreshold()) << F("</td><td>") <<
+				(sched.turnOn() ? "On" : "Off") << F("</td></tr>\n");
+		}
+		client << F("</table></section>\n");
+	}
+
+	void sendEventRules(Print& client)
+	{
+		client << F("<section id='main'>") <<
+			F("<form action='/eventRules' method='POST'>") <<
+			F("<fieldset class='inline-block'><legend>New Event Rule</legend>") <<
+			F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'>") <<
+			F("<select name='active'><option value='1' selected>Enable</option>") <<
+			F("<option value='0'>Disable</option></select><br>") <<
+			F("<label>Name: </label><input type='text' name='name' value='My Rule'><br>") <<
+			F("<label>EventId: </label><input type='text' name='eventId'><br>") <<
+			F("<label>SwitchId: </label><input type='number' name='switchId' min='0' max='65535' value='65535'><br>") <<
+			F("<label>Action: </label><select name='action'><option value='1' selected>On</option>") <<
+			F("<option value='0'>Off</option><option value='2'>Toggle</option>") <<
+			F("<option value='3'>Reports On</option><option value='4'>Reports Off</option></select><br>") <<
+			F("<label>For: </label><input type='number' name='for' min='0' max='65535' value='0'>s<br>") <<
+			F("<label></label><input type='submit' value='Add'>") <<
+			F("</fieldset></form>\n") <<
+			F("<form action='/learn' method='POST'>") <<
+			F("<fieldset class='inline-block'><legend>Learn EventId</legend>") <<
+			F("<label>Id: </label><input type='number' name='id' min='0' max='255' value='0'><br>") <<
+			F("<label></label><input type='submit' value='Learn'>") <<
+			F("</fieldset></form>\n");
+
+		if (learnRule != 255) {
+			client << F("<p>Press a button on the remote to bind it to rule ") << 
+				learnRule << F("</p>\n");
+		}
+
+		client << F("<table><tr><th>Id</th><th>Name</th><th>EventId</th>") <<
+			F("<th>SwitchId</th><th>Toggle</th><th>Action</th><th>For</th></tr>\n");
+
+		for (int i = 0; i < eventRules.getSize(); i++) {
+			EventRule& rule = eventRules[i];
+
+			if (!rule.isActive())
+				continue;
+
+			client << F("<tr><td>") << 
+				i << F("</td><td>") <<
+				names.get(rule.getNameId()) << F("</td><td>") <<
+				rule.getEventId() << F("</td><td>") <<
+				rule.getSwitchId() << F("</td><td>") <<
+				(rule.toggle() ? "Yes" : "No") << F("</td><td>") <<
+				(rule.isFeedback() ? "Reports " : "") <<
+				(rule.turnOn() ? "On" : "Off") << F("</td><td>") <<
+				rule.getDuration() << F("</td></tr>\n");
+		}
+		client << F("</table></section>\n");
+	}
+
+	// the page at uri against the chain rendering of expect
+	bool same(const char* uri, void (*expect)(Print&))
+	{
+		char request[128];
+		strcpy(request, "GET /");
+		strcat(request, uri);
+		strcat(request, " HTTP/1.0\r\n");
+		strcat(request, AUTH);
+		TestClient page(request);
+		render(page);
+		TestClient chain("");
+		expect(chain);
+		return strcmp(chain.text, main(page)) == 0;
+	}
+}
+
+TEST(PageTemplate, switchesMatchTheChains)
+{
+	bootSketch();
+	fill();
+	CHECK(same("switch", sendSwitches));
+	clear();
+	CHECK(same("switch", sendSwitches));
+}
+
+TEST(PageTemplate, schedulesMatchTheChains)
+{
+	bootSketch();
+	fill();
+	CHECK(same("schedule", sendSchedules));
+	clear();
+	CHECK(same("schedule", sendSchedules));
+}
+
+TEST(PageTemplate, eventRulesMatchTheChains)
+{
+	bootSketch();
+	fill();
+	CHECK(same("eventRules", sendEventRules));
+	learnRule = 4;
+	publishState(false);
+	CHECK(same("eventRules", sendEventRules));
+	clear();
+	CHECK(same("eventRules", sendEventRules));
+}
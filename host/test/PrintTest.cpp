@@ -0,0 +1,57 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Buffer.h"
+
+
+TEST(Print, numbers)
+{
+	Buffer b;
+
+	b.print(-42);
+	b.print(' ');
+	b.print(255u, HEX);
+	b.print(' ');
+	b.print(5ul, BIN);
+	b.print(' ');
+	b.print((unsigned char)7);
+	CHECK(strcmp(b.text, "-42 FF 101 7") == 0);
+}
+
+TEST(Print, floatsRoundLikeTheCore)
+{
+	Buffer b;
+
+	b.print(21.126);
+	b.print(' ');
+	b.print(-0.004, 2);
+	b.print(' ');
+	b.print(3.14159, 0);
+	b.print(' ');
+	b.print(5e9);
+	CHECK(strcmp(b.text, "21.13 -0.00 3 ovf") == 0);
+}
+
+TEST(Print, printlnEndsWithCrLf)
+{
+	Buffer b;
+
+	CHECK_EQUAL(4u, b.println("ok"));
+	CHECK(strcmp(b.text, "ok\r\n") == 0);
+}
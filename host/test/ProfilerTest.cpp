@@ -0,0 +1,156 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <Profiler.h>
+
+
+namespace {
+	// a phase that took us microseconds on the simulated clock
+	void sample(Profiler& profiler, byte phase, unsigned long us)
+	{
+		if (!HostBoard::isSimulatedClock())
+			HostBoard::useSimulatedClock(1000000);
+		unsigned long start = micros();
+		HostBoard::advance(us);
+		profiler.record(phase, start);
+	}
+
+	// the value of a series in the /metrics text, -1 if it is missing
+	long value(const char* text, const char* series)
+	{
+		char line[160] = "\n";
+		strcat(line, series);
+		strcat(line, " ");
+		const char* p = strstr(text, line);
+		return p ? atol(p + strlen(line)) : -1;
+	}
+
+	void getMetrics(TestClient& client)
+	{
+		handleRequest(client);
+		CHECK(strncmp(client.text, "HTTP/1.0 200 OK", 15) == 0);
+	}
+}
+
+TEST(Profiler, samplesFallIntoTheirBuckets)
+{
+	Profiler profiler;
+
+	sample(profiler, Profiler::RF, 0);
+	sample(profiler, Profiler::RF, 64);
+	sample(profiler, Profiler::RF, 65);
+	sample(profiler, Profiler::RF, 256);
+	sample(profiler, Profiler::RF, 257);
+	sample(profiler, Profiler::RF, 10000000);
+
+	const Profiler::Timing& t = profiler.getTiming(Profiler::RF);
+	CHECK_EQUAL(2ul, t.hist[0]);
+	CHECK_EQUAL(2ul, t.hist[1]);
+	CHECK_EQUAL(1ul, t.hist[2]);
+	CHECK_EQUAL(1ul, t.hist[Profiler::BUCKETS-1]);
+	CHECK_EQUAL(6ul, t.count);
+	CHECK_EQUAL(0ul, t.min);
+	CHECK_EQUAL(10000000ul, t.max);
+	CHECK_EQUAL(10000642ul, t.sum);
+
+	// the other phases are untouched
+	CHECK_EQUAL(0ul, profiler.getTiming(Profiler::HTTP).count);
+}
+
+TEST(Profiler, bucketLimitsGrowByFour)
+{
+	CHECK_EQUAL(64ul, Profiler::getBucketLimit(0));
+	CHECK_EQUAL(256ul, Profiler::getBucketLimit(1));
+	CHECK_EQUAL(262144ul, Profiler::getBucketLimit(6));
+}
+
+TEST(Profiler, countersAndRoutes)
+{
+	Profiler profiler;
+
+	profiler.count(Profiler::RF_CODES);
+	profiler.count(Profiler::RF_CODES);
+	profiler.count(Profiler::RF_REPEATS);
+	profiler.countRoute(3);
+	profiler.countRoute(Profiler::MAX_ROUTES);
+
+	CHECK_EQUAL(2ul, profiler.getCount(Profiler::RF_CODES));
+	CHECK_EQUAL(1ul, profiler.getCount(Profiler::RF_REPEATS));
+	CHECK_EQUAL(1ul, profiler.getRouteCount(3));
+	CHECK_EQUAL(0ul, profiler.getRouteCount(Profiler::MAX_ROUTES));
+}
+
+TEST(Profiler, milestonesKeepTheFirstTime)
+{
+	Profiler profiler;
+
+	CHECK(!profiler.isReached(Profiler::BOOT_CONFIG));
+	sample(profiler, Profiler::HTTP, 0);
+	unsigned long first = millis();
+	profiler.reach(Profiler::BOOT_CONFIG);
+	HostBoard::advance(5000000);
+	profiler.reach(Profiler::BOOT_CONFIG);
+
+	CHECK(profiler.isReached(Profiler::BOOT_CONFIG));
+	CHECK(!profiler.isReached(Profiler::BOOT_NETWORK));
+	CHECK_EQUAL(first, profiler.getMilestone(Profiler::BOOT_CONFIG));
+}
+
+TEST(Profiler, metricsShowTheSketchProfile)
+{
+	bootSketch();
+	while (!profiler.isReached(Profiler::BOOT_CONFIG))
+		loop();
+	loop();
+
+	TestClient first("GET /metrics HTTP/1.0\r\n\r\n");
+	getMetrics(first);
+	TestClient second("GET /metrics HTTP/1.0\r\n\r\n");
+	getMetrics(second);
+
+	// a request is counted once its page is sent
+	const char* route = "homecontrol_requests_total{route=\"metrics\"}";
+	CHECK(value(first.text, route) >= 0);
+	CHECK_EQUAL(value(first.text, route) + 1, value(second.text, route));
+
+	// the sample lands in every bucket from 1024 up and in the count
+	sample(profiler, Profiler::NTP, 300);
+	TestClient third("GET /metrics HTTP/1.0\r\n\r\n");
+	getMetrics(third);
+	const char* grown[] = {
+		"homecontrol_phase_microseconds_count{phase=\"ntp\"}",
+		"homecontrol_phase_microseconds_bucket{phase=\"ntp\",le=\"+Inf\"}",
+		"homecontrol_phase_microseconds_bucket{phase=\"ntp\",le=\"1024\"}"
+	};
+	for (int i = 0; i < 3; i++)
+		CHECK_EQUAL(value(second.text, grown[i]) + 1, value(third.text, grown[i]));
+	const char* below = 
+		"homecontrol_phase_microseconds_bucket{phase=\"ntp\",le=\"256\"}";
+	CHECK_EQUAL(value(second.text, below), value(third.text, below));
+	CHECK(value(third.text, 
+		"homecontrol_phase_max_microseconds{phase=\"ntp\"}") >= 300);
+
+	long radio = value(third.text, "homecontrol_boot_milliseconds{stage=\"radio\"}");
+	long config = value(third.text, "homecontrol_boot_milliseconds{stage=\"config\"}");
+	CHECK(radio >= 0);
+	CHECK(radio <= config);
+}
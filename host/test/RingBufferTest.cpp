@@ -0,0 +1,195 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <RingBuffer.h>
+
+
+namespace {
+
+// the ring before the index types and masking, as the reference
+template<class T, unsigned int sz> class ModuloRing {
+	unsigned int start;
+	unsigned int count;
+	T data[sz];
+public:
+	ModuloRing(): start(0), count(0), data() {}
+
+	void put(const T& elem)
+	{
+		data[(start + count) % sz] = elem;
+		if (count == sz)
+			start = (start + 1) % sz;
+		else
+			count++;
+	}
+
+	T& get()
+	{
+		unsigned int i = start;
+		start = (start + 1) % sz;
+		count--;
+		return data[i];
+	}
+
+	void clear() { start = count = 0; }
+	unsigned int getSize() const { return count; }
+	const T& operator[](unsigned int i) const { return data[(start + i) % sz]; }
+};
+
+// xorshift, the same sequence on every run
+uint32_t state;
+
+uint32_t random32()
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+template<unsigned int sz>
+bool same(const RingBuffer<long, sz>& ring, const ModuloRing<long, sz>& model)
+{
+	if (ring.getSize() != model.getSize() || ring.isEmpty() != (model.getSize() == 0) ||
+			ring.isFull() != (model.getSize() == sz))
+		return false;
+
+	unsigned int i = 0;
+	for (typename RingBuffer<long, sz>::const_iterator it = ring.begin();
+			it != ring.end(); ++it, i++) {
+		if (*it != model[i] || ring[i] != model[i])
+			return false;
+	}
+	return i == model.getSize() &&
+		(ring.isEmpty() || ring.peekLast() == model[model.getSize() - 1]);
+}
+
+// random puts, gets, bulk ops and clears on both, compared after each
+template<unsigned int sz>
+bool matchesModulo()
+{
+	RingBuffer<long, sz> ring;
+	ModuloRing<long, sz> model;
+	long next = 0;
+	long buf[3 * sz];
+
+	// fill once so gcc sees the storage written at the one-element size
+	for (unsigned int i = 0; i < sz; i++)
+		ring.put(0);
+	ring.clear();
+	state = 2463534242UL + sz;
+	for (int step = 0; step < 2000; step++) {
+		uint32_t r = random32();
+		unsigned int n = random32() % (sz * 5 / 2 + 2);
+
+		switch (r % 16) {
+			case 0: case 1: case 2: case 3: case 4: case 5:
+				ring.put(next);
+				model.put(next++);
+				break;
+			case 6: case 7: case 8: case 9:
+				if (model.getSize() && ring.get() != model.get())
+					return false;
+				break;
+			case 10: case 11:
+				for (unsigned int i = 0; i < n; i++) {
+					buf[i] = next;
+					model.put(next++);
+				}
+				ring.putMany(buf, n);
+				break;
+			case 12: case 13: {
+				unsigned int want = n < 0xFF ? n : 0xFF;
+				unsigned int got = ring.drainInto(buf, want);
+				unsigned int expect = want < model.getSize() ? want : model.getSize();
+				if (got != expect)
+					return false;
+				for (unsigned int i = 0; i < got; i++) {
+					if (buf[i] != model.get())
+						return false;
+				}
+				break;
+			}
+			case 14:
+				// writes through the iterator and the index
+				if (!ring.isEmpty()) {
+					*ring.begin() += 1;
+					ring[0] -= 1;
+				}
+				break;
+			default:
+				if (r % 64 == 15) {
+					ring.clear();
+					model.clear();
+				}
+				break;
+		}
+		if (!same(ring, model))
+			return false;
+	}
+	return true;
+}
+
+}
+
+TEST(RingBuffer, sizeOfIndexFollowsCapacity)
+{
+	CHECK_EQUAL(1u, sizeof(RingBuffer<char, 255>::size_type));
+	CHECK_EQUAL(sizeof(unsigned int), sizeof(RingBuffer<char, 256>::size_type));
+	CHECK(sizeof(RingBuffer<char, 64>) == 2 + 64);
+}
+
+TEST(RingBuffer, powersOfTwoMatchTheModuloRing)
+{
+	CHECK(matchesModulo<1>());
+	CHECK(matchesModulo<2>());
+	CHECK(matchesModulo<64>());
+	CHECK(matchesModulo<128>());
+	CHECK(matchesModulo<1024>());
+}
+
+TEST(RingBuffer, otherSizesMatchTheModuloRing)
+{
+	CHECK(matchesModulo<3>());
+	CHECK(matchesModulo<7>());
+	CHECK(matchesModulo<100>());
+	CHECK(matchesModulo<255>());
+	CHECK(matchesModulo<1000>());
+}
+
+TEST(RingBuffer, putManyKeepsTheNewest)
+{
+	RingBuffer<int, 8> ring;
+	int src[20];
+	for (int i = 0; i < 20; i++)
+		src[i] = i;
+
+	ring.put(-1);
+	ring.putMany(src, 20);
+	CHECK(ring.isFull());
+	CHECK_EQUAL(12, ring[0]);
+	CHECK_EQUAL(19, ring.peekLast());
+
+	int dst[8];
+	CHECK_EQUAL(8, ring.drainInto(dst, 10));
+	CHECK_EQUAL(12, dst[0]);
+	CHECK_EQUAL(19, dst[7]);
+	CHECK(ring.isEmpty());
+}
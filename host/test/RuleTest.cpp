@@ -0,0 +1,145 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Buffer.h"
+#include "HostBoard.h"
+
+#include <RuleCompiler.h>
+#include <RuleEngine.h>
+#include <Util.h>
+#include <stdio.h>
+
+
+namespace {
+
+struct Action {
+	switch_id_t id;
+	byte op;
+};
+
+Action done[8];
+int count;
+bool switchOn[8];
+
+bool isOn(switch_id_t id) { return switchOn[id]; }
+float sensor(byte) { return 12.5; }
+
+void action(switch_id_t id, byte op)
+{
+	if (count < 8) {
+		done[count].id = id;
+		done[count].op = op;
+		count++;
+	}
+}
+
+// the fields of a posted form, "key=value&flag&..."
+bool compile(RuleProgram& prog, const char* form)
+{
+	RuleCompiler compiler;
+	char buf[128];
+	snprintf(buf, sizeof(buf), "%s", form);
+
+	for (char* key = strtok(buf, "&"); key; key = strtok(NULL, "&")) {
+		char* value = strchr(key, '=');
+		if (value)
+			*value++ = '\0';
+		compiler.add(key, value);
+	}
+	prog.setActive(true);
+	return compiler.compile(prog);
+}
+
+}
+
+TEST(Rule, compiledFormAsText)
+{
+	RuleProgram prog;
+	Buffer b;
+
+	CHECK(compile(prog, "rf=1234&from=18:00&until=23:00&ifSwitch=2&is=0&act=1&switch=1&wait=600&act=0&switch=1"));
+	b << RuleText(prog);
+	CHECK_EQUAL(0, strcmp("rf 1234; if 18:00-23:00; if 2 off; on 1; wait 600; off 1", b.text));
+
+	// no trigger, or conditions that do not fit
+	CHECK(!compile(prog, "act=1&switch=1"));
+	CHECK(!compile(prog, "rf=1&switch=1&switch=2&switch=3&switch=4&switch=5&switch=6&switch=7&switch=8&switch=9"));
+}
+
+TEST(Rule, conditionsGateTheActions)
+{
+	TimerWheel timers;
+	RuleProgram prog;
+	RuleEngine engine(timers, isOn, sensor, action);
+
+	CHECK(compile(prog, "rf=77&tue&from=18:00&until=23:30&ifSwitch=2&is=0&sensor=0&cmp=0&level=50&act=1&switch=3&act=0&switch=4"));
+	engine.begin(&prog, 1);
+
+	count = 0;
+	engine.onCode(77, DateTime(0, 15, 19, 3, 4, 5, 2022));
+	CHECK_EQUAL(2, count);
+	CHECK_EQUAL(3, done[0].id);
+	CHECK_EQUAL(RuleProgram::SWITCH_ON, done[0].op);
+	CHECK_EQUAL(4, done[1].id);
+	CHECK_EQUAL(RuleProgram::SWITCH_OFF, done[1].op);
+
+	count = 0;
+	// another code, outside the window, on a Wednesday, switch 2 on
+	engine.onCode(78, DateTime(0, 15, 19, 3, 4, 5, 2022));
+	engine.onCode(77, DateTime(0, 45, 23, 3, 4, 5, 2022));
+	engine.onCode(77, DateTime(0, 15, 19, 4, 5, 5, 2022));
+	switchOn[2] = true;
+	engine.onCode(77, DateTime(0, 15, 19, 3, 4, 5, 2022));
+	switchOn[2] = false;
+	CHECK_EQUAL(0, count);
+
+	prog.setActive(false);
+	engine.onCode(77, DateTime(0, 15, 19, 3, 4, 5, 2022));
+	CHECK_EQUAL(0, count);
+}
+
+TEST(Rule, waitResumesOnTheTimer)
+{
+	HostBoard::useSimulatedClock(1000000);
+	TimerWheel timers;
+	RuleProgram prog;
+	RuleEngine engine(timers, isOn, sensor, action);
+	DateTime now(0, 0, 12, 2, 3, 5, 2022);
+	uint16_t data;
+
+	timers.begin();
+	CHECK(compile(prog, "rf=5&act=1&switch=1&wait=2&act=0&switch=1"));
+	engine.begin(&prog, 1);
+
+	count = 0;
+	engine.onCode(5, now);
+	CHECK_EQUAL(1, count);
+	CHECK_EQUAL(1, engine.getPending());
+
+	delay(1900);
+	CHECK(!timers.poll(data));
+	delay(200);
+	CHECK(timers.poll(data));
+	CHECK(data & RuleEngine::TIMER_TAG);
+	engine.resume(data, now);
+
+	CHECK_EQUAL(2, count);
+	CHECK_EQUAL(RuleProgram::SWITCH_OFF, done[1].op);
+	CHECK_EQUAL(0, engine.getPending());
+}
@@ -0,0 +1,209 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <Scene.h>
+
+
+namespace {
+	// rf switches the other suites leave alone, and the scene of them
+	const switch_id_t FIRST = 20;
+	const switch_id_t COUNT = 3;
+	const byte SCENE = 1;
+	const switch_id_t SCENE_TARGET = 1000;
+
+	const char AUTH[] = "Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n";
+
+	void ready()
+	{
+		bootSketch();
+		while (!profiler.isReached(Profiler::BOOT_CONFIG))
+			loop();
+		HostBoard::connectRadio(5);
+		for (switch_id_t id = FIRST; id < FIRST + COUNT; id++) {
+			Switch& sw = switches[id];
+			sw.setGroup("01101");
+			sw.setDevice(id == FIRST ? "00001" : id == FIRST+1 ? "00010" : "00100");
+			sw.setActive(true);
+			sw.setOn(false);
+			registry.setActive(id, true);
+		}
+	}
+
+	void done()
+	{
+		for (switch_id_t id = FIRST; id < FIRST + COUNT; id++) {
+			registry.setActive(id, false);
+			switches[id].setActive(false);
+		}
+		scenes[SCENE].setBatch(SwitchBatch());
+		scenes.save();
+	}
+
+	// the status code of the response, the radio edges it sent
+	int status(const char* request, unsigned long& edges)
+	{
+		TestClient client(request);
+		unsigned long before = HostBoard::getRadioEdges();
+		handleRequest(client);
+		publishState(false);
+		edges = HostBoard::getRadioEdges() - before;
+		return atoi(client.text + 9);
+	}
+
+	int postScene(const char* body)
+	{
+		char request[256] = "POST /scene HTTP/1.0\r\n";
+		strcat(request, AUTH);
+		strcat(request, body);
+		unsigned long edges;
+		return status(request, edges);
+	}
+
+	// 20 and 21 on, 22 off
+	void storeScene()
+	{
+		CHECK_EQUAL(303, postScene("id=1&name=Evening&on=20+21&off=22&"));
+	}
+
+	bool states(bool a, bool b, bool c)
+	{
+		return switches[FIRST].isOn() == a && switches[FIRST+1].isOn() == b &&
+			switches[FIRST+2].isOn() == c;
+	}
+}
+
+TEST(Scene, emptySceneIsUnused)
+{
+	Scene scene;
+	CHECK(!scene.isActive());
+
+	SwitchBatch b;
+	b.set(3, true);
+	scene.setBatch(b);
+	CHECK(scene.isActive());
+	CHECK(scene.getBatch().has(3));
+	scene.setBatch(SwitchBatch());
+	CHECK(!scene.isActive());
+}
+
+TEST(Scene, storedFromTheScenePage)
+{
+	ready();
+	storeScene();
+	const SwitchBatch& b = scenes[SCENE].getBatch();
+	CHECK_EQUAL(3, b.getCount());
+	CHECK(b.turnOn(20) && b.turnOn(21) && !b.turnOn(22));
+
+	// saved with the other tables
+	CHECK_EQUAL(3, scenes.view()[SCENE].getBatch().getCount());
+
+	// unknown scene, inactive switch, bad list
+	CHECK_EQUAL(400, postScene("id=32&on=20&"));
+	CHECK_EQUAL(400, postScene("id=1&on=20+23&"));
+	CHECK_EQUAL(400, postScene("id=1&on=20,x&"));
+	CHECK_EQUAL(3, scenes[SCENE].getBatch().getCount());
+
+	TestClient mobile("GET /mobile HTTP/1.0\r\n\r\n");
+	handleRequest(mobile);
+	CHECK(strstr(mobile.text, 
+		"href='control/batch?scene=1&redirect=mobile&'>Evening</a>"));
+	done();
+}
+
+TEST(Scene, appliedByBatchRequests)
+{
+	ready();
+	storeScene();
+	unsigned long edges;
+
+	CHECK_EQUAL(200, status("GET /control/batch?scene=1& HTTP/1.0\r\n\r\n", edges));
+	CHECK(states(true, true, false));
+	CHECK(edges > 0);
+	CHECK_EQUAL(200, status("GET /control/batch?scene=1& HTTP/1.0\r\n\r\n", edges));
+	CHECK_EQUAL(0ul, edges);
+
+	// later keys win over the scene
+	CHECK_EQUAL(200, status("GET /control/batch?scene=1&off=20& HTTP/1.0\r\n\r\n", edges));
+	CHECK(states(false, true, false));
+	CHECK_EQUAL(400, status("GET /control/batch?scene=5& HTTP/1.0\r\n\r\n", edges));
+	done();
+}
+
+TEST(Scene, appliedByEventRules)
+{
+	ready();
+	storeScene();
+	EventRule rule;
+	rule.setEventId(0x5a);
+	rule.setSwitchId(SCENE_TARGET + SCENE);
+	rule.setActive(true);
+
+	rule.setOn(true);
+	applyEventRules(rule, 0x5a);
+	CHECK(states(true, true, false));
+
+	// off sets each switch to the other state
+	rule.setOn(false);
+	applyEventRules(rule, 0x5a);
+	CHECK(states(false, false, true));
+
+	// toggle applies a scene that is not fully in effect, else inverts
+	rule.setToggle(true);
+	switches[FIRST].setOn(true);
+	applyEventRules(rule, 0x5a);
+	CHECK(states(true, true, false));
+	applyEventRules(rule, 0x5a);
+	CHECK(states(false, false, true));
+
+	// another code leaves it alone
+	applyEventRules(rule, 0x5b);
+	CHECK(states(false, false, true));
+	done();
+}
+
+TEST(Scene, appliedBySchedules)
+{
+	ready();
+	storeScene();
+	Schedule sched;
+	Week_t days;
+	days.days = 0xff;
+	sched.setDays(days);
+	sched.setSwitchId(SCENE_TARGET + SCENE);
+	sched.setSensorId(0);
+	sched.setThreshold(100);
+	sched.setOn(false);
+	sched.setActive(true);
+
+	// below the threshold the scene, above it the inverse
+	HostBoard::setTemperature(20);
+	applySchedule(sched);
+	CHECK(states(true, true, false));
+	unsigned long edges = HostBoard::getRadioEdges();
+	applySchedule(sched);
+	CHECK_EQUAL(edges, HostBoard::getRadioEdges());
+
+	HostBoard::setTemperature(150);
+	applySchedule(sched);
+	CHECK(states(false, false, true));
+	done();
+}
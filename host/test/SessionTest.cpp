@@ -0,0 +1,134 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+
+namespace {
+	const char LOGIN[] = "POST /login HTTP/1.0\r\n\r\nuser=admin&passw=";
+
+	// the response to request, the state is published after it as the
+	// loop does
+	void serve(TestClient& client)
+	{
+		handleRequest(client);
+		publishState(false);
+	}
+
+	// false if the password is wrong, token gets the cookie otherwise
+	bool login(const char* passw, char* token)
+	{
+		char request[128];
+		strcpy(request, LOGIN);
+		strcat(request, passw);
+		TestClient client(request);
+		serve(client);
+
+		const char* cookie = strstr(client.text, "Set-Cookie: hcs=");
+		if (!cookie)
+			return false;
+		strncpy(token, cookie + 16, Session::TOKEN_SIZE);
+		token[Session::TOKEN_SIZE] = '\0';
+		return true;
+	}
+
+	// GET of uri with the cookie, the status code of the response
+	int get(const char* uri, const char* token)
+	{
+		char request[128];
+		strcpy(request, "GET /");
+		strcat(request, uri);
+		strcat(request, " HTTP/1.0\r\nCookie: hcs=");
+		strcat(request, token);
+		strcat(request, "\r\n\r\n");
+		TestClient client(request);
+		serve(client);
+		return atoi(client.text + 9);
+	}
+
+	void ready()
+	{
+		bootSketch();
+		while (!profiler.isReached(Profiler::BOOT_CONFIG))
+			loop();
+	}
+}
+
+TEST(Session, loginChecksTheCredentials)
+{
+	ready();
+	char token[Session::TOKEN_SIZE+1];
+	CHECK(!login("secret", token));
+	CHECK(!login("", token));
+	CHECK(login("admin", token));
+	CHECK_EQUAL(size_t(Session::TOKEN_SIZE), strlen(token));
+}
+
+TEST(Session, cookieAuthorizesLaterRequests)
+{
+	ready();
+	char token[Session::TOKEN_SIZE+1];
+	CHECK(login("admin", token));
+	CHECK_EQUAL(200, get("switch", token));
+	CHECK_EQUAL(200, get("setting", token));
+	CHECK_EQUAL(401, get("switch", "0123456789abcdef0123456789ab"));
+}
+
+TEST(Session, tamperedCookieIsRejected)
+{
+	ready();
+	char token[Session::TOKEN_SIZE+1];
+	CHECK(login("admin", token));
+
+	// another expiry, and another signature
+	char forged[Session::TOKEN_SIZE+1];
+	strcpy(forged, token);
+	forged[6] = forged[6] == 'f' ? '0' : 'f';
+	CHECK_EQUAL(401, get("switch", forged));
+	strcpy(forged, token);
+	forged[Session::TOKEN_SIZE-1] = forged[Session::TOKEN_SIZE-1] == '0' ? '1' : '0';
+	CHECK_EQUAL(401, get("switch", forged));
+	CHECK_EQUAL(200, get("switch", token));
+}
+
+TEST(Session, expiredCookieIsRejected)
+{
+	ready();
+	char token[Session::TOKEN_SIZE+1];
+	CHECK(login("admin", token));
+	HostBoard::advance((Session::TTL - 1000) * 1000);
+	CHECK_EQUAL(200, get("switch", token));
+	HostBoard::advance(2000000);
+	CHECK_EQUAL(401, get("switch", token));
+}
+
+TEST(Session, logoutRevokesTheCookie)
+{
+	ready();
+	char token[Session::TOKEN_SIZE+1];
+	char other[Session::TOKEN_SIZE+1];
+	CHECK(login("admin", token));
+	CHECK(login("admin", other));
+
+	CHECK_EQUAL(303, get("logout", token));
+	CHECK_EQUAL(401, get("switch", token));
+	// only the session that logged out
+	CHECK_EQUAL(200, get("switch", other));
+}
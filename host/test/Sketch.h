@@ -0,0 +1,99 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include "HostBoard.h"
+
+#include <Arena.h>
+#include <Client.h>
+#include <ClientHelper.h>
+#include <Event.h>
+#include <Feedback.h>
+#include <GatewayServer.h>
+#include <HumidSensor.h>
+#include <LightSensor.h>
+#include <NamePool.h>
+#include <Profiler.h>
+#include <Resync.h>
+#include <SavedArray.h>
+#include <Scene.h>
+#include <Schedule.h>
+#include <Session.h>
+#include <Switch.h>
+#include <SwitchRegistry.h>
+#include <TempSensor.h>
+#include <WebServer.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// The parts of the sketch the tests reach into.
+void setup();
+void loop();
+void doSwitch(Switch&, bool, bool);
+bool handleRequest(Client&);
+void sendPage(Client&, ClientHelper&, const char*);
+void publishState(bool);
+void applyEventRules(const EventRule&, unsigned long);
+void applySchedule(const Schedule&);
+
+extern SavedArray<Switch, Switch::MAX> switches;
+extern SavedArray<Schedule, 64> schedules;
+extern SavedArray<EventRule, 64> eventRules;
+extern SavedArray<Feedback, Switch::MAX> feedback;
+extern SavedArray<Scene, 32> scenes;
+extern SwitchRegistry<Switch::MAX> registry;
+extern NamePool& names;
+extern WebServer& webServer;
+extern GatewayServer server;
+extern Session session;
+extern Resync& resync;
+extern Profiler profiler;
+extern byte learnRule;
+extern Sensor* sensors[];
+extern Arena<ARENA_SIZEOF(TempSensor) + 
+	ARENA_SIZEOF(LightSensor) + 
+	ARENA_SIZEOF(HumidSensor)> sensorArena;
+
+// Boots the sketch once per process, as after a reset, with the radio
+// looped back to the transmitter. A first boot writes every table at 
+// once, it is left to a child so that this one loads them like any 
+// later boot.
+inline void bootSketch()
+{
+	static bool booted = false;
+
+	if (booted)
+		return;
+	setenv("HOMECONTROL_PORT", "0", 0);
+	HostBoard::useSimulatedClock(1000000);
+	pid_t child = fork();
+	if (child == 0) {
+		setup();
+		_exit(0);
+	}
+	waitpid(child, NULL, 0);
+
+	HostBoard::connectRadio(5);
+	setup();
+	booted = true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <SavedArray.h>
+#include <Switch.h>
+#include <Time.h>
+#include <WebServer.h>
+
+
+namespace {
+	EEMEM byte switches_ee[sizeof(Switch) * 4];
+	EEMEM byte time_ee[sizeof(Time)];
+	EEMEM byte server_ee[sizeof(WebServer)];
+}
+
+TEST(Storage, changesPersistOnlyOnSave)
+{
+	SavedArray<Switch, 4> switches(&switches_ee);
+
+	switches[1].setId(7);
+	switches.save();
+	switches[1].setId(9);
+	CHECK_EQUAL(9, switches[1].getId());
+
+	// another array on the same location sees the saved state
+	SavedArray<Switch, 4> other(&switches_ee);
+	other.load();
+	CHECK_EQUAL(7, other[1].getId());
+
+	switches.load();
+	CHECK_EQUAL(7, switches[1].getId());
+}
+
+TEST(Storage, viewReadsTheSavedStateInPlace)
+{
+	SavedArray<Switch, 4> switches(&switches_ee);
+
+	switches[2].setId(5);
+	switches.save();
+	const Switch* saved = switches.view();
+	CHECK_EQUAL(5, saved[2].getId());
+
+	// no copy, later saves show through the same pointer
+	switches[2].setId(6);
+	CHECK_EQUAL(5, saved[2].getId());
+	switches.save();
+	CHECK_EQUAL(6, saved[2].getId());
+	SavedArray<Switch, 4> other(&switches_ee);
+	CHECK(saved == other.view());
+}
+
+TEST(Storage, addressesSurviveARestart)
+{
+	SavedArray<Time, 1> timeConf(&time_ee);
+	SavedArray<WebServer, 1> serverConf(&server_ee);
+
+	timeConf.instance().setTimeServer(IPAddress(10, 0, 0, 1));
+	serverConf.instance().setIP(IPAddress(192, 168, 1, 20));
+	serverConf.instance().setMask(IPAddress(255, 255, 255, 0));
+	timeConf.save();
+	serverConf.save();
+
+	SavedArray<Time, 1> loadedTime(&time_ee);
+	SavedArray<WebServer, 1> loadedServer(&server_ee);
+	loadedTime.load();
+	loadedServer.load();
+
+	CHECK(loadedTime.instance().getTimeServer() == IPAddress(10, 0, 0, 1));
+	CHECK(loadedServer.instance().getIP() == IPAddress(192, 168, 1, 20));
+	CHECK(loadedServer.instance().getMask() == IPAddress(255, 255, 255, 0));
+}
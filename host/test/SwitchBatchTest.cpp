@@ -0,0 +1,171 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <SwitchBatch.h>
+
+
+namespace {
+	// rf switches the other suites leave alone
+	const switch_id_t FIRST = 10;
+	const switch_id_t COUNT = 3;
+
+	void addSwitches()
+	{
+		HostBoard::connectRadio(5);
+		for (switch_id_t id = FIRST; id < FIRST + COUNT; id++) {
+			Switch& sw = switches[id];
+			sw.setGroup("10101");
+			sw.setDevice(id == FIRST ? "00001" : id == FIRST+1 ? "00010" : "00100");
+			sw.setActive(true);
+			sw.setOn(false);
+			registry.setActive(id, true);
+		}
+	}
+
+	void removeSwitches()
+	{
+		for (switch_id_t id = FIRST; id < FIRST + COUNT; id++) {
+			registry.setActive(id, false);
+			switches[id].setActive(false);
+		}
+	}
+
+	// the status code of a batch request, edges the radio sent for it,
+	// a value ends at '&' as in the links of the pages
+	int batch(const char* query, unsigned long& edges)
+	{
+		char request[128] = "GET /control/batch?";
+		strcat(request, query);
+		strcat(request, "& HTTP/1.0\r\n\r\n");
+		TestClient client(request);
+		unsigned long before = HostBoard::getRadioEdges();
+		handleRequest(client);
+		edges = HostBoard::getRadioEdges() - before;
+		return atoi(client.text + 9);
+	}
+
+	bool isOn(switch_id_t id)
+	{
+		return switches[id].isOn();
+	}
+}
+
+TEST(SwitchBatch, setsSwitchesAndStates)
+{
+	SwitchBatch b;
+	CHECK(b.isEmpty());
+
+	b.set(2, true);
+	b.set(17, false);
+	b.set(2, false);
+	CHECK_EQUAL(2, b.getCount());
+	CHECK(b.has(2) && b.has(17) && !b.has(3));
+	CHECK(!b.turnOn(2));
+
+	b.clear(17);
+	CHECK_EQUAL(1, b.getCount());
+	b.clear();
+	CHECK(b.isEmpty());
+}
+
+TEST(SwitchBatch, dropsWhatIsAlreadyApplied)
+{
+	SwitchBatch current;
+	current.set(1, true);
+	current.set(2, false);
+	current.set(3, true);
+
+	SwitchBatch b;
+	b.set(1, true);
+	b.set(2, true);
+	b.set(3, false);
+	CHECK(!b.isApplied(current));
+
+	b.dropUnchanged(current);
+	CHECK_EQUAL(2, b.getCount());
+	CHECK(!b.has(1) && b.turnOn(2) && !b.turnOn(3));
+
+	current.merge(b);
+	CHECK(b.isApplied(current));
+}
+
+TEST(SwitchBatch, invertedAndMerged)
+{
+	SwitchBatch b;
+	b.set(0, true);
+	b.set(SwitchBatch::MAX - 1, false);
+
+	SwitchBatch inv = b.inverted();
+	CHECK_EQUAL(2, inv.getCount());
+	CHECK(!inv.turnOn(0) && inv.turnOn(SwitchBatch::MAX - 1));
+
+	SwitchBatch other;
+	other.set(0, false);
+	other.set(5, true);
+	b.merge(other);
+	CHECK_EQUAL(3, b.getCount());
+	CHECK(!b.turnOn(0) && b.turnOn(5));
+}
+
+TEST(SwitchBatch, requestSwitchesOnlyWhatChanges)
+{
+	bootSketch();
+	addSwitches();
+	unsigned long edges;
+
+	CHECK_EQUAL(200, batch("on=10,12", edges));
+	CHECK(edges > 0);
+	CHECK(isOn(10) && !isOn(11) && isOn(12));
+	unsigned long two = edges;
+
+	// already on, nothing to send
+	CHECK_EQUAL(200, batch("on=10,12", edges));
+	CHECK_EQUAL(0ul, edges);
+
+	// later keys win, only 11 changes
+	CHECK_EQUAL(200, batch("off=11&on=10,11", edges));
+	CHECK(isOn(10) && isOn(11) && isOn(12));
+	CHECK(edges > 0 && edges < two);
+
+	CHECK_EQUAL(200, batch("on=10&on=11,12&force=1", edges));
+	CHECK(edges > two);
+
+	CHECK_EQUAL(303, batch("off=all&redirect=status", edges));
+	CHECK(!isOn(10) && !isOn(11) && !isOn(12));
+	removeSwitches();
+}
+
+TEST(SwitchBatch, badRequestSwitchesNothing)
+{
+	bootSketch();
+	addSwitches();
+	unsigned long edges;
+
+	const char* bad[] = { "on=10,13", "on=10&off=99", "on=10,x", "on=", 
+		"on=10&scene=200" };
+	for (unsigned int i = 0; i < sizeof(bad)/sizeof(bad[0]); i++) {
+		CHECK_EQUAL(400, batch(bad[i], edges));
+		CHECK_EQUAL(0ul, edges);
+		CHECK(!isOn(10));
+	}
+	removeSwitches();
+}
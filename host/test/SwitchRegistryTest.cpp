@@ -0,0 +1,171 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <SwitchRegistry.h>
+#include <stdio.h>
+
+
+namespace {
+	const switch_id_t N = 40;
+
+	// xorshift, the same sequence on every run
+	uint32_t state = 2463534242UL;
+
+	uint32_t random32()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// every active id visited once, and nothing else
+	bool same(const SwitchRegistry<N>& registry, const bool* active)
+	{
+		bool seen[N] = { false };
+		switch_id_t count = 0;
+
+		for (switch_id_t id = 0; id < N; id++) {
+			if (registry.isActive(id) != active[id])
+				return false;
+			count += active[id];
+		}
+		if (registry.getCount() != count)
+			return false;
+		for (switch_id_t k = 0; k < registry.getCount(); k++) {
+			switch_id_t id = registry[k];
+			if (id >= N || !active[id] || seen[id])
+				return false;
+			seen[id] = true;
+		}
+		switch_id_t free = registry.getFree();
+		return count == N ? free == Switch::NONE : free < N && !active[free];
+	}
+
+	int post(const char* body)
+	{
+		char request[256] = "POST /switch HTTP/1.0\r\n"
+			"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n";
+		strcat(request, body);
+		TestClient client(request);
+		handleRequest(client);
+		publishState(false);
+		return atoi(client.text + 9);
+	}
+}
+
+TEST(SwitchRegistry, addAndRemove)
+{
+	SwitchRegistry<N> registry;
+	CHECK_EQUAL(0, registry.getCount());
+	CHECK_EQUAL(0, registry.getFree());
+	CHECK(!registry.isActive(0));
+
+	registry.setActive(3, true);
+	registry.setActive(5, true);
+	registry.setActive(7, true);
+	registry.setActive(5, true);
+	CHECK_EQUAL(3, registry.getCount());
+	CHECK(registry.isActive(5));
+
+	registry.setActive(5, false);
+	registry.setActive(5, false);
+	CHECK_EQUAL(2, registry.getCount());
+	CHECK(!registry.isActive(5));
+	CHECK(registry.isActive(3) && registry.isActive(7));
+
+	// out of range is never active and changes nothing
+	registry.setActive(N, true);
+	CHECK(!registry.isActive(N));
+	CHECK_EQUAL(2, registry.getCount());
+}
+
+TEST(SwitchRegistry, freedIdIsReusedFirst)
+{
+	SwitchRegistry<N> registry;
+	for (switch_id_t id = 0; id < 10; id++)
+		registry.setActive(id, true);
+	CHECK_EQUAL(10, registry.getFree());
+
+	registry.setActive(4, false);
+	CHECK_EQUAL(4, registry.getFree());
+	registry.setActive(8, false);
+	CHECK_EQUAL(8, registry.getFree());
+
+	registry.setActive(registry.getFree(), true);
+	CHECK(registry.isActive(8));
+	CHECK_EQUAL(4, registry.getFree());
+}
+
+TEST(SwitchRegistry, fullRegistryHasNoFreeId)
+{
+	SwitchRegistry<N> registry;
+	for (switch_id_t id = 0; id < N; id++)
+		registry.setActive(registry.getFree(), true);
+	CHECK_EQUAL(N, registry.getCount());
+	CHECK_EQUAL(Switch::NONE, registry.getFree());
+
+	registry.setActive(N - 1, false);
+	CHECK_EQUAL(N - 1, registry.getFree());
+}
+
+// random adds and removes, compared with a flag per id after each
+TEST(SwitchRegistry, matchesAFlagArray)
+{
+	SwitchRegistry<N> registry;
+	bool active[N] = { false };
+
+	for (int step = 0; step < 5000; step++) {
+		switch_id_t id = random32() % N;
+		bool on = random32() % 3 != 0;
+		registry.setActive(id, on);
+		active[id] = on;
+		if (!same(registry, active)) {
+			CHECK(same(registry, active));
+			return;
+		}
+	}
+}
+
+TEST(SwitchRegistry, switchFormTakesAFreeId)
+{
+	bootSketch();
+	while (!profiler.isReached(Profiler::BOOT_CONFIG))
+		loop();
+
+	switch_id_t id = registry.getFree();
+	CHECK_EQUAL(303, post("id=&active=1&group=11000&device=00011&"));
+	CHECK(registry.isActive(id));
+	CHECK(switches[id].isActive());
+
+	// removed, the next empty id gets it back
+	char body[64];
+	sprintf(body, "id=%u&active=0&", id);
+	CHECK_EQUAL(303, post(body));
+	CHECK(!registry.isActive(id));
+	CHECK_EQUAL(id, registry.getFree());
+	CHECK_EQUAL(303, post("id=&active=1&group=11000&device=00011&"));
+	CHECK(registry.isActive(id));
+
+	sprintf(body, "id=%u&active=0&", id);
+	CHECK_EQUAL(303, post(body));
+}
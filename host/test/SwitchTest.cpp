@@ -0,0 +1,69 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Buffer.h"
+
+#include <Switch.h>
+#include <Util.h>
+
+
+TEST(Switch, codeWordOfTheDipSwitches)
+{
+	Switch sw;
+	sw.setGroup("10101");
+	sw.setDevice("01000");
+
+	// tri-state 0F0F0 F0FFF, then 0F for on and F0 for off
+	CHECK_EQUAL(0x111151UL, sw.getCode(true));
+	CHECK_EQUAL(0x111154UL, sw.getCode(false));
+
+	Buffer b;
+	b << sw.getGroup() << ' ' << sw.getDevice();
+	CHECK_EQUAL(0, strcmp("10101 01000", b.text));
+}
+
+TEST(Switch, newSwitchHasAllDipsOpen)
+{
+	Switch sw;
+	Buffer b;
+
+	b << sw.getGroup() << sw.getDevice();
+	CHECK_EQUAL(0, strcmp("0000000000", b.text));
+	CHECK_EQUAL(0x555551UL, sw.getCode(true));
+}
+
+TEST(Switch, stateBitsDoNotTouchTheCode)
+{
+	Switch sw;
+	sw.setGroup("11111");
+	sw.setDevice("00001");
+	uint32_t code = sw.getCode(true);
+
+	sw.setOn(true);
+	sw.setPin(true);
+	sw.setActive(true);
+	sw.setScheduled(true);
+	sw.setId(200);
+	sw.setNameId(17);
+
+	CHECK_EQUAL(code, sw.getCode(true));
+	CHECK(sw.isOn() && sw.isPin() && sw.isActive() && sw.isScheduled());
+	CHECK_EQUAL(200, sw.getId());
+	CHECK_EQUAL(17, sw.getNameId());
+}
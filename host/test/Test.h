@@ -0,0 +1,62 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+// Unit tests of the host build. A test registers itself in its suite
+// and fails on the first CHECK that does not hold.
+//
+//   TEST(NamePool, roundTrip)
+//   {
+//   	CHECK_EQUAL(3, pool.getFree());
+//   }
+
+#include <Arduino.h>
+
+class Test {
+	typedef void (*Function)();
+
+	const char* suite;
+	const char* name;
+	Function function;
+	Test* next;
+
+	static Test* first;
+	static Test* last;
+public:
+	Test(const char*, const char*, Function);
+
+	// every test of the suite, or of all suites for NULL
+	static int run(const char*);
+	static void fail(const char* file, int line, const char* what);
+};
+
+#define TEST(suite, name) \
+	void test_##suite##_##name(); \
+	Test register_##suite##_##name(#suite, #name, test_##suite##_##name); \
+	void test_##suite##_##name()
+
+#define CHECK(expr) \
+	do { if (!(expr)) Test::fail(__FILE__, __LINE__, #expr); } while (0)
+
+#define CHECK_EQUAL(expect, actual) \
+	do { if (!((expect) == (actual))) \
+		Test::fail(__FILE__, __LINE__, #actual " != " #expect); } while (0)
+
+#endif
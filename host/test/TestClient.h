@@ -0,0 +1,76 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_CLIENT_H
+#define TEST_CLIENT_H
+
+#include <Client.h>
+#include <string.h>
+
+
+// a connection that reads a fixed request and collects the response,
+// like SocketClient it does not wait for more after the request
+class TestClient : public Client {
+	const char* request;
+	size_t pos;
+public:
+	char text[16384];
+	size_t len;
+
+	TestClient(const char* _request): request(_request), pos(0), len(0)
+	{
+		text[0] = 0;
+		setTimeout(0);
+	}
+
+	virtual int connect(IPAddress, uint16_t) { return 0; }
+	virtual int connect(const char*, uint16_t) { return 0; }
+
+	virtual size_t write(uint8_t c) { return write(&c, 1); }
+
+	virtual size_t write(const uint8_t* buf, size_t n)
+	{
+		if (len + n >= sizeof(text))
+			n = sizeof(text) - 1 - len;
+		memcpy(text + len, buf, n);
+		len += n;
+		text[len] = 0;
+		return n;
+	}
+
+	virtual int available() { return strlen(request + pos); }
+	virtual int read() { return request[pos] ? (unsigned char)request[pos++] : -1; }
+
+	virtual int read(uint8_t* buf, size_t n)
+	{
+		size_t i = 0;
+		for (; i < n && request[pos]; i++)
+			buf[i] = request[pos++];
+		return i;
+	}
+
+	virtual int peek() { return request[pos] ? (unsigned char)request[pos] : -1; }
+	virtual void flush() {}
+	virtual void stop() {}
+	virtual uint8_t connected() { return 1; }
+	virtual operator bool() { return true; }
+
+	using Print::write;
+};
+
+#endif
@@ -0,0 +1,73 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+
+
+namespace {
+	jmp_buf failed;
+}
+
+Test* Test::first = NULL;
+Test* Test::last = NULL;
+
+// in the order of the file
+Test::Test(const char* _suite, const char* _name, Function _function):
+	suite(_suite), name(_name), function(_function), next(NULL)
+{
+	if (last)
+		last->next = this;
+	else
+		first = this;
+	last = this;
+}
+
+int Test::run(const char* suite)
+{
+	int count = 0;
+	int failures = 0;
+
+	for (Test* t = first; t; t = t->next) {
+		if (suite && strcmp(suite, t->suite) != 0)
+			continue;
+		count++;
+		if (setjmp(failed) == 0) {
+			t->function();
+			printf("ok   %s.%s\n", t->suite, t->name);
+		} else {
+			printf("FAIL %s.%s\n", t->suite, t->name);
+			failures++;
+		}
+	}
+	printf("%d of %d tests failed\n", failures, count);
+	return failures || !count;
+}
+
+void Test::fail(const char* file, int line, const char* what)
+{
+	printf("%s:%d: %s\n", file, line, what);
+	longjmp(failed, 1);
+}
+
+int main(int argc, char** argv)
+{
+	return Test::run(argc > 1 ? argv[1] : NULL);
+}
@@ -0,0 +1,47 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "HostBoard.h"
+
+#include <Time.h>
+
+
+TEST(Time, rtcKeepsTheTimeItWasSetTo)
+{
+	HostBoard::useSimulatedClock(5000000);
+	Time rtc;
+	DateTime set(30, 59, 23, 7, 31, 12, 2022);
+
+	rtc.begin();
+	rtc.setTime(set);
+	CHECK(rtc.isRunning());
+
+	DateTime now = rtc.getTime();
+	CHECK_EQUAL(set.getUnix(), now.getUnix());
+
+	// runs with millis(), over midnight and the new year
+	delay(45000);
+	now = rtc.getTime();
+	CHECK_EQUAL(set.getUnix() + 45, now.getUnix());
+	CHECK_EQUAL(2023, now.getYear());
+	CHECK_EQUAL(1, now.getMonth());
+	CHECK_EQUAL(1, now.getDay());
+	CHECK_EQUAL(0, now.getHour());
+	CHECK_EQUAL(15, now.getSecond());
+}
@@ -0,0 +1,144 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "HostBoard.h"
+
+#include <TimerWheel.h>
+
+
+namespace {
+
+// ms until the timer fires, polled every step ms, 0 if it does not
+// within limit ms
+unsigned long fire(TimerWheel& wheel, uint16_t data, unsigned long step, 
+	unsigned long limit)
+{
+	unsigned long start = millis();
+	uint16_t d;
+
+	while (millis() - start <= limit) {
+		if (wheel.poll(d)) {
+			CHECK_EQUAL(data, d);
+			return millis() - start;
+		}
+		delay(step);
+	}
+	return 0;
+}
+
+}
+
+TEST(TimerWheel, firesOneTickLateAtMost)
+{
+	static const unsigned long DELAYS[] = { 1, 63, 64, 65, 1000, 2047, 60000, 600000 };
+	HostBoard::useSimulatedClock(5000000);
+	TimerWheel wheel;
+	wheel.begin();
+
+	for (byte i = 0; i < sizeof(DELAYS) / sizeof(DELAYS[0]); i++) {
+		// at every phase of the tick
+		delay(17);
+		unsigned long ms = DELAYS[i];
+		CHECK(wheel.add(ms, i) != TimerWheel::NONE);
+
+		unsigned long t = fire(wheel, i, 1, ms + 2 * TimerWheel::TICK);
+		CHECK(t >= ms);
+		CHECK(t <= ms + TimerWheel::TICK);
+		CHECK_EQUAL(0, wheel.getUsed());
+	}
+}
+
+TEST(TimerWheel, dueTimerFiresOnTheNextPoll)
+{
+	HostBoard::useSimulatedClock(5000000);
+	TimerWheel wheel;
+	wheel.begin();
+	uint16_t data;
+
+	wheel.add(0, 42);
+	CHECK(wheel.poll(data));
+	CHECK_EQUAL(42, data);
+	CHECK(!wheel.poll(data));
+}
+
+// millis() passes 2^32 on the board after 49.7 days
+TEST(TimerWheel, wrapsWithMillis)
+{
+	HostBoard::useSimulatedClock((0x100000000ULL - 700) * 1000);
+	TimerWheel wheel;
+	wheel.begin();
+
+	wheel.add(500, 1);
+	wheel.add(1500, 2);
+	wheel.add(10 * 60000UL, 3);
+
+	unsigned long t = fire(wheel, 1, 5, 1000);
+	CHECK(t >= 500 && t <= 500 + TimerWheel::TICK);
+	// the second one is due after the wrap
+	t = fire(wheel, 2, 5, 2000);
+	CHECK(t >= 1000 && t <= 1000 + TimerWheel::TICK);
+	CHECK(uint32_t(millis()) < 1000);
+	t = fire(wheel, 3, 100, 10 * 60000UL);
+	CHECK(t > 0);
+	CHECK_EQUAL(0, wheel.getUsed());
+}
+
+TEST(TimerWheel, cancelledTimerNeverFires)
+{
+	HostBoard::useSimulatedClock(5000000);
+	TimerWheel wheel;
+	wheel.begin();
+
+	byte a = wheel.add(1000, 1);
+	byte b = wheel.add(1000, 2);
+	wheel.cancel(a);
+	// twice is harmless
+	wheel.cancel(a);
+	CHECK_EQUAL(1, wheel.getUsed());
+
+	CHECK(fire(wheel, 2, 10, 2000) > 0);
+	CHECK_EQUAL(0, fire(wheel, 1, 10, 2000));
+	wheel.cancel(b);
+	CHECK_EQUAL(0, wheel.getUsed());
+}
+
+TEST(TimerWheel, fullWheelRefusesAndLongDelaysAreCut)
+{
+	HostBoard::useSimulatedClock(5000000);
+	TimerWheel wheel;
+	wheel.begin();
+
+	for (byte i = 0; i < TimerWheel::TIMERS - 1; i++)
+		CHECK(wheel.add(1000, i) != TimerWheel::NONE);
+	CHECK(wheel.add(0xFFFFFFFFUL, 99) != TimerWheel::NONE);
+	CHECK_EQUAL(TimerWheel::NONE, wheel.add(1000, 100));
+
+	uint16_t data;
+	delay(1000 + TimerWheel::TICK);
+	for (byte i = 0; i < TimerWheel::TIMERS - 1; i++)
+		CHECK(wheel.poll(data));
+	CHECK(!wheel.poll(data));
+
+	// the cut one fires at MAX_DELAY
+	delay(TimerWheel::MAX_DELAY - 2000 - 2 * TimerWheel::TICK);
+	CHECK(!wheel.poll(data));
+	delay(1000 + 2 * TimerWheel::TICK);
+	CHECK(wheel.poll(data));
+	CHECK_EQUAL(99, data);
+}
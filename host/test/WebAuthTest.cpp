@@ -0,0 +1,163 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <ClientHelper.h>
+#include <Sha256.h>
+#include <stdio.h>
+
+
+namespace {
+	// admin:admin, the default credential
+	const char BASIC[] = "YWRtaW46YWRtaW4=";
+
+	void digestOf(const char* credential, byte* digest)
+	{
+		Sha256 sha;
+		sha.update(credential, strlen(credential));
+		sha.finish(digest);
+	}
+
+	// isAuthorized() on a request with the given header lines
+	bool authorized(const char* request, const char* credential = BASIC)
+	{
+		byte digest[Sha256::SIZE];
+		digestOf(credential, digest);
+		TestClient client(request);
+		ClientHelper webClient(&client);
+		webClient.getRequestType();
+		webClient.getRequestURI();
+		return webClient.isAuthorized(digest);
+	}
+
+	// the status code of the sketch's response to request
+	int status(const char* request)
+	{
+		TestClient client(request);
+		handleRequest(client);
+		publishState(false);
+		return atoi(client.text + 9);
+	}
+
+	void ready()
+	{
+		bootSketch();
+		while (!profiler.isReached(Profiler::BOOT_CONFIG))
+			loop();
+	}
+
+	bool hex(const byte* digest, const char* expect)
+	{
+		char text[2*Sha256::SIZE+1];
+		for (byte i = 0; i < Sha256::SIZE; i++)
+			sprintf(text + 2*i, "%02x", digest[i]);
+		return strcmp(text, expect) == 0;
+	}
+}
+
+TEST(WebAuth, sha256MatchesTheStandardVectors)
+{
+	byte digest[Sha256::SIZE];
+	digestOf("", digest);
+	CHECK(hex(digest, 
+		"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+	digestOf("abc", digest);
+	CHECK(hex(digest, 
+		"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+}
+
+TEST(WebAuth, onlyTheAuthorizationHeaderCounts)
+{
+	CHECK(authorized("GET /switch HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK(authorized("GET /switch HTTP/1.0\r\n"
+		"authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK(!authorized("GET /switch HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46c2VjcmV0\r\n\r\n"));
+	CHECK(!authorized("GET /switch HTTP/1.0\r\n"
+		"Authorization: Bearer YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK(!authorized("GET /switch HTTP/1.0\r\n"
+		"X-Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK(!authorized("GET /switch HTTP/1.0\r\n"
+		"Referer: /?Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK(!authorized("POST /switch HTTP/1.0\r\n\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n"));
+	CHECK(!authorized("GET /switch HTTP/1.0\r\n\r\n"));
+}
+
+TEST(WebAuth, longLinesAndCredentials)
+{
+	// a line longer than the buffer before the header
+	CHECK(authorized("GET /switch HTTP/1.0\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+
+	// longer than the line buffer, hashed from the stream
+	const char* longer = "YWRtaW46YWxvbmdlcnBhc3N3b3JkdGhhbmJlZm9yZTEyMzQ1Njc4";
+	char request[160] = "GET /switch HTTP/1.0\r\nAuthorization: Basic ";
+	strcat(request, longer);
+	strcat(request, "\r\n\r\n");
+	CHECK(authorized(request, longer));
+	CHECK(!authorized(request, BASIC));
+}
+
+TEST(WebAuth, bodyFollowsTheCheck)
+{
+	byte digest[Sha256::SIZE];
+	digestOf(BASIC, digest);
+	TestClient client("POST /time HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n"
+		"Content-Type: application/x-www-form-urlencoded\r\n\r\n"
+		"offset=2");
+	ClientHelper webClient(&client);
+	CHECK_EQUAL(ClientHelper::POST, webClient.getRequestType());
+	CHECK(strcmp("time", webClient.getRequestURI()) == 0);
+	CHECK(webClient.isAuthorized(digest));
+	webClient.skipHeader();
+	CHECK(strcmp("offset", webClient.getKey()) == 0);
+	CHECK_EQUAL(2, webClient.getValueInt());
+}
+
+TEST(WebAuth, sketchChecksTheStoredDigest)
+{
+	ready();
+	CHECK_EQUAL(401, status("GET /switch HTTP/1.0\r\n\r\n"));
+	CHECK_EQUAL(401, status("GET /switch HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46c2VjcmV0\r\n\r\n"));
+	// the URI is still there once the credential is checked
+	CHECK_EQUAL(200, status("GET /switch HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+	CHECK_EQUAL(200, status("GET /setting HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\n"));
+}
+
+TEST(WebAuth, sketchDispatchesAuthorizedPosts)
+{
+	ready();
+	CHECK_EQUAL(401, status("POST /time HTTP/1.0\r\n\r\nunknown=1"));
+
+	// an unknown key leaves the time settings as they are
+	TestClient client("POST /time HTTP/1.0\r\n"
+		"Authorization: Basic YWRtaW46YWRtaW4=\r\n\r\nunknown=1");
+	handleRequest(client);
+	CHECK_EQUAL(303, atoi(client.text + 9));
+	CHECK(strstr(client.text, "Location: /setting"));
+}
@@ -0,0 +1,128 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "Sketch.h"
+#include "TestClient.h"
+
+#include <Util.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+
+namespace {
+	// a request to the gateway, answered by a worker or by loop()
+	class Request {
+		int fd;
+	public:
+		char text[16384];
+		size_t len;
+
+		Request(const char* request): len(0)
+		{
+			text[0] = 0;
+			fd = socket(AF_INET, SOCK_STREAM, 0);
+			struct sockaddr_in addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			addr.sin_port = htons(server.getPort());
+			CHECK(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+			CHECK(send(fd, request, strlen(request), MSG_NOSIGNAL) > 0);
+		}
+
+		~Request() { close(fd); }
+
+		// true once the response is complete, with passes of loop() 
+		// in between if the loop should serve it
+		bool wait(int ms, bool serve)
+		{
+			for (int i = 0; i < ms; i++) {
+				if (serve)
+					loop();
+				struct pollfd p = { fd, POLLIN, 0 };
+				if (poll(&p, 1, 1) <= 0)
+					continue;
+				ssize_t n = recv(fd, text + len, sizeof(text) - 1 - len, 0);
+				if (n <= 0)
+					return len > 0;
+				len += n;
+				text[len] = 0;
+			}
+			return false;
+		}
+	};
+
+	void ready()
+	{
+		bootSketch();
+		while (!profiler.isReached(Profiler::BOOT_NETWORK))
+			loop();
+		publishState(false);
+	}
+}
+
+TEST(Worker, pagesAreServedWithoutTheLoop)
+{
+	ready();
+	Request status("GET /status HTTP/1.0\r\n\r\n");
+	CHECK(status.wait(2000, false));
+	CHECK(strncmp(status.text, "HTTP/1.0 200 OK", 15) == 0);
+}
+
+// metrics read the tracker, receiver, rule engine and timers, which 
+// only loop() changes
+TEST(Worker, liveStateIsLeftToTheLoop)
+{
+	ready();
+	const char* live[] = { "GET /metrics HTTP/1.0\r\n\r\n", 
+		"GET /control/batch?off=99& HTTP/1.0\r\n\r\n", 
+		"POST /login HTTP/1.0\r\n\r\nuser=admin&passw=x" };
+
+	for (unsigned int i = 0; i < sizeof(live)/sizeof(live[0]); i++) {
+		Request request(live[i]);
+		CHECK(!request.wait(200, false));
+		CHECK(request.wait(2000, true));
+	}
+
+	Request metrics("GET /metrics HTTP/1.0\r\n\r\n");
+	CHECK(metrics.wait(2000, true));
+	CHECK(strstr(metrics.text, "\nhomecontrol_uptime_seconds "));
+}
+
+TEST(Worker, footerShowsThePublishedMemory)
+{
+	ready();
+	int peak = memStat().heapPeak;
+
+	// not published yet, the pages keep the marks of the last copy
+	memStat().heapPeak = 4321;
+	Request before("GET /status HTTP/1.0\r\n\r\n");
+	CHECK(before.wait(2000, false));
+	CHECK(!strstr(before.text, ", heap peak 4321)"));
+
+	publishState(false);
+	Request after("GET /status HTTP/1.0\r\n\r\n");
+	CHECK(after.wait(2000, false));
+	CHECK(strstr(after.text, ", heap peak 4321)"));
+
+	memStat().heapPeak = peak;
+	publishState(false);
+}
@@ -0,0 +1,81 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "Arduino.h"
+
+#ifdef __BIGGEST_ALIGNMENT__
+#define ARENA_ALIGN __BIGGEST_ALIGNMENT__
+#else
+#define ARENA_ALIGN 1
+#endif
+
+// space one object of type T takes up in an arena
+#define ARENA_SIZEOF(T) \
+	((sizeof(T) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+// construct an object in an arena, e.g. ARENA_NEW(arena, TempSensor)(pin)
+// the class has to provide a placement operator new, see Sensor
+#define ARENA_NEW(arena, T) new ((arena).alloc(sizeof(T))) T
+
+
+// Static storage for objects that live as long as the sketch.
+// Nothing is freed, so the heap is never touched and cannot fragment.
+template<unsigned int sz> class Arena {
+	unsigned int used;
+	byte data[sz] __attribute__((aligned(ARENA_ALIGN)));
+public:
+	Arena();
+
+	void* alloc(unsigned int);
+
+	unsigned int getUsed() const;
+	unsigned int getFree() const;
+};
+
+template<unsigned int sz>
+Arena<sz>::Arena():
+	used(0)
+{}
+
+template<unsigned int sz>
+void* Arena<sz>::alloc(unsigned int n)
+{
+	n = (n + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+	if (n > sz - used)
+		return NULL;
+	void* p = data + used;
+	used += n;
+	return p;
+}
+
+template<unsigned int sz>
+unsigned int Arena<sz>::getUsed() const
+{
+	return used;
+}
+
+template<unsigned int sz>
+unsigned int Arena<sz>::getFree() const
+{
+	return sz - used;
+}
+
+#endif
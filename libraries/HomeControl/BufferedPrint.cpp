@@ -0,0 +1,61 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BufferedPrint.h"
+
+
+BufferedPrint::BufferedPrint(Print& _out):
+	out(_out), used(0)
+{}
+
+BufferedPrint::~BufferedPrint()
+{
+	flush();
+}
+
+size_t BufferedPrint::write(uint8_t c)
+{
+	if (used == SIZE)
+		flush();
+	buf[used++] = c;
+	return 1;
+}
+
+size_t BufferedPrint::write(const uint8_t* data, size_t n)
+{
+	size_t left = n;
+
+	while (left) {
+		if (used == SIZE)
+			flush();
+		size_t k = SIZE - used;
+		if (k > left)
+			k = left;
+		memcpy(buf + used, data, k);
+		used += k;
+		data += k;
+		left -= k;
+	}
+	return n;
+}
+
+void BufferedPrint::flush()
+{
+	if (used)
+		out.write(buf, used);
+	used = 0;
+}
@@ -0,0 +1,50 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BUFFERED_PRINT_H
+#define BUFFERED_PRINT_H
+
+#include "Arduino.h"
+#include <Print.h>
+
+
+// Collects small writes before passing them on, so a page built from
+// many short pieces goes out as a few full packets instead of one 
+// per piece.
+class BufferedPrint : public Print {
+public:
+#ifdef __AVR__
+	static const byte SIZE = 64;
+#else
+	static const unsigned int SIZE = 1024;
+#endif
+private:
+	Print& out;
+	uint8_t buf[SIZE];
+	unsigned int used;
+public:
+	BufferedPrint(Print&);
+	~BufferedPrint();
+
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+	using Print::write;
+
+	void flush();
+};
+
+#endif
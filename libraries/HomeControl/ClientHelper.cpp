@@ -20,18 +20,30 @@
 
 
 namespace {
-	const int MAX_SIZE = 32;
-	char buffer[MAX_SIZE+1];
 
-	inline void clearBuffer()
+	int hexValue(char c)
 	{
-		memset(buffer, 0, sizeof(buffer));
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
 	}
 }
 
 ClientHelper::ClientHelper(Client* _client):
-	client(_client)
-{}
+	client(_client), query(NULL)
+{
+	token[0] = '\0';
+	clearBuffer();
+}
+
+inline void ClientHelper::clearBuffer()
+{
+	memset(buffer, 0, sizeof(buffer));
+}
 
 int ClientHelper::getRequestType()
 {
@@ -47,23 +59,58 @@ int ClientHelper::getRequestType()
 	return ClientHelper::UNKNOWN;
 }
 
-// if uri begins with c, handle it like a GET query
+// if uri begins with c, handle it like a GET query, other queries 
+// are cut off and kept for getQuery()
 const char* ClientHelper::getRequestURI(char c)
 {
 	clearBuffer();
+	query = NULL;
 
 	c = client->peek() == c ? '?' : ' ';
 	
-	if (client->readBytesUntil(c, buffer, sizeof(buffer))) 
+	if (client->readBytesUntil(c, buffer, sizeof(buffer))) {
+		char* q = strchr(buffer, '?');
+		if (q) {
+			*q = '\0';
+			query = q + 1;
+		}
 		return buffer;
+	}
 
 	return NULL;
 }
 
+// valid until the next read into the buffer
+const char* ClientHelper::getQuery() const
+{
+	return query;
+}
+
+// One header line without "\r\n" into line, MAX_SIZE+1 bytes, so the
+// URI in buffer stays valid. more is set if the line did not fit and 
+// its rest is still unread.
+size_t ClientHelper::readLine(char* line, bool& more)
+{
+	size_t n = client->readBytesUntil('\n', line, MAX_SIZE);
+	line[n] = '\0';
+	more = n == MAX_SIZE;
+	if (n && line[n-1] == '\r')
+		line[--n] = '\0';
+	return n;
+}
+
 bool ClientHelper::skipHeader()
 {
-	char sep[] = "\r\n\r\n";
-	return client->find(sep, strlen(sep));
+	char line[MAX_SIZE+1];
+	bool more;
+	char nl[] = "\n";
+
+	for (;;) {
+		if (!readLine(line, more))
+			return true;
+		if (more && !client->find(nl, 1))
+			return false;
+	}
 }
 
 char* ClientHelper::getKey()
@@ -89,6 +136,11 @@ const char* ClientHelper::getValue()
 	return NULL;
 }
 
+const char* ClientHelper::getValueDecoded()
+{
+	return getValue() ? urlDecode(buffer) : NULL;
+}
+
 int ClientHelper::getValueInt()
 {
 	return client->parseInt();	
@@ -101,16 +153,136 @@ float ClientHelper::getValueFloat()
 
 const uint8_t* ClientHelper::getValueIP()
 {
-	static uint8_t ip[4] = {0};
-	
 	for (int i = 0; i < 4; i++)
 		ip[i] = client->parseInt();
 
 	return ip;
 }
 
-bool ClientHelper::isAuthorized(char* base64)
+bool ClientHelper::isAuthorized(const byte* digest, const Session* session)
+{
+	const char AUTH[] = "Authorization:";
+	const size_t AUTH_SIZE = sizeof(AUTH) - 1;
+	char line[MAX_SIZE+1];
+	bool more;
+	char nl[] = "\n";
+
+	token[0] = '\0';
+	for (;;) {
+		size_t n = readLine(line, more);
+		if (!n)
+			return false;	// end of header, no credential
+		if (n >= AUTH_SIZE && strncasecmp(line, AUTH, AUTH_SIZE) == 0)
+			return checkCredential(line + AUTH_SIZE, more, digest);
+		if (session && checkCookie(line, session)) {
+			if (more)
+				client->find(nl, 1);
+			return true;
+		}
+		if (more && !client->find(nl, 1))
+			return false;
+	}
+}
+
+// only a cookie within the line buffer is seen, the device sets no other
+bool ClientHelper::checkCookie(char* line, const Session* session)
 {
-	return client->find(base64, strlen(base64));
+	if (strncasecmp(line, "Cookie:", 7) != 0)
+		return false;
+
+	size_t len = strlen(Session::COOKIE);
+	for (char* p = line + 7; (p = strstr(p, Session::COOKIE)) != NULL; p += len) {
+		char* t = p + len;
+		if (*t != '=' || (p[-1] != ' ' && p[-1] != ';' && p[-1] != ':'))
+			continue;
+		t++;
+		if (strlen(t) < Session::TOKEN_SIZE || 
+				(t[Session::TOKEN_SIZE] && t[Session::TOKEN_SIZE] != ';'))
+			return false;
+		t[Session::TOKEN_SIZE] = '\0';
+		if (!session->verify(t))
+			return false;
+		strcpy(token, t);
+		return true;
+	}
+	return false;
 }
 
+const char* ClientHelper::getToken() const
+{
+	return token[0] ? token : NULL;
+}
+
+// s is the rest of the Authorization line, a longer 
+// credential is hashed on from the stream
+bool ClientHelper::checkCredential(const char* s, bool more, const byte* digest)
+{
+	while (*s == ' ')
+		s++;
+	if (strncasecmp(s, "Basic ", 6) != 0)
+		return false;
+	s += 6;
+	while (*s == ' ')
+		s++;
+
+	Sha256 sha;
+	byte len = 0;
+	char c;
+
+	while ((c = *s++) != '\0' && c != ' ') {
+		sha.update(c);
+		len++;
+	}
+	while (more && c != ' ' && client->readBytes(&c, 1) == 1) {
+		if (c == '\r' || c == '\n' || c == ' ')
+			break;
+		if (++len > MAX_CREDENTIAL)
+			return false;
+		sha.update(c);
+	}
+	// leave the stream at the next header line
+	char nl[] = "\n";
+	if (more && c != '\n')
+		client->find(nl, 1);
+	if (!len)
+		return false;
+
+	byte hash[Sha256::SIZE];
+	sha.finish(hash);
+	return Sha256::equals(hash, digest);
+}
+
+bool ClientHelper::getParam(const char* q, const char* key, unsigned long& v)
+{
+	size_t len = strlen(key);
+
+	for (const char* p = q; p; p = strchr(p, '&')) {
+		if (*p == '&')
+			p++;
+		if (strncmp(p, key, len) == 0 && p[len] == '=') {
+			v = strtoul(p + len + 1, NULL, 10);
+			return true;
+		}
+	}
+	return false;
+}
+
+char* ClientHelper::urlDecode(char* s)
+{
+	char* out = s;
+
+	for (const char* p = s; *p; p++) {
+		int hi, lo;
+		if (*p == '+') {
+			*out++ = ' ';
+		} else if (*p == '%' && (hi = hexValue(p[1])) >= 0 && 
+				(lo = hexValue(p[2])) >= 0) {
+			*out++ = hi << 4 | lo;
+			p += 2;
+		} else {
+			*out++ = *p;
+		}
+	}
+	*out = '\0';
+	return s;
+}
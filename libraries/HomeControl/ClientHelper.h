@@ -20,28 +20,57 @@
 #define CLIENT_HELPER_H
 
 #include "Client.h"
+#include "Session.h"
+#include "Sha256.h"
 
 
 class ClientHelper {
+	static const int MAX_SIZE = 48;
+
 	Client* client;
-	
+	char buffer[MAX_SIZE+1];
+	char* query;
+	char token[Session::TOKEN_SIZE+1];
+	uint8_t ip[4];
+
+	void clearBuffer();
+	size_t readLine(char*, bool& more);
+	bool checkCredential(const char*, bool more, const byte* digest);
+	bool checkCookie(char*, const Session*);
 public:
 	ClientHelper(Client*);
 	
 	int getRequestType(); 
 	const char* getRequestURI(char = '-');
+	const char* getQuery() const;
 	bool skipHeader();
 	char* getKey();
 	const char* getValue();
+	// value with %XX and '+' decoded
+	const char* getValueDecoded();
 	int getValueInt();
 	float getValueFloat();
 	const uint8_t* getValueIP();
 
-	bool isAuthorized(char*);
+	// Reads header lines up to the Authorization line and checks its
+	// Basic credential against digest, the SHA-256 of the base64 text.
+	// A session cookie that session verifies is accepted as well.
+	// The rest of the header is left for skipHeader().
+	bool isAuthorized(const byte* digest, const Session* session = NULL);
+	// session token that authorized the request, or NULL
+	const char* getToken() const;
+
+	// value of key in a query like "since=123&code=4"
+	static bool getParam(const char* query, const char* key, unsigned long&);
+	// in place, returns s
+	static char* urlDecode(char* s);
 
 	static const int GET = 1;
 	static const int POST = 2;
 	static const int UNKNOWN = 3;
+
+	// longest Basic credential that is hashed, longer ones are refused
+	static const byte MAX_CREDENTIAL = 96;
 };
 
 #endif
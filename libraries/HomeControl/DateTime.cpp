@@ -17,6 +17,7 @@
 */
 
 #include "DateTime.h"
+#include "Format.h"
 
 
 namespace {
@@ -29,11 +30,13 @@ namespace {
 	const time_t SECS_PER_MIN 	= 60;
 	const time_t SECS_PER_HOUR 	= 3600;
 	const time_t SECS_PER_DAY 	= 86400;
+
+	const char DAY_NAMES[] PROGMEM = "SunMonTueWedThuFriSat";
 	
 	
 	bool isLeapYear(int year) 
 	{
-		return !(year % 400) || year % 100 && !(year % 4);	
+		return !(year % 400) || (year % 100 && !(year % 4));	
 	}
 }
 
@@ -60,7 +63,7 @@ DateTime::DateTime(time_t unix)
 	
 	for (year = UNIX_EPOCH; ; year++) {
 		leap = isLeapYear(year);
-		if (d < 365 + leap)
+		if (d < 365u + leap)
 			break;
 		d -= 365 + leap;
 	}
@@ -187,65 +190,34 @@ bool DateTime::operator<(const DateTime& dt) const
 	return getUnix() < dt.getUnix();
 }
 
+// e.g. "Sun 02.03.2014 04:05:06", written at once
 size_t DateTime::printTo(Print& p) const
 {
-	size_t n = 0;
-
-	n += printDayOfWeek(p);
-
-	n += printFormat(p, day, ".");
-	n += printFormat(p, month, ".");
-	n += printFormat(p, year, " ");
-
-	n += printFormat(p, hour, ":");
-	n += printFormat(p, minute, ":");
-	n += printFormat(p, second, NULL);
-
-	return n;
-}
-
-size_t DateTime::printDayOfWeek(Print& p) const
-{
-	size_t n = 0;
-
-	switch (dow) {
-	case 1:
-		n += p.print("Sun");
-		break;
-	case 2:
-		n += p.print("Mon");
-		break;
-	case 3:
-		n += p.print("Tue");
-		break;
-	case 4:
-		n += p.print("Wed");
-		break;
-	case 5:
-		n += p.print("Thu");
-		break;
-	case 6:
-		n += p.print("Fri");
-		break;
-	case 7:
-		n += p.print("Sat");
-		break;
-	}
-	n += p.print(" ");
+	char buf[32];
+	char* q = buf;
 
-	return n;
-}
+	if (dow >= 1 && dow <= 7) {
+		const char* name = DAY_NAMES + 3*(dow-1);
+		*q++ = pgm_read_byte(name);
+		*q++ = pgm_read_byte(name + 1);
+		*q++ = pgm_read_byte(name + 2);
+	}
+	*q++ = ' ';
 
-size_t DateTime::printFormat(Print& p, int time, const char* del) const
-{
-	size_t n = 0;
+	q = Format::twoDigits(q, day);
+	*q++ = '.';
+	q = Format::twoDigits(q, month);
+	*q++ = '.';
+	if (year < 10)
+		*q++ = '0';
+	q = Format::decimal(q, year);
+	*q++ = ' ';
 
-	if (time < 10)
-		n += p.print(0);
-	n += p.print(time);
-	if (del)
-		n += p.print(del);
+	q = Format::twoDigits(q, hour);
+	*q++ = ':';
+	q = Format::twoDigits(q, minute);
+	*q++ = ':';
+	q = Format::twoDigits(q, second);
 
-	return n;
+	return p.write((const uint8_t*)buf, q - buf);
 }
-
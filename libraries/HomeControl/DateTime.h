@@ -23,7 +23,11 @@
 #include <Printable.h>
 
 
+#ifdef __AVR__
 typedef unsigned long time_t;
+#else
+#include <sys/types.h>
+#endif
 
 struct Week {
 	byte sun : 1;
@@ -51,8 +55,6 @@ class DateTime : public Printable {
 	int year;		// e.g. 2014
 
 	time_t toUnix(const DateTime&) const;
-	size_t printFormat(Print&, int, const char*) const;
-	size_t printDayOfWeek(Print&) const;
 public:
 	DateTime();
 	DateTime(time_t);
@@ -0,0 +1,59 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DedupFilter.h"
+
+
+DedupFilter::DedupFilter(unsigned long _window):
+	window(_window), evictions(0)
+{
+	clear();
+}
+
+void DedupFilter::clear()
+{
+	for (byte i = 0; i < SLOTS; i++)
+		table[i].code = NONE;
+}
+
+// Fibonacci hashing, the top bits of the product mix all code bits
+inline byte DedupFilter::hash(unsigned long code)
+{
+	return (code * 2654435769UL) >> 28;
+}
+
+bool DedupFilter::isRepeat(unsigned long code, unsigned long now)
+{
+	Entry& e = table[hash(code) & (SLOTS-1)];
+
+	if (e.code == code && now - e.seen < window) {
+		e.seen = now;
+		return true;
+	}
+	if (e.code != NONE && e.code != code && now - e.seen < window)
+		evictions++;
+
+	e.code = code;
+	e.seen = now;
+	return false;
+}
+
+unsigned long DedupFilter::getEvictions() const
+{
+	return evictions;
+}
@@ -0,0 +1,57 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEDUP_FILTER_H
+#define DEDUP_FILTER_H
+
+#include "Arduino.h"
+
+
+// Remembers when recent codes were last received in a direct mapped
+// table, so a repeat of any of them is found with one hash and one
+// compare. A remote that alternates codes or two remotes pressed
+// together no longer get past it. Codes that share a slot just evict
+// each other, the worst case is a repeat that is not suppressed.
+class DedupFilter {
+public:
+	static const byte SLOTS = 16;	// power of two
+	static const unsigned long NONE = 0xFFFFFFFF;
+private:
+	struct Entry {
+		unsigned long code;
+		unsigned long seen;		// millis()
+	};
+
+	Entry table[SLOTS];
+	unsigned long window;
+	unsigned long evictions;
+
+	static byte hash(unsigned long);
+public:
+	DedupFilter(unsigned long window);
+
+	// true if code was seen less than window ms ago, a repeat extends
+	// the window so a held button stays one event
+	bool isRepeat(unsigned long code, unsigned long now);
+	void clear();
+
+	// live entries replaced by another code
+	unsigned long getEvictions() const;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DhcpClient.h"
+
+
+namespace {
+
+	const int CLIENT_PORT = 68;
+	const int SERVER_PORT = 67;
+	const byte HEADER_SIZE = 44;	// up to chaddr
+	const byte SKIP_SIZE = 192;		// sname and file
+	const byte COOKIE[] = { 99, 130, 83, 99 };
+
+	// message types
+	const byte DISCOVER = 1;
+	const byte OFFER = 2;
+	const byte REQUEST = 3;
+	const byte ACK = 5;
+	const byte NAK = 6;
+
+	// options
+	const byte OPT_PAD = 0;
+	const byte OPT_MASK = 1;
+	const byte OPT_ROUTER = 3;
+	const byte OPT_DNS = 6;
+	const byte OPT_REQUESTED_IP = 50;
+	const byte OPT_LEASE = 51;
+	const byte OPT_TYPE = 53;
+	const byte OPT_SERVER = 54;
+	const byte OPT_PARAMS = 55;
+	const byte OPT_CLIENT_ID = 61;
+	const byte OPT_END = 255;
+
+	byte buffer[HEADER_SIZE + 4];
+
+	void putLong(byte* p, uint32_t v)
+	{
+		p[0] = v >> 24;
+		p[1] = v >> 16;
+		p[2] = v >> 8;
+		p[3] = v;
+	}
+
+	uint32_t getLong(const byte* p)
+	{
+		return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | 
+			(uint32_t)p[2] << 8 | p[3];
+	}
+}
+
+DhcpClient::DhcpClient():
+	mac(NULL), state(STOPPED), xid(0), ip(0), mask(0), gateway(0), dns(0),
+	server(0), lease(0), since(0), sent(0), timeout(MIN_TIMEOUT), discovers(0)
+{}
+
+void DhcpClient::begin(const byte* _mac, unsigned long now)
+{
+	mac = _mac;
+	xid = now ^ getLong(mac + 2);
+	drop();
+	udp.begin(CLIENT_PORT);
+	start(SELECTING, now);
+	send(DISCOVER, now);
+}
+
+// a request answers the offer with its xid, anything else is a new
+// exchange
+void DhcpClient::start(byte s, unsigned long now)
+{
+	if (s == RENEWING)
+		udp.begin(CLIENT_PORT);
+	if (s != REQUESTING)
+		xid++;
+	state = s;
+	timeout = MIN_TIMEOUT;
+	sent = now;
+}
+
+void DhcpClient::drop()
+{
+	ip = mask = gateway = dns = server = 0;
+	lease = 0;
+}
+
+byte DhcpClient::poll(unsigned long now)
+{
+	if (state == STOPPED)
+		return NONE;
+
+	if (state == BOUND) {
+		if (now - since < lease / 2)
+			return NONE;
+		start(RENEWING, now);
+		send(REQUEST, now);
+		return NONE;
+	}
+
+	Lease offer;
+	byte type = receive(offer);
+
+	if (state == SELECTING && type == OFFER) {
+		ip = offer.ip;
+		server = offer.server;
+		start(REQUESTING, now);
+		send(REQUEST, now);
+		return NONE;
+	}
+	if (state != SELECTING && type == ACK) {
+		bool changed = state == REQUESTING || offer.ip != ip;
+		ip = offer.ip;
+		mask = offer.mask;
+		gateway = offer.gateway;
+		dns = offer.dns;
+		server = offer.server;
+		if (!offer.seconds || offer.seconds > MAX_LEASE)
+			offer.seconds = MAX_LEASE;
+		lease = offer.seconds * 1000;
+		since = now;
+		state = BOUND;
+		udp.stop();
+		return changed ? LEASED : NONE;
+	}
+	if ((state != SELECTING && type == NAK) || 
+			(state == RENEWING && now - since >= lease)) {
+		bool lost = state == RENEWING;
+		drop();
+		start(SELECTING, now);
+		send(DISCOVER, now);
+		return lost ? LOST : NONE;
+	}
+
+	if (now - sent < timeout)
+		return NONE;
+
+	// an offer not confirmed in time is given up
+	unsigned long next = timeout * 2 < MAX_TIMEOUT ? timeout * 2 : MAX_TIMEOUT;
+	if (state == REQUESTING)
+		start(SELECTING, now);
+	timeout = next;
+	send(state == SELECTING ? DISCOVER : REQUEST, now);
+	return NONE;
+}
+
+void DhcpClient::send(byte type, unsigned long now)
+{
+	memset(buffer, 0, sizeof(buffer));
+	buffer[0] = 1;			// request
+	buffer[1] = 1;			// ethernet
+	buffer[2] = 6;			// mac length
+	putLong(buffer + 4, xid);
+	if (state == RENEWING)
+		memcpy(buffer + 12, &ip, 4);
+	else
+		buffer[10] = 0x80;	// answer by broadcast, we have no address
+	memcpy(buffer + 28, mac, 6);
+
+	udp.beginPacket(IPAddress(255, 255, 255, 255), SERVER_PORT);
+	udp.write(buffer, HEADER_SIZE);
+	memset(buffer, 0, sizeof(buffer));
+	for (byte n = 0; n < SKIP_SIZE; n += sizeof(buffer))
+		udp.write(buffer, sizeof(buffer));
+
+	byte n = 0;
+	memcpy(buffer, COOKIE, 4);
+	n += 4;
+	buffer[n++] = OPT_TYPE;
+	buffer[n++] = 1;
+	buffer[n++] = type;
+	buffer[n++] = OPT_CLIENT_ID;
+	buffer[n++] = 7;
+	buffer[n++] = 1;
+	memcpy(buffer + n, mac, 6);
+	n += 6;
+	buffer[n++] = OPT_PARAMS;
+	buffer[n++] = 3;
+	buffer[n++] = OPT_MASK;
+	buffer[n++] = OPT_ROUTER;
+	buffer[n++] = OPT_DNS;
+	if (state == REQUESTING) {
+		buffer[n++] = OPT_REQUESTED_IP;
+		buffer[n++] = 4;
+		memcpy(buffer + n, &ip, 4);
+		n += 4;
+		buffer[n++] = OPT_SERVER;
+		buffer[n++] = 4;
+		memcpy(buffer + n, &server, 4);
+		n += 4;
+	}
+	buffer[n++] = OPT_END;
+	udp.write(buffer, n);
+	udp.endPacket();
+
+	sent = now;
+	if (type == DISCOVER)
+		discovers++;
+}
+
+// message type of an answer to us, 0 if there is none
+byte DhcpClient::receive(Lease& l)
+{
+	if (udp.parsePacket() <= 0)
+		return 0;
+
+	byte xidBytes[4];
+	putLong(xidBytes, xid);
+
+	if (udp.read(buffer, HEADER_SIZE) != HEADER_SIZE || buffer[0] != 2 ||
+			memcmp(buffer + 4, xidBytes, 4) != 0 || memcmp(buffer + 28, mac, 6) != 0) {
+		udp.flush();
+		return 0;
+	}
+
+	memset(&l, 0, sizeof(l));
+	memcpy(&l.ip, buffer + 16, 4);
+
+	for (byte n = 0; n < SKIP_SIZE; n += sizeof(buffer))
+		udp.read(buffer, sizeof(buffer));
+	if (udp.read(buffer, 4) != 4 || memcmp(buffer, COOKIE, 4) != 0) {
+		udp.flush();
+		return 0;
+	}
+
+	byte type = 0;
+
+	for (;;) {
+		int code = udp.read();
+		if (code < 0 || code == OPT_END)
+			break;
+		if (code == OPT_PAD)
+			continue;
+		int len = udp.read();
+		if (len < 0)
+			break;
+		// the first address of a list is enough
+		byte v[4] = { 0 };
+		for (int i = 0; i < len; i++) {
+			int c = udp.read();
+			if (i < 4)
+				v[i] = c;
+		}
+		switch (code) {
+			case OPT_TYPE: type = v[0]; break;
+			case OPT_MASK: memcpy(&l.mask, v, 4); break;
+			case OPT_ROUTER: memcpy(&l.gateway, v, 4); break;
+			case OPT_DNS: memcpy(&l.dns, v, 4); break;
+			case OPT_SERVER: memcpy(&l.server, v, 4); break;
+			case OPT_LEASE: l.seconds = getLong(v); break;
+		}
+	}
+	udp.flush();
+	return type;
+}
+
+byte DhcpClient::getState() const
+{
+	return state;
+}
+
+bool DhcpClient::isBound() const
+{
+	return state == BOUND || state == RENEWING;
+}
+
+uint16_t DhcpClient::getDiscovers() const
+{
+	return discovers;
+}
+
+IPAddress DhcpClient::getIP() const
+{
+	return IPAddress(ip);
+}
+
+IPAddress DhcpClient::getMask() const
+{
+	return IPAddress(mask);
+}
+
+IPAddress DhcpClient::getGateway() const
+{
+	return IPAddress(gateway);
+}
+
+IPAddress DhcpClient::getDNS() const
+{
+	return IPAddress(dns);
+}
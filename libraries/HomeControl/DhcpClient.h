@@ -0,0 +1,89 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DHCP_CLIENT_H
+#define DHCP_CLIENT_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <EthernetUdp.h>
+
+
+// DHCP that never blocks. poll() handles an answer or a timeout when
+// one is there and returns at once otherwise, so the loop keeps serving
+// the radio while the server is slow or away. Discover and request are
+// sent again with doubling timeouts, the lease is renewed at half its
+// time and dropped when it ends. Addresses are kept as IPAddress holds
+// them.
+class DhcpClient {
+public:
+	enum State { STOPPED, SELECTING, REQUESTING, BOUND, RENEWING };
+	// what poll() did to the address
+	enum Event { NONE, LEASED, LOST };
+
+	static const unsigned long MIN_TIMEOUT = 4000;
+	static const unsigned long MAX_TIMEOUT = 64000;
+	// longer leases are renewed as if they were this long, seconds
+	static const unsigned long MAX_LEASE = 86400;
+private:
+	const byte* mac;
+	byte state;
+	uint32_t xid;
+	uint32_t ip;
+	uint32_t mask;
+	uint32_t gateway;
+	uint32_t dns;
+	uint32_t server;			// of the offer taken
+	unsigned long lease;		// ms
+	unsigned long since;		// millis() the lease was granted
+	unsigned long sent;			// millis() of the last packet
+	unsigned long timeout;
+	uint16_t discovers;
+	EthernetUDP udp;			// open while talking to the server
+
+	// what an offer or ack carries
+	struct Lease {
+		uint32_t ip;
+		uint32_t mask;
+		uint32_t gateway;
+		uint32_t dns;
+		uint32_t server;
+		unsigned long seconds;
+	};
+
+	void start(byte state, unsigned long now);
+	void send(byte type, unsigned long now);
+	byte receive(Lease&);
+	void drop();
+public:
+	DhcpClient();
+
+	// mac must stay valid
+	void begin(const byte* mac, unsigned long now);
+	byte poll(unsigned long now);
+
+	byte getState() const;
+	bool isBound() const;
+	uint16_t getDiscovers() const;
+
+	IPAddress getIP() const;
+	IPAddress getMask() const;
+	IPAddress getGateway() const;
+	IPAddress getDNS() const;
+};
+
+#endif
@@ -17,6 +17,11 @@
 */
 
 #include "Event.h"
+#include "NamePool.h"
+#include "Util.h"
+
+
+STATIC_ASSERT(sizeof(EventRule) == 10, event_rule_size);
 
 
 Event::Event():
@@ -49,19 +54,25 @@ time_t Event::getTime() const
 
 
 EventRule::EventRule():
-	eventId(255), switchId(255), on(0), active(0), inv(0)
+	on(0), active(0), inv(0), feedback(0), nameId(NamePool::NONE)
 {
-	memcpy(name, 0, sizeof(name));
+	setEventId(255);
+	setSwitchId(Switch::NONE);
+	setDuration(0);
 }
 
 void EventRule::setEventId(unsigned long id)
 {
-	eventId = id;
+	eventId[0] = id;
+	eventId[1] = id >> 8;
+	eventId[2] = id >> 16;
+	eventId[3] = id >> 24;
 }
 
-void EventRule::setSwitchId(byte id)
+void EventRule::setSwitchId(switch_id_t id)
 {
-	switchId = id;
+	switchId[0] = id;
+	switchId[1] = id >> 8;
 }
 
 bool EventRule::turnOn() const
@@ -81,12 +92,15 @@ void EventRule::setToggle(bool toggle)
 
 unsigned long EventRule::getEventId() const
 {
-	return eventId;
+	return eventId[0] | 
+		(unsigned long)eventId[1] << 8 | 
+		(unsigned long)eventId[2] << 16 |
+		(unsigned long)eventId[3] << 24;
 }
 
-byte EventRule::getSwitchId() const
+switch_id_t EventRule::getSwitchId() const
 {
-	return switchId;
+	return uint16_t(switchId[0]) | uint16_t(switchId[1]) << 8;
 }
 
 bool EventRule::toggle() const
@@ -94,6 +108,29 @@ bool EventRule::toggle() const
 	return inv;
 }
 
+bool EventRule::isFeedback() const
+{
+	return feedback;
+}
+
+void EventRule::setFeedback(bool fb)
+{
+	feedback = fb;
+}
+
+void EventRule::setDuration(time_t d)
+{
+	if (d > 0xFFFF)
+		d = 0xFFFF;
+	duration[0] = d;
+	duration[1] = d >> 8;
+}
+
+time_t EventRule::getDuration() const
+{
+	return duration[0] | (time_t)duration[1] << 8;
+}
+
 bool EventRule::isActive() const
 {
 	return active;
@@ -104,13 +141,12 @@ void EventRule::setActive(bool act)
 	active = act;
 }
 
-void EventRule::setName(const char* _name)
+void EventRule::setNameId(byte id)
 {
-	strncpy(name, _name, sizeof(name));
-	name[RULE_NAME_SIZE] = '\0';
+	nameId = id;
 }
 
-const char* EventRule::getName() const
+byte EventRule::getNameId() const
 {
-	return name;
+	return nameId;
 }
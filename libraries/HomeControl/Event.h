@@ -21,10 +21,9 @@
 
 
 #include "Arduino.h"
+#include "Switch.h"
 #include "Time.h"
 
-const int RULE_NAME_SIZE = 10;
-
 
 class Event {
 	unsigned long id;
@@ -41,31 +40,42 @@ public:
 };
 
 class EventRule {
-	unsigned long eventId;
-	byte switchId;
-	bool on		: 1;
-	bool active : 1;
-	bool inv	: 1;
-
-	char name[RULE_NAME_SIZE+1];
+	byte eventId[4];	// RfCode::getId(), lsb first
+	byte switchId[2];	// switch or scene target, lsb first
+	byte on		: 1;
+	byte active : 1;
+	byte inv	: 1;
+	byte feedback : 1;
+
+	byte nameId;		// slot in NamePool
+	byte duration[2];	// seconds until the action is undone, lsb first
 public:
 	EventRule();
 
 	void setEventId(unsigned long);
-	void setSwitchId(byte);
+	void setSwitchId(switch_id_t);
 	void setOn(bool);
 	void setToggle(bool);
 
 	unsigned long getEventId() const;
-	byte getSwitchId() const;
+	switch_id_t getSwitchId() const;
 	bool turnOn() const;
 	bool toggle() const;
 
+	// the code is the switch telling its state after a command, rather 
+	// than a command
+	bool isFeedback() const;
+	void setFeedback(bool);
+
+	// 0 keeps the switch as it is
+	void setDuration(time_t);
+	time_t getDuration() const;
+
 	bool isActive() const;
 	void setActive(bool);
 
-	void setName(const char*);
-	const char* getName() const;
+	void setNameId(byte);
+	byte getNameId() const;
 };
 
 #endif
@@ -0,0 +1,351 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EventStore.h"
+
+
+namespace {
+	// 7 bits a byte, lsb first, the high bit marks more to come
+	byte putVarint(byte* p, uint32_t v)
+	{
+		byte n = 0;
+		while (v >= 0x80) {
+			p[n++] = v | 0x80;
+			v >>= 7;
+		}
+		p[n++] = v;
+		return n;
+	}
+
+	// bytes read, 0 if the varint runs past size
+	byte getVarint(const byte* p, byte size, uint32_t& v)
+	{
+		v = 0;
+		for (byte n = 0, shift = 0; n < size && shift < 32; shift += 7) {
+			byte b = p[n++];
+			v |= uint32_t(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				return n;
+		}
+		return 0;
+	}
+}
+
+
+EventStore::EventStore(void* ee):
+	eeprom(static_cast<byte*>(ee))
+{
+	reset();
+}
+
+void EventStore::reset()
+{
+	memset(&meta, 0, sizeof(meta));
+	meta.count = 1;
+	memset(&current, 0, sizeof(current));
+	memset(index, 0, sizeof(index));
+	lastPos = 0;
+	lastTime = prevTime = 0;
+	lastId = ANY;
+}
+
+byte* EventStore::getAddress(byte slot) const
+{
+	return eeprom + sizeof(Meta) + slot * sizeof(Block);
+}
+
+// slot of the step-th block, counted from the oldest
+byte EventStore::getSlot(byte step) const
+{
+	return (meta.head + BLOCKS + 1 - meta.count + step) % BLOCKS;
+}
+
+void EventStore::readBlock(byte slot, Block& b) const
+{
+	if (slot == meta.head)
+		b = current;
+	else
+		DefaultStorage::read(&b, getAddress(slot), sizeof(Block));
+}
+
+void EventStore::load()
+{
+	DefaultStorage::read(&meta, eeprom, sizeof(meta));
+
+	if (meta.head >= BLOCKS || meta.count == 0 || 
+			meta.count > BLOCKS || meta.codes > CODES) {
+		clear();
+		return;
+	}
+
+	for (byte s = 0; s < meta.count; s++) {
+		byte i = getSlot(s);
+		Header h;
+		DefaultStorage::read(&h, getAddress(i), sizeof(h));
+		index[i].base = h.base;
+		index[i].mask = h.mask;
+		index[i].events = h.events;
+	}
+	DefaultStorage::read(&current, getAddress(meta.head), sizeof(current));
+	scan();
+}
+
+void EventStore::clear()
+{
+	reset();
+	DefaultStorage::write(&meta, eeprom, sizeof(meta));
+	flush();
+}
+
+void EventStore::flush()
+{
+	DefaultStorage::write(&current, getAddress(meta.head), sizeof(current));
+}
+
+// where add() and touch() continue after a restart
+void EventStore::scan()
+{
+	byte pos = 0;
+	uint32_t t = current.h.base;
+	prevTime = lastTime = t;
+	lastPos = 0;
+	lastId = ANY;
+
+	if (current.h.used > sizeof(current.data))
+		current.h.used = 0;
+
+	for (byte e = 0; e < current.h.events; e++) {
+		uint32_t delta;
+		unsigned long id;
+		byte n = decode(current, pos, delta, id);
+
+		if (!n) {
+			current.h.events = e;
+			current.h.used = pos;
+			break;
+		}
+		prevTime = lastTime;
+		lastTime += delta;
+		lastPos = pos;
+		lastId = id;
+		pos += n;
+	}
+}
+
+byte EventStore::decode(const Block& b, byte pos, uint32_t& delta, unsigned long& id) const
+{
+	byte used = b.h.used <= sizeof(b.data) ? b.h.used : sizeof(b.data);
+	byte n = pos < used ? getVarint(b.data + pos, used - pos, delta) : 0;
+
+	if (!n || pos + n >= used)
+		return 0;
+
+	byte idx = b.data[pos + n++];
+
+	if (idx == ESCAPE) {
+		if (pos + n + 4 > used)
+			return 0;
+		const byte* p = b.data + pos + n;
+		id = p[0] | (unsigned long)p[1] << 8 | 
+			(unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+		return n + 4;
+	}
+	if (idx >= meta.codes)
+		return 0;
+	id = meta.code[idx];
+	return n;
+}
+
+byte EventStore::find(unsigned long id) const
+{
+	for (byte i = 0; i < meta.codes; i++) {
+		if (meta.code[i] == id)
+			return i;
+	}
+	return ESCAPE;
+}
+
+// codes stay in the dictionary until clear(), spilled blocks refer to them
+byte EventStore::intern(unsigned long id)
+{
+	byte i = find(id);
+
+	if (i == ESCAPE && meta.codes < CODES) {
+		i = meta.codes++;
+		meta.code[i] = id;
+		DefaultStorage::write(&meta, eeprom, sizeof(meta));
+	}
+	return i;
+}
+
+bool EventStore::append(unsigned long id, uint32_t t)
+{
+	byte buf[10];
+	byte idx = intern(id);
+	uint32_t delta = current.h.events && t > lastTime ? t - lastTime : 0;
+	byte n = putVarint(buf, delta);
+
+	buf[n++] = idx;
+	if (idx == ESCAPE) {
+		buf[n++] = id;
+		buf[n++] = id >> 8;
+		buf[n++] = id >> 16;
+		buf[n++] = id >> 24;
+	}
+	if (current.h.used + n > sizeof(current.data))
+		return false;
+
+	if (!current.h.events) {
+		current.h.base = t;
+		lastTime = t;
+	}
+	memcpy(current.data + current.h.used, buf, n);
+	prevTime = lastTime;
+	lastTime += delta;
+	lastPos = current.h.used;
+	lastId = id;
+	current.h.used += n;
+	current.h.events++;
+	current.h.mask |= idx == ESCAPE ? 1UL << 31 : 1UL << idx;
+
+	Index& ix = index[meta.head];
+	ix.base = current.h.base;
+	ix.mask = current.h.mask;
+	ix.events = current.h.events;
+	return true;
+}
+
+void EventStore::spill()
+{
+	flush();
+	meta.head = (meta.head + 1) % BLOCKS;
+	if (meta.count < BLOCKS)
+		meta.count++;
+	DefaultStorage::write(&meta, eeprom, 2);
+
+	memset(&current, 0, sizeof(current));
+	memset(&index[meta.head], 0, sizeof(Index));
+	lastPos = 0;
+	lastId = ANY;
+}
+
+void EventStore::add(unsigned long id, time_t t)
+{
+	if (!append(id, t)) {
+		spill();
+		append(id, t);
+	}
+}
+
+bool EventStore::touch(unsigned long id, time_t t, time_t window)
+{
+	if (window < 0 || !current.h.events || id != lastId || 
+			uint32_t(t) < lastTime || uint32_t(t) - lastTime >= uint32_t(window))
+		return false;
+
+	byte buf[5];
+	byte n = putVarint(buf, t - prevTime);
+	uint32_t delta;
+	byte old = getVarint(current.data + lastPos, current.h.used - lastPos, delta);
+	// the code bytes behind the delta move with it
+	byte rest = current.h.used - lastPos - old;
+
+	if (lastPos + n + rest > int(sizeof(current.data)))
+		return false;
+
+	memmove(current.data + lastPos + n, current.data + lastPos + old, rest);
+	memcpy(current.data + lastPos, buf, n);
+	current.h.used = lastPos + n + rest;
+	lastTime = t;
+	return true;
+}
+
+unsigned int EventStore::getEvents() const
+{
+	unsigned int n = 0;
+	for (byte s = 0; s < meta.count; s++)
+		n += index[getSlot(s)].events;
+	return n;
+}
+
+byte EventStore::getCodes() const
+{
+	return meta.codes;
+}
+
+
+EventStore::Cursor::Cursor(const EventStore& _store, time_t _since, unsigned long _code):
+	store(_store), step(0), pos(0), left(0), time(0), since(_since), 
+	code(_code), bit(0)
+{
+	if (code != ANY) {
+		byte i = store.find(code);
+		bit = i == ESCAPE ? 1UL << 31 : 1UL << i;
+	}
+}
+
+// the next block that may hold a match
+bool EventStore::Cursor::load()
+{
+	while (step < store.meta.count) {
+		byte slot = store.getSlot(step++);
+
+		if (bit && !(store.index[slot].mask & bit))
+			continue;
+		// the following block starts before since, so this one ends before
+		if (step < store.meta.count && store.index[store.getSlot(step)].base < since)
+			continue;
+
+		store.readBlock(slot, block);
+		pos = 0;
+		left = block.h.events;
+		time = block.h.base;
+		return true;
+	}
+	return false;
+}
+
+bool EventStore::Cursor::next(Event& ev)
+{
+	for (;;) {
+		if (!left) {
+			if (!load())
+				return false;
+			continue;
+		}
+
+		uint32_t delta;
+		unsigned long id;
+		byte n = store.decode(block, pos, delta, id);
+
+		if (!n) {
+			left = 0;
+			continue;
+		}
+		pos += n;
+		left--;
+		time += delta;
+
+		if (time < since || (code != ANY && id != code))
+			continue;
+
+		ev.setId(id);
+		ev.setTime(time);
+		return true;
+	}
+}
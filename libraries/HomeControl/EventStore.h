@@ -0,0 +1,127 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+#include "Arduino.h"
+#include "Event.h"
+#include "Storage.h"
+
+
+// Received codes, packed into 64 byte blocks that live in a ring in 
+// the eeprom (the mapped file on the host). An event is the varint 
+// distance in seconds to the one before it and the slot of its code 
+// in a dictionary, usually 2-3 bytes instead of the 8 of an Event. 
+// Codes that no longer fit into the dictionary are stored inline.
+// Only the block being filled is kept in RAM, flush() writes it back
+// and eeprom_update_block leaves unchanged bytes alone.
+class EventStore {
+public:
+	static const byte BLOCK_SIZE = 64;
+	static const byte BLOCKS = 12;
+	static const byte CODES = 31;
+	static const unsigned long ANY = 0xFFFFFFFF;
+private:
+	static const byte ESCAPE = 255;
+
+	struct Header {
+		uint32_t base;		// time of the first event
+		uint32_t mask;		// dictionary slots used, bit 31 inline codes
+		byte used;
+		byte events;
+	};
+
+	struct Block {
+		Header h;
+		byte data[BLOCK_SIZE - sizeof(Header)];
+	};
+
+	struct Meta {
+		byte head;			// block being filled
+		byte count;			// blocks in use, head included
+		byte codes;
+		uint32_t code[CODES];
+	};
+
+	// per block, so queries skip blocks without reading them
+	struct Index {
+		uint32_t base;
+		uint32_t mask;
+		byte events;
+	};
+
+	byte* eeprom;
+	Meta meta;
+	Block current;
+	Index index[BLOCKS];
+
+	byte lastPos;
+	uint32_t lastTime;
+	uint32_t prevTime;
+	unsigned long lastId;
+
+	byte* getAddress(byte) const;
+	byte getSlot(byte) const;
+	void readBlock(byte, Block&) const;
+	byte decode(const Block&, byte, uint32_t&, unsigned long&) const;
+	byte find(unsigned long) const;
+	byte intern(unsigned long);
+	bool append(unsigned long, uint32_t);
+	void reset();
+	void spill();
+	void scan();
+public:
+	enum { STORAGE_SIZE = sizeof(Meta) + BLOCKS * sizeof(Block) };
+
+	EventStore(void*);
+
+	void load();
+	void clear();
+	void flush();
+
+	void add(unsigned long, time_t);
+	// moves the last event to the given time if it has the same code 
+	// and is less than window seconds old, never for a negative window
+	bool touch(unsigned long, time_t, time_t window);
+
+	unsigned int getEvents() const;
+	byte getCodes() const;
+
+	// walks the events from the oldest on, blocks before since and 
+	// blocks without the code are skipped by the index alone
+	class Cursor {
+		const EventStore& store;
+		Block block;
+		byte step;
+		byte pos;
+		byte left;
+		uint32_t time;
+		uint32_t since;
+		unsigned long code;
+		uint32_t bit;
+
+		bool load();
+	public:
+		Cursor(const EventStore&, time_t since = 0, unsigned long code = ANY);
+		bool next(Event&);
+	};
+	friend class Cursor;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Feedback.h"
+#include "Util.h"
+
+
+namespace {
+	const int LEVEL_SCALE = 10;
+}
+
+STATIC_ASSERT(sizeof(Feedback) <= 4, feedback_size);
+
+
+Feedback::Feedback():
+	level(0), sensorId(255)
+{}
+
+void Feedback::setSensorId(byte id)
+{
+	sensorId = id;
+}
+
+byte Feedback::getSensorId() const
+{
+	return sensorId;
+}
+
+float Feedback::getLevel() const
+{
+	return float(level) / LEVEL_SCALE;
+}
+
+void Feedback::setLevel(float l)
+{
+	l *= LEVEL_SCALE;
+	l += l < 0 ? -0.5 : 0.5;
+
+	if (l > 32767)
+		level = 32767;
+	else if (l < -32767)
+		level = -32767;
+	else
+		level = l;
+}
+
+bool Feedback::isOn(float value) const
+{
+	return value * LEVEL_SCALE >= level;
+}
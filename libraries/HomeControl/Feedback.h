@@ -0,0 +1,44 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+#include "Arduino.h"
+
+
+// A sensor paired with a switch, which is on while the sensor reads at
+// least the level, e.g. a light sensor next to a lamp. Switches may also
+// echo their state over the air, see EventRule::isFeedback().
+class Feedback {
+	int16_t level;		// fixed point, 1/10 units
+	byte sensorId;
+public:
+	Feedback();
+
+	// 255 for none
+	void setSensorId(byte);
+	byte getSensorId() const;
+
+	float getLevel() const;
+	void setLevel(float);
+
+	bool isOn(float value) const;
+};
+
+#endif
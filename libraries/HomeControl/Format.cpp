@@ -0,0 +1,143 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Format.h"
+#include <Print.h>
+#include <math.h>
+
+
+namespace {
+	// "00" to "99", halves the divisions for longer numbers
+	const char DIGITS[] PROGMEM = 
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	const unsigned long SCALE[] = { 1, 10, 100, 1000, 10000 };
+
+	const char BASE64[] PROGMEM = 
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	char* put(char* p, const char* s)
+	{
+		while (*s)
+			*p++ = *s++;
+		return p;
+	}
+}
+
+char* Format::twoDigits(char* p, byte v)
+{
+	const char* d = DIGITS + 2*v;
+	*p++ = pgm_read_byte(d);
+	*p++ = pgm_read_byte(d + 1);
+	return p;
+}
+
+char* Format::decimal(char* p, unsigned long v)
+{
+	char tmp[10];
+	char* t = tmp + sizeof(tmp);
+
+	while (v >= 100) {
+		byte r = v % 100;
+		v /= 100;
+		t -= 2;
+		twoDigits(t, r);
+	}
+	if (v >= 10) {
+		t -= 2;
+		twoDigits(t, v);
+	} else {
+		*--t = '0' + v;
+	}
+	while (t < tmp + sizeof(tmp))
+		*p++ = *t++;
+	return p;
+}
+
+char* Format::fixed(char* p, float v, byte decimals)
+{
+	if (isnan(v))
+		return put(p, "nan");
+	if (isinf(v))
+		return put(p, "inf");
+	if (v > 4294967040.0 || v < -4294967040.0)
+		return put(p, "ovf");
+
+	if (decimals > MAX_DECIMALS)
+		decimals = MAX_DECIMALS;
+	if (v < 0) {
+		*p++ = '-';
+		v = -v;
+	}
+	// the fraction is rounded on its own and carries into the integer
+	// part, so large values need no 64 bit scaling
+	unsigned long scale = SCALE[decimals];
+	unsigned long i = (unsigned long)v;
+	unsigned long f = (unsigned long)((v - i) * scale + 0.5f);
+	if (f >= scale) {
+		f -= scale;
+		i++;
+	}
+	p = decimal(p, i);
+	if (!decimals)
+		return p;
+
+	*p++ = '.';
+	char* end = p + decimals;
+	for (char* q = end; q > p; f /= 10)
+		*--q = '0' + f % 10;
+	return end;
+}
+
+char* Format::base64(char* p, const void* data, size_t n)
+{
+	const byte* s = (const byte*)data;
+
+	for (; n; n -= n < 3 ? n : 3, s += 3) {
+		unsigned long v = (unsigned long)s[0] << 16;
+		if (n > 1)
+			v |= (unsigned int)s[1] << 8;
+		if (n > 2)
+			v |= s[2];
+		*p++ = pgm_read_byte(BASE64 + (v >> 18));
+		*p++ = pgm_read_byte(BASE64 + (v >> 12 & 63));
+		*p++ = n > 1 ? pgm_read_byte(BASE64 + (v >> 6 & 63)) : '=';
+		*p++ = n > 2 ? pgm_read_byte(BASE64 + (v & 63)) : '=';
+	}
+	return p;
+}
+
+
+Fixed::Fixed(float _value, byte _decimals):
+	value(_value), decimals(_decimals)
+{}
+
+size_t Fixed::printTo(Print& out) const
+{
+	char buf[Format::FIXED_SIZE];
+	char* end = Format::fixed(buf, value, decimals);
+	return out.write((const uint8_t*)buf, end - buf);
+}
@@ -0,0 +1,52 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include "Arduino.h"
+#include <Printable.h>
+
+
+// Number formatting into a caller's buffer, so a value goes out with a
+// single write. Writers return the end of the text, nothing is 
+// terminated.
+class Format {
+public:
+	static char* twoDigits(char*, byte);	// 0-99, leading zero
+	static char* decimal(char*, unsigned long);
+	// like Print::print(double, decimals), up to MAX_DECIMALS
+	static char* fixed(char*, float, byte decimals);
+	// padded, (n+2)/3*4 characters
+	static char* base64(char*, const void*, size_t n);
+
+	static const byte MAX_DECIMALS = 4;
+	// "-4294967295.9999"
+	static const byte FIXED_SIZE = 16;
+};
+
+// e.g. client << Fixed(sensor->read(), 1)
+class Fixed : public Printable {
+	float value;
+	byte decimals;
+public:
+	Fixed(float, byte decimals = 2);
+
+	virtual size_t printTo(Print&) const;
+};
+
+#endif
@@ -0,0 +1,285 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __AVR__
+
+#include "GatewayServer.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+
+namespace {
+	const int MAX_EVENTS = 64;
+	const int BACKLOG = 128;
+	// epoll data of the listening socket, clients have their slot
+	const uint32_t LISTENER = GatewayServer::MAX_PARKED;
+	// ms between checks for idle connections
+	const int SWEEP_PERIOD = 1000;
+
+	// wall time, the board clock may be simulated
+	unsigned long uptime()
+	{
+		struct timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return t.tv_sec * 1000UL + t.tv_nsec / 1000000;
+	}
+
+	const char BUSY[] = "HTTP/1.0 503 Service Unavailable\r\n"
+		"Retry-After: 1\r\n"
+		"Connection: close\r\n"
+		"\r\n";
+
+	// a full queue is answered, not just closed
+	void refuse(SocketClient* client)
+	{
+		client->write((const uint8_t*)BUSY, sizeof(BUSY)-1);
+		delete client;
+	}
+}
+
+void GatewayServer::Queue::init()
+{
+	head = count = 0;
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&ready, NULL);
+}
+
+bool GatewayServer::Queue::put(void* item)
+{
+	pthread_mutex_lock(&lock);
+	bool ok = count < QUEUE_SIZE;
+
+	if (ok) {
+		items[(head + count++) % QUEUE_SIZE] = item;
+		pthread_cond_signal(&ready);
+	}
+	pthread_mutex_unlock(&lock);
+	return ok;
+}
+
+void* GatewayServer::Queue::get(bool wait)
+{
+	pthread_mutex_lock(&lock);
+	while (wait && !count)
+		pthread_cond_wait(&ready, &lock);
+
+	void* item = NULL;
+
+	if (count) {
+		item = items[head];
+		head = (head + 1) % QUEUE_SIZE;
+		count--;
+	}
+	pthread_mutex_unlock(&lock);
+	return item;
+}
+
+GatewayServer::GatewayServer(uint16_t _port, Handler _handler, byte _workers):
+	port(_port), handler(_handler), workers(_workers), listenFd(-1), epollFd(-1),
+	freeCount(MAX_PARKED)
+{
+	for (int i = 0; i < MAX_PARKED; i++) {
+		parked[i].client = NULL;
+		freeSlots[i] = MAX_PARKED - 1 - i;
+	}
+	if (!workers)
+		workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (workers > MAX_WORKERS)
+		workers = MAX_WORKERS;
+}
+
+bool GatewayServer::begin()
+{
+	// e.g. to run without privileges
+	const char* env = getenv("HOMECONTROL_PORT");
+
+	if (env)
+		port = atoi(env);
+
+	requests.init();
+	deferred.init();
+
+	listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	epollFd = epoll_create1(0);
+
+	if (listenFd < 0 || epollFd < 0)
+		return false;
+
+	int on = 1;
+	setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+			listen(listenFd, BACKLOG) < 0) {
+		perror("GatewayServer");
+		return false;
+	}
+	socklen_t len = sizeof(addr);
+	if (getsockname(listenFd, (struct sockaddr*)&addr, &len) == 0)
+		port = ntohs(addr.sin_port);
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = LISTENER;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+
+	pthread_create(&threads[0], NULL, pollThread, this);
+	for (byte i = 1; i <= workers; i++)
+		pthread_create(&threads[i], NULL, workThread, this);
+
+	return true;
+}
+
+uint16_t GatewayServer::getPort() const
+{
+	return port;
+}
+
+SocketClient* GatewayServer::available()
+{
+	return static_cast<SocketClient*>(deferred.get(false));
+}
+
+void GatewayServer::park(int fd, unsigned long now)
+{
+	if (!freeCount) {
+		close(fd);
+		return;
+	}
+	int slot = freeSlots[--freeCount];
+
+	// a peer that stops reading the answer holds a worker this long at most
+	struct timeval tv = { IDLE_TIMEOUT / 1000, 0 };
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	parked[slot].client = new SocketClient(fd);
+	parked[slot].active = now;
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = slot;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+SocketClient* GatewayServer::unpark(int slot)
+{
+	SocketClient* client = parked[slot].client;
+
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, client->getFd(), NULL);
+	parked[slot].client = NULL;
+	freeSlots[freeCount++] = slot;
+	return client;
+}
+
+// takes what arrived, a complete request goes to the workers
+void GatewayServer::receive(int slot, unsigned long now)
+{
+	SocketClient* client = parked[slot].client;
+
+	parked[slot].active = now;
+	if (!client->receive())
+		return;
+
+	unpark(slot);
+	if (!client->available())
+		delete client;
+	else if (!requests.put(client))
+		refuse(client);
+}
+
+void GatewayServer::sweep(unsigned long now)
+{
+	for (int i = 0; i < MAX_PARKED; i++) {
+		if (parked[i].client && now - parked[i].active >= IDLE_TIMEOUT)
+			delete unpark(i);
+	}
+}
+
+// Connections stay in epoll until their request is complete and only 
+// non-blocking reads are done on them, so idle or slowly sending clients
+// never occupy a worker. Those silent for IDLE_TIMEOUT are closed.
+void GatewayServer::poll()
+{
+	struct epoll_event events[MAX_EVENTS];
+	unsigned long swept = uptime();
+
+	for (;;) {
+		int n = epoll_wait(epollFd, events, MAX_EVENTS, SWEEP_PERIOD);
+		unsigned long now = uptime();
+
+		for (int i = 0; i < n; i++) {
+			uint32_t slot = events[i].data.u64;
+
+			if (slot != LISTENER) {
+				receive(slot, now);
+				continue;
+			}
+
+			int fd;
+			while ((fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC)) >= 0)
+				park(fd, now);
+		}
+		if (now - swept >= SWEEP_PERIOD) {
+			sweep(now);
+			swept = now;
+		}
+	}
+}
+
+void GatewayServer::work()
+{
+	for (;;) {
+		SocketClient* client = static_cast<SocketClient*>(requests.get(true));
+
+		if (handler(*client)) {
+			delete client;
+			continue;
+		}
+		client->rewind();
+		if (!deferred.put(client))
+			refuse(client);
+	}
+}
+
+void* GatewayServer::pollThread(void* self)
+{
+	static_cast<GatewayServer*>(self)->poll();
+	return NULL;
+}
+
+void* GatewayServer::workThread(void* self)
+{
+	static_cast<GatewayServer*>(self)->work();
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GATEWAY_SERVER_H
+#define GATEWAY_SERVER_H
+
+#include "Arduino.h"
+#include "SocketClient.h"
+
+#include <pthread.h>
+
+
+// Web server for the Linux gateway. One thread waits on epoll for new 
+// connections and collects their requests, a pool of workers runs the 
+// handler on complete ones. Requests the handler declines (returns false)
+// are queued for the main loop and picked up with available(), like 
+// EthernetServer::available(). A request that finds either queue full
+// gets a 503 with Retry-After.
+class GatewayServer {
+public:
+	typedef bool (*Handler)(Client&);
+
+	static const byte MAX_WORKERS = 32;
+	static const int QUEUE_SIZE = 64;
+	// connections still sending their request, more are refused
+	static const int MAX_PARKED = 512;
+	// ms without data until such a connection is closed
+	static const unsigned long IDLE_TIMEOUT = 10000;
+
+	GatewayServer(uint16_t, Handler, byte = 0);
+
+	bool begin();
+	SocketClient* available();
+	// after begin(), also when the system picked it for port 0
+	uint16_t getPort() const;
+private:
+	struct Queue {
+		void* items[QUEUE_SIZE];
+		int head;
+		int count;
+		pthread_mutex_t lock;
+		pthread_cond_t ready;
+
+		void init();
+		bool put(void*);
+		void* get(bool);
+	};
+
+	struct Parked {
+		SocketClient* client;
+		unsigned long active;	// ms of the last data
+	};
+
+	uint16_t port;
+	Handler handler;
+	byte workers;
+	int listenFd;
+	int epollFd;
+	Queue requests;
+	Queue deferred;
+	pthread_t threads[MAX_WORKERS + 1];
+	// only touched by the poll thread
+	Parked parked[MAX_PARKED];
+	int freeSlots[MAX_PARKED];
+	int freeCount;
+
+	void park(int, unsigned long);
+	SocketClient* unpark(int);
+	void receive(int, unsigned long);
+	void sweep(unsigned long);
+	void poll();
+	void work();
+	static void* pollThread(void*);
+	static void* workThread(void*);
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __AVR__
+
+#include "MappedStorage.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// provided by the linker if any EEMEM variable exists
+extern char __start_eeprom[] __attribute__((weak));
+extern char __stop_eeprom[] __attribute__((weak));
+
+namespace {
+	// used if addresses are plain offsets, like E2END+1 on a mega
+	const size_t DEFAULT_SIZE = 4096;
+	const char* DEFAULT_PATH = "HomeControl.eep";
+}
+
+char* MappedStorage::base = NULL;
+size_t MappedStorage::size = 0;
+
+void MappedStorage::open()
+{
+	const char* path = getenv("HOMECONTROL_EEPROM");
+
+	if (!path)
+		path = DEFAULT_PATH;
+
+	size = __start_eeprom ? __stop_eeprom - __start_eeprom : DEFAULT_SIZE;
+
+	int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+	struct stat st;
+
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(path);
+		exit(1);
+	}
+	// a new or grown file reads as 0xFF like erased eeprom
+	if (size_t(st.st_size) < size) {
+		char erased[256];
+		memset(erased, 0xFF, sizeof(erased));
+
+		for (size_t n = st.st_size; n < size; n += sizeof(erased)) {
+			size_t len = size - n < sizeof(erased) ? size - n : sizeof(erased);
+			if (pwrite(fd, erased, len, n) != ssize_t(len)) {
+				perror(path);
+				exit(1);
+			}
+		}
+	}
+
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (p == MAP_FAILED) {
+		perror(path);
+		exit(1);
+	}
+	base = static_cast<char*>(p);
+}
+
+size_t MappedStorage::offset(const void* addr)
+{
+	if (__start_eeprom)
+		return static_cast<const char*>(addr) - __start_eeprom;
+
+	return reinterpret_cast<uintptr_t>(addr);
+}
+
+void* MappedStorage::map(const void* addr, size_t len)
+{
+	if (!base)
+		open();
+
+	size_t off = offset(addr);
+
+	if (off + len > size) {
+		fprintf(stderr, "MappedStorage: %lu bytes at %lu out of range\n", 
+			(unsigned long)len, (unsigned long)off);
+		exit(1);
+	}
+	return base + off;
+}
+
+void MappedStorage::sync(const void* ptr, size_t len)
+{
+	static const uintptr_t page = sysconf(_SC_PAGESIZE);
+
+	uintptr_t start = reinterpret_cast<uintptr_t>(ptr) & ~(page - 1);
+	uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + len;
+
+	msync(reinterpret_cast<void*>(start), end - start, MS_SYNC);
+}
+
+void MappedStorage::read(void* data, const void* addr, size_t len)
+{
+	memcpy(data, map(addr, len), len);
+}
+
+const void* MappedStorage::view(const void* addr, size_t len, size_t align)
+{
+	const void* p = map(addr, len);
+
+	if (reinterpret_cast<uintptr_t>(p) % align) {
+		fprintf(stderr, "MappedStorage: %lu bytes at %lu not aligned to %lu\n", 
+			(unsigned long)len, (unsigned long)offset(addr), (unsigned long)align);
+		exit(1);
+	}
+	return p;
+}
+
+// page by page like eeprom_update_block, saving a large table 
+// only flushes what changed
+void MappedStorage::write(const void* data, void* addr, size_t len)
+{
+	static const uintptr_t page = sysconf(_SC_PAGESIZE);
+
+	char* p = static_cast<char*>(map(addr, len));
+	const char* d = static_cast<const char*>(data);
+
+	while (len) {
+		size_t n = page - (reinterpret_cast<uintptr_t>(p) & (page - 1));
+		if (n > len)
+			n = len;
+		if (memcmp(p, d, n) != 0) {
+			memcpy(p, d, n);
+			sync(p, n);
+		}
+		p += n;
+		d += n;
+		len -= n;
+	}
+}
+
+#endif
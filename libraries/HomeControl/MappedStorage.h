@@ -0,0 +1,51 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPPED_STORAGE_H
+#define MAPPED_STORAGE_H
+
+#include <stddef.h>
+
+// Variables placed in this section are laid out in the backing file like 
+// EEMEM variables are in the eeprom.
+#ifndef EEMEM
+#define EEMEM __attribute__((section("eeprom")))
+#endif
+
+
+// Host backend for SavedArray. The whole eeprom section is mapped from a 
+// file (HOMECONTROL_EEPROM, default HomeControl.eep) on first use. Arrays
+// are copied in and out as with the eeprom, a write only touches and 
+// flushes the pages whose bytes changed. view() reads them in place.
+class MappedStorage {
+	static char* base;
+	static size_t size;
+
+	static void open();
+	static size_t offset(const void*);
+	static void* map(const void*, size_t);
+	static void sync(const void*, size_t);
+public:
+	static void read(void*, const void*, size_t);
+	static void write(const void*, void*, size_t);
+	// the saved bytes in the mapping, valid until the process ends, 
+	// addr must be aligned to align
+	static const void* view(const void* addr, size_t, size_t align);
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "NamePool.h"
+
+
+namespace {
+	// a slot referenced this often is never released again
+	const byte STICKY = 255;
+}
+
+NamePool::NamePool():
+	used(0)
+{
+	memset(offset, 0, sizeof(offset));
+	memset(refs, 0, sizeof(refs));
+	memset(data, 0, sizeof(data));
+}
+
+byte NamePool::find(const char* name) const
+{
+	for (byte i = 0; i < NAME_POOL_SLOTS; i++) {
+		if (refs[i] && strncmp(data + offset[i], name, NAME_SIZE) == 0)
+			return i;
+	}
+	return NONE;
+}
+
+byte NamePool::intern(const char* name)
+{
+	if (!name || !*name)
+		return NONE;
+
+	byte id = find(name);
+
+	if (id != NONE) {
+		if (refs[id] != STICKY)
+			refs[id]++;
+		return id;
+	}
+
+	unsigned int len = 0;
+	while (len < NAME_SIZE && name[len])
+		len++;
+
+	if (used + len + 1 > NAME_POOL_SIZE)
+		return NONE;
+
+	for (id = 0; id < NAME_POOL_SLOTS; id++) {
+		if (!refs[id])
+			break;
+	}
+	if (id == NAME_POOL_SLOTS)
+		return NONE;
+
+	offset[id] = used;
+	memcpy(data + used, name, len);
+	data[used + len] = '\0';
+	used += len + 1;
+	refs[id] = 1;
+
+	return id;
+}
+
+void NamePool::release(byte id)
+{
+	if (id >= NAME_POOL_SLOTS || !refs[id] || refs[id] == STICKY)
+		return;
+
+	if (--refs[id])
+		return;
+
+	unsigned int start = offset[id];
+	unsigned int len = strlen(data + start) + 1;
+
+	memmove(data + start, data + start + len, used - start - len);
+	used -= len;
+	memset(data + used, 0, len);
+
+	for (byte i = 0; i < NAME_POOL_SLOTS; i++) {
+		if (refs[i] && offset[i] > start)
+			offset[i] -= len;
+	}
+}
+
+// intern the new name before releasing the old one, so renaming to
+// the same name keeps its slot. false if the pool is full, the old
+// name stays then.
+bool NamePool::rename(byte& id, const char* name)
+{
+	byte n = intern(name);
+	if (n == NONE && name && *name)
+		return false;
+	release(id);
+	id = n;
+	return true;
+}
+
+const char* NamePool::get(byte id) const
+{
+	if (id >= NAME_POOL_SLOTS || !refs[id])
+		return "";
+
+	return data + offset[id];
+}
+
+unsigned int NamePool::getFree() const
+{
+	return NAME_POOL_SIZE - used;
+}
+
+byte NamePool::getSlotsFree() const
+{
+	byte n = 0;
+
+	for (byte i = 0; i < NAME_POOL_SLOTS; i++) {
+		if (!refs[i])
+			n++;
+	}
+	return n;
+}
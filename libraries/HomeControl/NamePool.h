@@ -0,0 +1,57 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NAME_POOL_H
+#define NAME_POOL_H
+
+#include "Arduino.h"
+
+const int NAME_SIZE = 10;
+const int NAME_POOL_SLOTS = 48;
+const int NAME_POOL_SIZE = 384;
+
+
+// Names of switches, schedules and rules are interned here, records only
+// keep a one byte slot id. Equal names share a slot, freed slots are
+// compacted so the pool only holds the characters actually in use.
+// The pool is far smaller than all the tables together, it is kept in
+// RAM and eeprom of the board. Naming fails once it is full, the
+// settings page shows what is left.
+class NamePool {
+	unsigned int offset[NAME_POOL_SLOTS];
+	byte refs[NAME_POOL_SLOTS];
+	unsigned int used;
+	char data[NAME_POOL_SIZE];
+
+	byte find(const char*) const;
+public:
+	NamePool();
+
+	byte intern(const char*);
+	void release(byte);
+	bool rename(byte&, const char*);
+
+	const char* get(byte) const;
+	// characters
+	unsigned int getFree() const;
+	byte getSlotsFree() const;
+
+	static const byte NONE = 255;
+};
+
+#endif
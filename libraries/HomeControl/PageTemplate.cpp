@@ -0,0 +1,99 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PageTemplate.h"
+#include "Util.h"
+
+
+namespace {
+	enum { FIELD = 1, ROWS = 2, END = 3 };
+
+	const byte CHUNK = 32;
+}
+
+// Prints text up to the next TPL_END or the end of the template and
+// returns where it stopped. With emit false it only skips, which is 
+// how a row section without visible rows is passed over.
+const char* PageTemplate::renderPart(Print& out, const char* p, 
+	const TemplateRows* rows, uint16_t row, bool emit, size_t& sent)
+{
+	uint8_t chunk[CHUNK];
+	byte n = 0;
+
+	for (;;) {
+		uint8_t c = pgm_read_byte(p++);
+
+		if (c >= ' ' || c == '\n') {
+			chunk[n++] = c;
+			if (n == CHUNK) {
+				if (emit)
+					sent += out.write(chunk, n);
+				n = 0;
+			}
+			continue;
+		}
+		if (n && emit)
+			sent += out.write(chunk, n);
+		n = 0;
+
+		switch (c) {
+		case FIELD: {
+			byte f = pgm_read_byte(p++) - '0';
+			if (emit && rows)
+				rows->printField(out, row, f);
+			break;
+		}
+		case ROWS: {
+			const char* body = p;
+			uint16_t count = rows ? rows->getCount() : 0;
+			bool any = false;
+
+			for (uint16_t i = 0; i < count; i++) {
+				if (!rows->isVisible(i))
+					continue;
+				p = renderPart(out, body, rows, i, emit, sent);
+				any = true;
+			}
+			if (!any)
+				p = renderPart(out, body, rows, 0, false, sent);
+			break;
+		}
+		case END:
+			return p;
+		case 0:
+			return p - 1;
+		}
+	}
+}
+
+void PageTemplate::render(Print& out, const char* tpl, const TemplateRows* rows)
+{
+	size_t sent = 0;
+	renderPart(out, tpl, rows, 0, true, sent);
+
+	// fields went through operator<< and are counted already
+#ifdef __AVR__
+	bytesSent() += sent;
+#else
+	__sync_fetch_and_add(&bytesSent(), sent);
+#endif
+}
+
+void PageTemplate::render(Print& out, const char* tpl, const TemplateRows& rows)
+{
+	render(out, tpl, &rows);
+}
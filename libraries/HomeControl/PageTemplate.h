@@ -0,0 +1,158 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PAGE_TEMPLATE_H
+#define PAGE_TEMPLATE_H
+
+#include "Arduino.h"
+#include <Print.h>
+#include "SavedArray.h"
+
+
+// Pages are PROGMEM strings with a few control characters in the text.
+// The macros build them by literal concatenation, e.g.
+//
+//   const char TPL[] PROGMEM = "<table>" TPL_ROWS 
+//       "<tr><td>" TPL_FIELD(0) "</td></tr>" TPL_END "</table>";
+//
+// The part between TPL_ROWS and TPL_END is repeated for every visible
+// row and each TPL_FIELD(n), n a digit, is printed by the row source.
+#define TPL_FIELD(n) "\x01" #n
+#define TPL_ROWS "\x02"
+#define TPL_END "\x03"
+
+
+class TemplateRows {
+public:
+	virtual uint16_t getCount() const = 0;
+	virtual bool isVisible(uint16_t row) const = 0;
+	virtual void printField(Print&, uint16_t row, byte field) const = 0;
+};
+
+// Rows of a SavedArray that are active, fields are printed by
+// f(out, context, element, index, field).
+template<class A, class T, class C> class ArrayRows : public TemplateRows {
+public:
+	typedef void (*Field)(Print&, const C&, const T&, uint16_t, byte);
+private:
+	const A& array;
+	const C& context;
+	Field field;
+public:
+	ArrayRows(const A&, const C&, Field);
+
+	virtual uint16_t getCount() const;
+	virtual bool isVisible(uint16_t) const;
+	virtual void printField(Print&, uint16_t, byte) const;
+};
+
+// Rows of a SavedArray at the ids a registry lists (see SwitchRegistry),
+// in its order. Only active elements are visited at all.
+template<class A, class R, class T, class C> class RegistryRows : public TemplateRows {
+public:
+	typedef typename ArrayRows<A, T, C>::Field Field;
+private:
+	const A& array;
+	const R& registry;
+	const C& context;
+	Field field;
+public:
+	RegistryRows(const A&, const R&, const C&, Field);
+
+	virtual uint16_t getCount() const;
+	virtual bool isVisible(uint16_t) const;
+	virtual void printField(Print&, uint16_t, byte) const;
+};
+
+template<class A, class T, class C>
+ArrayRows<A, T, C>::ArrayRows(const A& _array, const C& _context, Field _field):
+	array(_array), context(_context), field(_field)
+{}
+
+template<class A, class T, class C>
+uint16_t ArrayRows<A, T, C>::getCount() const
+{
+	return array.getSize();
+}
+
+template<class A, class T, class C>
+bool ArrayRows<A, T, C>::isVisible(uint16_t i) const
+{
+	return array[i].isActive();
+}
+
+template<class A, class T, class C>
+void ArrayRows<A, T, C>::printField(Print& out, uint16_t i, byte f) const
+{
+	field(out, context, array[i], i, f);
+}
+
+template<class A, class R, class T, class C>
+RegistryRows<A, R, T, C>::RegistryRows(const A& _array, const R& _registry, 
+		const C& _context, Field _field):
+	array(_array), registry(_registry), context(_context), field(_field)
+{}
+
+template<class A, class R, class T, class C>
+uint16_t RegistryRows<A, R, T, C>::getCount() const
+{
+	return registry.getCount();
+}
+
+template<class A, class R, class T, class C>
+bool RegistryRows<A, R, T, C>::isVisible(uint16_t) const
+{
+	return true;
+}
+
+template<class A, class R, class T, class C>
+void RegistryRows<A, R, T, C>::printField(Print& out, uint16_t row, byte f) const
+{
+	uint16_t i = registry[row];
+
+	field(out, context, array[i], i, f);
+}
+
+// deduces the template arguments, e.g. 
+// PageTemplate::render(out, TPL, arrayRows(st.switches, st, switchField))
+template<class T, uint16_t sz, class S, class C>
+ArrayRows<SavedArray<T, sz, S>, T, C> arrayRows(const SavedArray<T, sz, S>& array, 
+	const C& context, void (*field)(Print&, const C&, const T&, uint16_t, byte))
+{
+	return ArrayRows<SavedArray<T, sz, S>, T, C>(array, context, field);
+}
+
+// e.g. registryRows(st.switches, st.registry, st, switchField)
+template<class T, uint16_t sz, class S, class R, class C>
+RegistryRows<SavedArray<T, sz, S>, R, T, C> registryRows(const SavedArray<T, sz, S>& array, 
+	const R& registry, const C& context, 
+	void (*field)(Print&, const C&, const T&, uint16_t, byte))
+{
+	return RegistryRows<SavedArray<T, sz, S>, R, T, C>(array, registry, context, field);
+}
+
+
+class PageTemplate {
+	static const char* renderPart(Print&, const char*, const TemplateRows*, 
+		uint16_t row, bool emit, size_t& sent);
+public:
+	// tpl in PROGMEM, rows may be NULL if tpl has no TPL_ROWS
+	static void render(Print&, const char* tpl, const TemplateRows* rows = NULL);
+	static void render(Print&, const char* tpl, const TemplateRows& rows);
+};
+
+#endif
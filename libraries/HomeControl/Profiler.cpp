@@ -0,0 +1,166 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Profiler.h"
+
+
+#ifdef __AVR__
+namespace {
+
+// Fill the free RAM with the canary before the C runtime sets up
+// anything. Runs from .init1 where r1 is not yet zero, so no C code.
+void paintStack() __attribute__((naked, used, section(".init1")));
+
+void paintStack()
+{
+	__asm volatile (
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:\n"
+		"	st Z+, r24\n"
+		"2:\n"
+		"	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M" (Profiler::STACK_CANARY));
+}
+
+}
+#endif
+
+
+Profiler::Profiler():
+	reached(0), busy(0)
+{
+	memset(timing, 0, sizeof(timing));
+	memset(counter, 0, sizeof(counter));
+	memset(route, 0, sizeof(route));
+	memset(milestone, 0, sizeof(milestone));
+}
+
+// only the gateway workers on hosted builds record concurrently
+void Profiler::lock()
+{
+#ifndef __AVR__
+	while (__sync_lock_test_and_set(&busy, 1))
+		;
+#endif
+}
+
+void Profiler::unlock()
+{
+#ifndef __AVR__
+	__sync_lock_release(&busy);
+#endif
+}
+
+void Profiler::record(byte phase, unsigned long start)
+{
+	unsigned long us = micros() - start;
+	byte b = 0;
+
+	// bucket b counts samples up to and including 64 * 4^b
+	for (unsigned long v = (us ? us-1 : 0) >> 6; v && b < BUCKETS-1; v >>= 2)
+		b++;
+
+	lock();
+	Timing& t = timing[phase];
+	if (t.count == 0 || us < t.min)
+		t.min = us;
+	if (us > t.max)
+		t.max = us;
+	t.sum += us;
+	t.count++;
+	t.hist[b]++;
+	unlock();
+}
+
+void Profiler::count(byte c)
+{
+	lock();
+	counter[c]++;
+	unlock();
+}
+
+void Profiler::countRoute(byte r)
+{
+	if (r >= MAX_ROUTES)
+		return;
+	lock();
+	route[r]++;
+	unlock();
+}
+
+void Profiler::reach(byte m)
+{
+	if (isReached(m))
+		return;
+	milestone[m] = millis();
+	reached |= 1 << m;
+}
+
+const Profiler::Timing& Profiler::getTiming(byte phase) const
+{
+	return timing[phase];
+}
+
+unsigned long Profiler::getCount(byte c) const
+{
+	return counter[c];
+}
+
+unsigned long Profiler::getRouteCount(byte r) const
+{
+	return r < MAX_ROUTES ? route[r] : 0;
+}
+
+bool Profiler::isReached(byte m) const
+{
+	return reached >> m & 1;
+}
+
+unsigned long Profiler::getMilestone(byte m) const
+{
+	return milestone[m];
+}
+
+unsigned long Profiler::getBucketLimit(byte b)
+{
+	return 64UL << (2*b);
+}
+
+unsigned int Profiler::getStackFree()
+{
+#ifdef __AVR__
+	extern int __heap_start, *__brkval;
+	const uint8_t* p = (const uint8_t*)(__brkval ? __brkval : &__heap_start);
+	unsigned int n = 0;
+
+	while (p < (const uint8_t*)SP && *p == STACK_CANARY) {
+		p++;
+		n++;
+	}
+	return n;
+#else
+	return 0;
+#endif
+}
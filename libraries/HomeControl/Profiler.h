@@ -0,0 +1,81 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Arduino.h"
+
+
+// Timings of the loop() phases, a few event counters and how long the
+// start took. A sample is a subtraction, a shift loop and some adds, 
+// so it stays enabled.
+class Profiler {
+public:
+	enum Phase { HTTP, RF, RULES, SCHEDULE, NTP, ETHERNET, PHASES };
+	enum Counter { RF_CODES, RF_REPEATS, COUNTERS };
+	// the radio acts on codes, all config is loaded, the network is up
+	enum Milestone { BOOT_RADIO, BOOT_CONFIG, BOOT_NETWORK, MILESTONES };
+
+	static const byte BUCKETS = 8;
+	static const byte MAX_ROUTES = 20;
+	// the stack is painted with this before main(), see Profiler.cpp
+	static const byte STACK_CANARY = 0xc5;
+
+	struct Timing {
+		unsigned long min;
+		unsigned long max;
+		unsigned long sum;
+		unsigned long count;
+		unsigned long hist[BUCKETS];
+	};
+
+private:
+	Timing timing[PHASES];
+	unsigned long counter[COUNTERS];
+	unsigned long route[MAX_ROUTES];
+	unsigned long milestone[MILESTONES];
+	byte reached;
+	volatile byte busy;
+
+	void lock();
+	void unlock();
+public:
+	Profiler();
+
+	// start is the micros() value taken when the phase began
+	void record(byte phase, unsigned long start);
+	void count(byte counter);
+	void countRoute(byte route);
+	// records millis() the first time the start gets that far, only 
+	// called from loop() and setup()
+	void reach(byte milestone);
+
+	const Timing& getTiming(byte phase) const;
+	unsigned long getCount(byte counter) const;
+	unsigned long getRouteCount(byte route) const;
+	bool isReached(byte milestone) const;
+	unsigned long getMilestone(byte milestone) const;
+
+	// upper bound of histogram bucket b in microseconds, 64 * 4^b
+	static unsigned long getBucketLimit(byte b);
+	// bytes of stack that were never touched
+	static unsigned int getStackFree();
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RateLimiter.h"
+
+
+RateLimiter::RateLimiter():
+	used(0), sliceStart(0), sliceLeft(BUDGET), 
+	admitted(0), limited(0), shed(0), evictions(0), busy(0)
+{}
+
+// gateway workers admit their requests concurrently
+void RateLimiter::lock()
+{
+#ifndef __AVR__
+	while (__sync_lock_test_and_set(&busy, 1))
+		;
+#endif
+}
+
+void RateLimiter::unlock()
+{
+#ifndef __AVR__
+	__sync_lock_release(&busy);
+#endif
+}
+
+// whole tokens only, the remainder of the interval is kept
+void RateLimiter::refill(Bucket& b, unsigned long now)
+{
+	unsigned long n = (now - b.last) / REFILL;
+
+	if (n >= (unsigned long)(BURST - b.tokens)) {
+		b.tokens = BURST;
+		b.last = now;
+	} else {
+		b.tokens += n;
+		b.last += n * REFILL;
+	}
+}
+
+RateLimiter::Bucket& RateLimiter::find(uint32_t addr, unsigned long now)
+{
+	byte victim = 0;
+
+	for (byte i = 0; i < used; i++) {
+		Bucket& b = table[i];
+		refill(b, now);
+		if (b.addr == addr)
+			return b;
+		if (b.tokens < table[victim].tokens)
+			victim = i;
+	}
+
+	if (used < CLIENTS) {
+		Bucket& b = table[used++];
+		b.addr = addr;
+		b.last = now;
+		b.tokens = BURST;
+		return b;
+	}
+	evictions++;
+	table[victim].addr = addr;
+	return table[victim];
+}
+
+RateLimiter::Result RateLimiter::admit(uint32_t addr, unsigned long now)
+{
+	lock();
+	Bucket& b = find(addr, now);
+
+	if (now - sliceStart >= SLICE) {
+		sliceStart = now;
+		sliceLeft = BUDGET;
+	}
+
+	Result r;
+	if (b.tokens == 0) {
+		limited++;
+		r = LIMITED;
+	} else if (sliceLeft == 0 || (sliceLeft <= RESERVE && b.tokens < BURST)) {
+		b.tokens--;
+		shed++;
+		r = SHED;
+	} else {
+		b.tokens--;
+		sliceLeft--;
+		admitted++;
+		r = ADMIT;
+	}
+	unlock();
+	return r;
+}
+
+unsigned long RateLimiter::getAdmitted() const
+{
+	return admitted;
+}
+
+unsigned long RateLimiter::getLimited() const
+{
+	return limited;
+}
+
+unsigned long RateLimiter::getShed() const
+{
+	return shed;
+}
+
+unsigned long RateLimiter::getEvictions() const
+{
+	return evictions;
+}
+
+byte RateLimiter::getClients() const
+{
+	return used;
+}
@@ -0,0 +1,90 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include "Arduino.h"
+
+
+// Admission control for the web server. Each client address gets a
+// token bucket, so one busy client cannot take every loop() pass, and
+// all clients together share a request budget per time slice, so
+// schedules and rf codes are still handled while many clients poll.
+// The end of the budget is kept for clients with a full bucket, so
+// someone who just opens a page gets through while others flood.
+// An address beyond the table takes over the emptiest bucket with its
+// tokens, so cycling addresses does not refill them.
+// The budget is per SLICE ms, not per loop() pass: a pass of the board
+// serves one request at most anyway, and gateway workers serve pages 
+// beside loop(). What delays schedules is the request rate.
+class RateLimiter {
+public:
+	enum Result { ADMIT, LIMITED, SHED };
+
+#ifdef __AVR__
+	static const byte CLIENTS = 8;
+	static const byte BUDGET = 8;		// requests per slice, all clients
+	static const byte RESERVE = 2;		// of it for clients with a full bucket
+#else
+	static const byte CLIENTS = 32;
+	static const byte BUDGET = 64;
+	static const byte RESERVE = 8;
+#endif
+	static const byte BURST = 8;				// requests a client can send at once
+	static const unsigned long REFILL = 250;	// ms until it may send one more
+	static const unsigned long SLICE = 1000;	// ms
+private:
+	struct Bucket {
+		uint32_t addr;
+		unsigned long last;		// millis() of the last refill
+		byte tokens;
+	};
+
+	Bucket table[CLIENTS];
+	byte used;
+	unsigned long sliceStart;
+	byte sliceLeft;
+	unsigned long admitted;
+	unsigned long limited;
+	unsigned long shed;
+	unsigned long evictions;
+	volatile byte busy;
+
+	void lock();
+	void unlock();
+	static void refill(Bucket&, unsigned long now);
+	Bucket& find(uint32_t addr, unsigned long now);
+public:
+	RateLimiter();
+
+	// every request takes a token from the bucket of addr, an admitted
+	// one also takes one from the budget
+	Result admit(uint32_t addr, unsigned long now);
+
+	unsigned long getAdmitted() const;
+	// rejected because the client's bucket was empty
+	unsigned long getLimited() const;
+	// rejected because the slice budget was used up
+	unsigned long getShed() const;
+	// buckets taken over by another address
+	unsigned long getEvictions() const;
+	byte getClients() const;
+};
+
+#endif
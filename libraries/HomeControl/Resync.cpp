@@ -0,0 +1,61 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Resync.h"
+
+
+Resync::Resync():
+	period(0), last(Switch::NONE), lastTime(0), sent(0)
+{}
+
+void Resync::begin(unsigned long now)
+{
+	last = Switch::NONE;
+	lastTime = now;
+	sent = 0;
+}
+
+uint16_t Resync::getPeriod() const
+{
+	return period;
+}
+
+void Resync::setPeriod(uint16_t p)
+{
+	period = p < MAX_PERIOD ? p : MAX_PERIOD;
+}
+
+switch_id_t Resync::next(switch_id_t count, unsigned long now)
+{
+	if (!period || !count || now - lastTime < period * 60000UL / count)
+		return Switch::NONE;
+
+	last = last + 1 < count ? last + 1 : 0;
+	lastTime = now;
+	return last;
+}
+
+void Resync::count()
+{
+	sent++;
+}
+
+unsigned long Resync::getSent() const
+{
+	return sent;
+}
@@ -0,0 +1,56 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RESYNC_H
+#define RESYNC_H
+
+#include "Arduino.h"
+#include "Switch.h"
+
+
+// Picks the switches whose recorded state is sent again in the 
+// background, so outlets that missed a command or lost power come back
+// in line. One switch after the other, spread evenly over the period,
+// which bounds the airtime. Switches are taken by their position among
+// the active ones (see SwitchRegistry).
+class Resync {
+	uint16_t period;		// minutes for a round, 0 for off
+	switch_id_t last;		// position sent last
+	unsigned long lastTime;	// millis() of that
+	unsigned long sent;
+public:
+	static const uint16_t MAX_PERIOD = 1440;
+
+	Resync();
+
+	// restarts the round, the rest is kept in eeprom
+	void begin(unsigned long now);
+
+	uint16_t getPeriod() const;
+	void setPeriod(uint16_t);
+
+	// The position out of count active switches to send at now, the 
+	// one after the last. Switch::NONE if it is not time yet.
+	switch_id_t next(switch_id_t count, unsigned long now);
+	// the switch there was sent, it may not take part
+	void count();
+
+	unsigned long getSent() const;
+};
+
+#endif
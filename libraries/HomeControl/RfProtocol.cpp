@@ -0,0 +1,46 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RfProtocol.h"
+
+
+namespace {
+
+const RfProtocol protocols[RfProtocol::COUNT] = {
+	{ 350,  1, 31,  1,  3,  3,  1, false },
+	{ 650,  1, 10,  1,  2,  2,  1, false },
+	{ 100, 30, 71,  4, 11,  9,  6, false },
+	{ 380,  1,  6,  1,  3,  3,  1, false },
+	{ 500,  6, 14,  1,  2,  2,  1, false },
+	{ 450, 23,  1,  1,  2,  2,  1, true },	// HT6P20B
+};
+
+}
+
+
+const RfProtocol* RfProtocol::get(byte p)
+{
+	if (p < 1 || p > COUNT)
+		return NULL;
+	return &protocols[p-1];
+}
+
+unsigned long RfCode::getId() const
+{
+	return (unsigned long)protocol << 24 | ((value ^ value >> 24) & 0xffffffUL);
+}
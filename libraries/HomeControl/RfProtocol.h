@@ -0,0 +1,52 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RF_PROTOCOL_H
+#define RF_PROTOCOL_H
+
+#include "Arduino.h"
+
+
+// Pulse timings of the RCSwitch protocols, in multiples of pulseLength
+struct RfProtocol {
+	static const byte COUNT = 6;
+	static const byte RAW = 7;	// learned pulse pattern, receive only
+
+	uint16_t pulseLength;	// us
+	byte syncHigh, syncLow;
+	byte zeroHigh, zeroLow;
+	byte oneHigh, oneLow;
+	bool inverted;
+
+	// protocols are numbered from 1 like in RCSwitch, NULL if unknown
+	static const RfProtocol* get(byte);
+};
+
+// A received or learned code
+struct RfCode {
+	byte protocol;
+	byte bits;
+	unsigned long value;
+
+	// id used by EventRule and the event log, the protocol in the top
+	// byte, so equal values of two protocols never match. Codes longer
+	// than 24 bits fold their top bits in.
+	unsigned long getId() const;
+};
+
+#endif
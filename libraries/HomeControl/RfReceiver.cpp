@@ -0,0 +1,222 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RfReceiver.h"
+
+
+namespace {
+
+// learned codes only tell pulse widths apart by this much
+const byte RAW_TOLERANCE = 30;	// percent
+const byte RAW_WIDTHS = 4;
+// gaps around one frame differ by less than this
+const uint16_t GAP_TOLERANCE = 200;	// us
+const byte MIN_FRAME = 8;
+const unsigned long NO_MATCH = 0xffffffffUL;
+
+unsigned long diff(unsigned long a, unsigned long b)
+{
+	return a > b ? a - b : b - a;
+}
+
+bool near(unsigned long v, unsigned long expect, unsigned long tolerance)
+{
+	return diff(v, expect) < tolerance;
+}
+
+// error of one pulse relative to its expected length, in 1/16
+unsigned long error(unsigned long v, unsigned long expect)
+{
+	return diff(v, expect) * 16 / expect;
+}
+
+}
+
+
+RfReceiver* RfReceiver::instance = NULL;
+
+RfReceiver::RfReceiver():
+	head(0), tail(0), interrupt(-1), lastEdge(0), missed(0), overruns(0), 
+	frameSize(0)
+{}
+
+void RfReceiver::begin(int _interrupt)
+{
+	instance = this;
+	interrupt = _interrupt;
+	enable();
+}
+
+void RfReceiver::enable()
+{
+	if (interrupt < 0)
+		return;
+	lastEdge = micros();
+	attachInterrupt(interrupt, handleInterrupt, CHANGE);
+}
+
+void RfReceiver::disable()
+{
+	if (interrupt >= 0)
+		detachInterrupt(interrupt);
+}
+
+void RfReceiver::handleInterrupt()
+{
+	unsigned long now = micros();
+	instance->putEdge(now - instance->lastEdge);
+	instance->lastEdge = now;
+}
+
+void RfReceiver::putEdge(unsigned long d)
+{
+	byte next = (head + 1) & (EDGES-1);
+
+	if (next == tail) {
+		overruns++;
+		return;
+	}
+	edge[head] = d > 0xffff ? 0xffff : d;
+	head = next;
+}
+
+bool RfReceiver::poll(RfCode& code)
+{
+	for (byte n = 0; n < POLL_EDGES && tail != head; n++) {
+		uint16_t d = edge[tail];
+		tail = (tail + 1) & (EDGES-1);
+
+		// a gap ends the frame and starts the next one, senders
+		// repeat their code with equal gaps so anything else is noise
+		if (d > SHORT_SEPARATION && frameSize >= MIN_FRAME && 
+				near(d, frame[0], GAP_TOLERANCE)) {
+			if (decode(code)) {
+				frame[0] = d;
+				frameSize = 1;
+				return true;
+			}
+			if (d > SEPARATION)
+				missed++;
+		}
+
+		if (d > SEPARATION || (d > SHORT_SEPARATION && frameSize == 0)) {
+			frame[0] = d;
+			frameSize = 1;
+		} else if (frameSize == 0 || frameSize == MAX_FRAME) {
+			frameSize = 0;	// noise, wait for the next gap
+		} else {
+			frame[frameSize++] = d;
+		}
+	}
+	return false;
+}
+
+// The tolerance lets some protocols match the same frame (2 and 5),
+// the one with the timing closest to the frame wins.
+bool RfReceiver::decode(RfCode& code) const
+{
+	unsigned long best = NO_MATCH;
+	RfCode c;
+
+	for (byte p = 1; p <= RfProtocol::COUNT; p++) {
+		unsigned long error = decodeProtocol(p, c);
+		if (error < best) {
+			best = error;
+			code = c;
+		}
+	}
+	return best != NO_MATCH || decodeRaw(code);
+}
+
+// sum of the relative timing errors, NO_MATCH if a pulse is off by
+// more than the tolerance
+unsigned long RfReceiver::decodeProtocol(byte p, RfCode& code) const
+{
+	const RfProtocol* pro = RfProtocol::get(p);
+	byte sync = max(pro->syncHigh, pro->syncLow);
+	unsigned long unit = frame[0] / sync;
+	unsigned long tolerance = unit * TOLERANCE / 100;
+	unsigned long value = 0;
+	unsigned long sum = 0;
+
+	if (unit == 0)
+		return NO_MATCH;
+
+	for (byte i = pro->inverted ? 2 : 1; i < frameSize - 1; i += 2) {
+		unsigned long high, low;
+
+		value <<= 1;
+		if (near(frame[i], unit * pro->zeroHigh, tolerance) &&
+				near(frame[i+1], unit * pro->zeroLow, tolerance)) {
+			high = unit * pro->zeroHigh;
+			low = unit * pro->zeroLow;
+		} else if (near(frame[i], unit * pro->oneHigh, tolerance) &&
+				near(frame[i+1], unit * pro->oneLow, tolerance)) {
+			high = unit * pro->oneHigh;
+			low = unit * pro->oneLow;
+			value |= 1;
+		} else {
+			return NO_MATCH;
+		}
+		sum += error(frame[i], high) + error(frame[i+1], low);
+	}
+	code.protocol = p;
+	code.bits = (frameSize - 1) / 2;
+	code.value = value;
+	return sum;
+}
+
+// Unknown protocols are told apart by their pattern of pulse widths:
+// each width becomes a symbol in order of appearance and the symbol
+// string is hashed (FNV-1a), so the code does not depend on jitter.
+bool RfReceiver::decodeRaw(RfCode& code) const
+{
+	uint16_t width[RAW_WIDTHS];
+	byte widths = 0;
+	uint32_t hash = 2166136261UL;
+
+	for (byte i = 1; i < frameSize; i++) {
+		byte w = 0;
+		while (w < widths && 
+				!near(frame[i], width[w], uint32_t(width[w]) * RAW_TOLERANCE / 100))
+			w++;
+		if (w == widths) {
+			if (widths == RAW_WIDTHS)
+				return false;
+			width[widths++] = frame[i];
+		}
+		hash = (hash ^ w) * 16777619UL;
+	}
+	if (widths < 2)
+		return false;
+
+	code.protocol = RfProtocol::RAW;
+	code.bits = (frameSize - 1) / 2;
+	code.value = (hash ^ hash >> 24) & 0xffffffUL;
+	return true;
+}
+
+unsigned long RfReceiver::getMissed() const
+{
+	return missed;
+}
+
+unsigned long RfReceiver::getOverruns() const
+{
+	return overruns;
+}
@@ -0,0 +1,75 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RF_RECEIVER_H
+#define RF_RECEIVER_H
+
+#include "Arduino.h"
+#include "RfProtocol.h"
+
+
+// Receives 433 MHz codes. The interrupt only stores the time between
+// two edges in a ring, poll() assembles frames from it and decodes
+// them in the loop, a bounded number of edges per call.
+class RfReceiver {
+public:
+	static const byte EDGES = 128;		// ring size, power of 2
+	static const byte MAX_FRAME = 67;	// gap, 32 bits, sync pulse
+	static const byte POLL_EDGES = 32;
+	static const uint16_t SEPARATION = 4300;	// us, gap between frames
+	// protocol 4 has a gap of 2280 us, shorter ones might be gaps
+	static const uint16_t SHORT_SEPARATION = 2000;
+	static const byte TOLERANCE = 60;	// percent
+private:
+	static RfReceiver* instance;
+
+	volatile uint16_t edge[EDGES];
+	volatile byte head;
+	byte tail;
+	int interrupt;
+	unsigned long lastEdge;
+	unsigned long missed;
+	volatile unsigned long overruns;
+
+	uint16_t frame[MAX_FRAME];
+	byte frameSize;
+
+	static void handleInterrupt();
+
+	bool decode(RfCode&) const;
+	unsigned long decodeProtocol(byte, RfCode&) const;
+	bool decodeRaw(RfCode&) const;
+public:
+	RfReceiver();
+
+	void begin(int interrupt);
+	void enable();
+	void disable();
+
+	// time since the previous edge in us, called from the interrupt
+	// or to replay a recorded trace
+	void putEdge(unsigned long);
+
+	// true when a complete code was decoded
+	bool poll(RfCode&);
+
+	unsigned long getMissed() const;
+	unsigned long getOverruns() const;
+};
+
+#endif
@@ -15,92 +15,225 @@
 	You should have received a copy of the GNU General Public License
 	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-
 #ifndef RING_BUFFER_H
 #define RING_BUFFER_H
 
 
-template<class T, byte sz> class RingBuffer {
-	byte start;
-	byte count;
+// Index type and wrap-around for a ring of sz elements, chosen at compile
+// time. Indices are always below 2*sz, so other sizes get by with one
+// compare instead of a division; powers of two just mask.
+template<bool small> struct RingIndex {
+	typedef byte type;
+};
+
+template<> struct RingIndex<false> {
+	typedef unsigned int type;
+};
+
+template<unsigned int sz, bool pow2 = (sz & (sz - 1)) == 0> struct RingWrap {
+	static unsigned int wrap(unsigned int i) { return i >= sz ? i - sz : i; }
+};
+
+template<unsigned int sz> struct RingWrap<sz, true> {
+	static unsigned int wrap(unsigned int i) { return i & (sz - 1); }
+};
+
+
+// Fixed size FIFO, put() on a full buffer overwrites the oldest element.
+// Holds up to 32768 elements, up to 255 take a byte per index.
+template<class T, unsigned int sz> class RingBuffer {
+public:
+	typedef typename RingIndex<sz <= 255>::type size_type;
+
+	// oldest to newest, invalidated by put() and get()
+	class iterator {
+		RingBuffer* ring;
+		size_type pos;
+	public:
+		iterator(RingBuffer* r, size_type p): ring(r), pos(p) {}
+		T& operator*() const { return (*ring)[pos]; }
+		T* operator->() const { return &(*ring)[pos]; }
+		iterator& operator++() { pos++; return *this; }
+		iterator operator++(int) { iterator i = *this; pos++; return i; }
+		bool operator==(const iterator& i) const { return pos == i.pos; }
+		bool operator!=(const iterator& i) const { return pos != i.pos; }
+	};
+
+	class const_iterator {
+		const RingBuffer* ring;
+		size_type pos;
+	public:
+		const_iterator(const RingBuffer* r, size_type p): ring(r), pos(p) {}
+		const T& operator*() const { return (*ring)[pos]; }
+		const T* operator->() const { return &(*ring)[pos]; }
+		const_iterator& operator++() { pos++; return *this; }
+		const_iterator operator++(int) { const_iterator i = *this; pos++; return i; }
+		bool operator==(const const_iterator& i) const { return pos == i.pos; }
+		bool operator!=(const const_iterator& i) const { return pos != i.pos; }
+	};
+private:
+	typedef char static_assert_ring_size[(sz > 0 && sz <= 32768U) ? 1 : -1];
+
+	size_type start;
+	size_type count;
 	T data[sz];
+
+	static size_type wrap(unsigned int i) { return RingWrap<sz>::wrap(i); }
 public:
 	RingBuffer();
 	
 	void put(const T&);
+	// keeps the last sz elements if n exceeds the capacity
+	void putMany(const T*, unsigned int n);
 	T& get();
+	// moves up to n of the oldest elements to dst, returns how many
+	size_type drainInto(T* dst, size_type n);
+	// newest element, buffer must not be empty
+	T& peekLast();
+	const T& peekLast() const;
 	void clear();
 	
 	bool isFull() const;
 	bool isEmpty() const;
 	
-	byte getSize() const;
+	size_type getSize() const;
 	
-	const T& operator[](byte) const;
-	T& operator[](byte);
+	const T& operator[](size_type) const;
+	T& operator[](size_type);
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
 };
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
 RingBuffer<T, sz>::RingBuffer()
 {
 	clear();
 }
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
 void RingBuffer<T, sz>::put(const T& elem)
 {
-	int i = (start + count) % sz;
-	data[i] = elem;
+	data[wrap(start + count)] = elem;
 	
 	if (count == sz)
-		start = (start + 1) % sz;
+		start = wrap(start + 1);
 	else
 		count++;
 }
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
+void RingBuffer<T, sz>::putMany(const T* src, unsigned int n)
+{
+	if (n > sz) {
+		src += n - sz;
+		n = sz;
+	}
+	size_type i = wrap(start + count);
+	while (n--) {
+		data[i] = *src++;
+		i = wrap(i + 1);
+		if (count == sz)
+			start = i;
+		else
+			count++;
+	}
+}
+
+template<class T, unsigned int sz> 
 T& RingBuffer<T, sz>::get()
 {
-	int i = start;
-	start = (start + 1) % sz;
+	size_type i = start;
+	start = wrap(start + 1);
 	count--;
 	return data[i];
 }
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::size_type RingBuffer<T, sz>::drainInto(T* dst, size_type n)
+{
+	if (n > count)
+		n = count;
+	for (size_type i = 0; i < n; i++) {
+		dst[i] = data[start];
+		start = wrap(start + 1);
+	}
+	count -= n;
+	return n;
+}
+
+template<class T, unsigned int sz> 
+T& RingBuffer<T, sz>::peekLast()
+{
+	return data[wrap(start + count - 1)];
+}
+
+template<class T, unsigned int sz> 
+const T& RingBuffer<T, sz>::peekLast() const
+{
+	return data[wrap(start + count - 1)];
+}
+
+template<class T, unsigned int sz> 
 bool RingBuffer<T, sz>::isFull() const
 {
 	return count == sz;
 }
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
 bool RingBuffer<T, sz>::isEmpty() const
 {
 	return count == 0;
 }
 
-template<class T, byte sz> 
+template<class T, unsigned int sz> 
 void RingBuffer<T, sz>::clear()
 {
 	start = count = 0;
 }
 
-template<class T, byte sz> 
-byte RingBuffer<T, sz>::getSize() const
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::size_type RingBuffer<T, sz>::getSize() const
 {
 	return count;
 }
 
-template<class T, byte sz> 
-const T& RingBuffer<T, sz>::operator[](byte i) const
+template<class T, unsigned int sz> 
+const T& RingBuffer<T, sz>::operator[](size_type i) const
+{
+	return data[wrap(start + i)];
+}
+
+template<class T, unsigned int sz> 
+T& RingBuffer<T, sz>::operator[](size_type i)
+{
+	return data[wrap(start + i)];
+}
+
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::iterator RingBuffer<T, sz>::begin()
+{
+	return iterator(this, 0);
+}
+
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::iterator RingBuffer<T, sz>::end()
+{
+	return iterator(this, count);
+}
+
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::const_iterator RingBuffer<T, sz>::begin() const
 {
-	return data[(start + i) % sz];
+	return const_iterator(this, 0);
 }
 
-template<class T, byte sz> 
-T& RingBuffer<T, sz>::operator[](byte i)
+template<class T, unsigned int sz> 
+typename RingBuffer<T, sz>::const_iterator RingBuffer<T, sz>::end() const
 {
-	return data[(start + i) % sz];
+	return const_iterator(this, count);
 }
 
-#endif
\ No newline at end of file
+#endif
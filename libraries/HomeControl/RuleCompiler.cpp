@@ -0,0 +1,177 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RuleCompiler.h"
+
+
+namespace {
+	const int THRESHOLD_SCALE = 10;
+	const uint16_t MINUTES_PER_DAY = 1440;
+	const uint16_t NO_MINUTE = 0xFFFF;
+
+	// checkbox names in the bit order of Week
+	const char* const DAYS[] = {
+		"sun", "mon", "tue", "wed", "thu", "fri", "sat", "all"
+	};
+
+	// "18:30", or "18%3A30" as a time input posts it
+	uint16_t parseMinute(const char* v)
+	{
+		unsigned int h = atoi(v);
+		unsigned int m = 0;
+		const char* sep = strchr(v, ':');
+
+		if (sep)
+			m = atoi(sep + 1);
+		else if ((sep = strstr(v, "%3A")) != NULL)
+			m = atoi(sep + 3);
+
+		return (h * 60 + m) % MINUTES_PER_DAY;
+	}
+
+	int16_t parseLevel(const char* v)
+	{
+		float th = atof(v) * THRESHOLD_SCALE;
+		th += th < 0 ? -0.5 : 0.5;
+
+		if (th > 32767)
+			return 32767;
+		if (th < -32767)
+			return -32767;
+		return th;
+	}
+}
+
+
+RuleCompiler::RuleCompiler():
+	length(0), days(0), sensor(NONE), above(1), switchId(Switch::NONE), 
+	action(1), from(NO_MINUTE), failed(false)
+{}
+
+bool RuleCompiler::isTrigger() const
+{
+	return length == 0;
+}
+
+bool RuleCompiler::emit(byte op, const byte* arg, byte n)
+{
+	// everything but the trigger needs one
+	if (isTrigger() != (op < RuleProgram::IF_TIME) || 
+			length + 1 + n > RuleProgram::CODE_SIZE) {
+		failed = true;
+		return false;
+	}
+	code[length++] = op;
+	memcpy(code + length, arg, n);
+	length += n;
+	return true;
+}
+
+bool RuleCompiler::emitWord(byte op, uint16_t w)
+{
+	byte arg[2] = { byte(w), byte(w >> 8) };
+	return emit(op, arg, sizeof(arg));
+}
+
+bool RuleCompiler::add(const char* key, const char* value)
+{
+	for (byte i = 0; i < sizeof(DAYS)/sizeof(DAYS[0]); i++) {
+		if (strcmp(key, DAYS[i]) == 0) {
+			days |= 1 << i;
+			return true;
+		}
+	}
+
+	if (strcmp(key, "rf") == 0) {
+		if (value) {
+			unsigned long id = strtoul(value, NULL, 10);
+			byte arg[4] = { byte(id), byte(id >> 8), byte(id >> 16), byte(id >> 24) };
+			emit(RuleProgram::ON_RF, arg, sizeof(arg));
+		}
+	} else if (strcmp(key, "at") == 0) {
+		if (value)
+			emitWord(RuleProgram::ON_TIME, parseMinute(value));
+	} else if (strcmp(key, "sensor") == 0) {
+		sensor = value ? atoi(value) : NONE;
+	} else if (strcmp(key, "cmp") == 0) {
+		above = value && atoi(value);
+	} else if (strcmp(key, "level") == 0) {
+		if (value && sensor != NONE) {
+			byte op = isTrigger() ? RuleProgram::ON_ABOVE : RuleProgram::IF_ABOVE;
+			int16_t th = parseLevel(value);
+			byte arg[3] = { sensor, byte(th), byte(th >> 8) };
+			emit(above ? op : op + 1, arg, sizeof(arg));
+		}
+		sensor = NONE;
+	} else if (strcmp(key, "from") == 0) {
+		from = value ? parseMinute(value) : NO_MINUTE;
+	} else if (strcmp(key, "until") == 0) {
+		if (value && from != NO_MINUTE) {
+			uint16_t until = parseMinute(value);
+			byte arg[4] = { byte(from), byte(from >> 8), byte(until), byte(until >> 8) };
+			emit(RuleProgram::IF_TIME, arg, sizeof(arg));
+		}
+		from = NO_MINUTE;
+	} else if (strcmp(key, "ifSwitch") == 0) {
+		switchId = value ? atoi(value) : Switch::NONE;
+	} else if (strcmp(key, "is") == 0) {
+		if (value && switchId != Switch::NONE)
+			emitWord(atoi(value) ? RuleProgram::IF_ON : RuleProgram::IF_OFF, switchId);
+		switchId = Switch::NONE;
+	} else if (strcmp(key, "act") == 0) {
+		action = value ? atoi(value) : 1;
+	} else if (strcmp(key, "switch") == 0) {
+		if (value) {
+			byte op = action == 2 ? RuleProgram::TOGGLE : 
+				action ? RuleProgram::SWITCH_ON : RuleProgram::SWITCH_OFF;
+			emitWord(op, atoi(value));
+		}
+	} else if (strcmp(key, "wait") == 0) {
+		if (value) {
+			unsigned long s = strtoul(value, NULL, 10);
+			emitWord(RuleProgram::WAIT, s > 0xFFFF ? 0xFFFF : s);
+		}
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool RuleCompiler::isEmpty() const
+{
+	return length == 0 && !failed;
+}
+
+bool RuleCompiler::compile(RuleProgram& prog)
+{
+	if (failed || isTrigger())
+		return false;
+
+	if (days) {
+		// right after the trigger, the cheapest condition goes first
+		byte at = RuleProgram::getSize(code[0]);
+		if (length + 2 > RuleProgram::CODE_SIZE)
+			return false;
+		memmove(code + at + 2, code + at, length - at);
+		code[at] = RuleProgram::IF_DAYS;
+		code[at+1] = days;
+		length += 2;
+	}
+	prog.setCode(code, length);
+	return true;
+}
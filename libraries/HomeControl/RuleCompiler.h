@@ -0,0 +1,62 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RULE_COMPILER_H
+#define RULE_COMPILER_H
+
+#include "Arduino.h"
+#include "RuleProgram.h"
+#include "Switch.h"
+
+
+// Compiles the fields of a posted rule form, in the order they arrive,
+// into a RuleProgram. Empty fields are skipped, so one form can offer
+// every trigger and condition. The first of "rf", "at" or "sensor" is
+// the trigger, a later "sensor" is a condition:
+//
+//   rf=1234 | at=18:30 | sensor=0&cmp=1&level=25.5	trigger
+//   from=18:00&until=23:00, sun..sat, all			time window, days
+//   sensor=0&cmp=0&level=5, ifSwitch=2&is=0			conditions
+//   act=1&switch=3, wait=600						actions
+class RuleCompiler {
+	static const byte NONE = 255;
+
+	byte code[RuleProgram::CODE_SIZE];
+	byte length;
+	byte days;
+	byte sensor;
+	byte above;
+	switch_id_t switchId;
+	byte action;
+	uint16_t from;
+	bool failed;
+
+	bool emit(byte op, const byte*, byte);
+	bool emitWord(byte op, uint16_t);
+	bool isTrigger() const;
+public:
+	RuleCompiler();
+
+	// false if the key is not part of a rule
+	bool add(const char* key, const char* value);
+	bool isEmpty() const;
+	// false if the rule has no trigger or does not fit
+	bool compile(RuleProgram&);
+};
+
+#endif
@@ -0,0 +1,238 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RuleEngine.h"
+
+
+namespace {
+	const uint16_t MINUTES_PER_DAY = 1440;
+	const uint16_t NO_MINUTE = 0xFFFF;
+	// a larger step means the clock was set, missed minutes are not replayed
+	const uint16_t MAX_CATCH_UP = 5;
+	const int THRESHOLD_SCALE = 10;
+
+	uint16_t minuteOf(const DateTime& t)
+	{
+		return t.getHour() * 60 + t.getMinute();
+	}
+
+	bool inWindow(uint16_t m, uint16_t from, uint16_t until)
+	{
+		if (from <= until)
+			return from <= m && m < until;
+		return m >= from || m < until;	// over midnight
+	}
+}
+
+
+RuleEngine::RuleEngine(TimerWheel& _timers, SwitchState _isOn, 
+		SensorValue _sensor, SwitchAction _action):
+	programs(NULL), count(0), timers(_timers), 
+	isOn(_isOn), sensor(_sensor), action(_action),
+	level(0), known(0), lastMinute(NO_MINUTE), runs(0), dropped(0)
+{
+	memset(timer, NONE, sizeof(timer));
+}
+
+void RuleEngine::begin(const RuleProgram* _programs, byte n)
+{
+	programs = _programs;
+	count = n < MAX_PROGRAMS ? n : MAX_PROGRAMS;
+}
+
+bool RuleEngine::isAbove(const byte* arg)
+{
+	float th = float(int16_t(RuleProgram::getWord(arg + 1))) / THRESHOLD_SCALE;
+	return sensor(arg[0]) > th;
+}
+
+void RuleEngine::onCode(unsigned long id, const DateTime& now)
+{
+	for (byte i = 0; i < count; i++) {
+		const RuleProgram& prog = programs[i];
+
+		if (prog.getTrigger() != RuleProgram::ON_RF || !prog.isActive())
+			continue;
+		if (RuleProgram::getLong(prog.getCode() + 1) != id)
+			continue;
+
+		cancel(i);
+		run(i, RuleProgram::getSize(RuleProgram::ON_RF), now);
+	}
+}
+
+void RuleEngine::onMinute(const DateTime& now)
+{
+	uint16_t m = minuteOf(now);
+	uint16_t span = lastMinute == NO_MINUTE ? 1 : 
+		(m + MINUTES_PER_DAY - lastMinute) % MINUTES_PER_DAY;
+
+	if (span == 0)
+		return;
+	if (span > MAX_CATCH_UP)
+		span = 1;
+	lastMinute = m;
+
+	for (byte i = 0; i < count; i++) {
+		const RuleProgram& prog = programs[i];
+		const byte* code = prog.getCode();
+		unsigned long bit = 1UL << i;
+
+		if (!prog.isActive())
+			continue;
+
+		switch (code[0]) {
+			case RuleProgram::ON_TIME: {
+				uint16_t at = RuleProgram::getWord(code + 1);
+				// fires for every minute in (lastMinute, m]
+				if ((m + MINUTES_PER_DAY - at) % MINUTES_PER_DAY < span) {
+					cancel(i);
+					run(i, RuleProgram::getSize(RuleProgram::ON_TIME), now);
+				}
+				break;
+			}
+			case RuleProgram::ON_ABOVE:
+			case RuleProgram::ON_BELOW: {
+				bool state = isAbove(code + 1) == (code[0] == RuleProgram::ON_ABOVE);
+				// on the crossing only, the first reading just sets the level
+				if (state && (known & bit) && !(level & bit)) {
+					cancel(i);
+					run(i, RuleProgram::getSize(code[0]), now);
+				}
+				if (state)
+					level |= bit;
+				else
+					level &= ~bit;
+				known |= bit;
+				break;
+			}
+		}
+	}
+}
+
+void RuleEngine::resume(uint16_t data, const DateTime& now)
+{
+	byte prog = (data >> 8) & ~(TIMER_TAG >> 8);
+	byte pc = data;
+
+	if (prog >= count)
+		return;
+
+	timer[prog] = NONE;
+	if (programs[prog].isActive())
+		run(prog, pc, now);
+}
+
+void RuleEngine::cancel(byte prog)
+{
+	if (prog >= count || timer[prog] == NONE)
+		return;
+
+	timers.cancel(timer[prog]);
+	timer[prog] = NONE;
+}
+
+bool RuleEngine::suspend(byte prog, byte pc, unsigned long ms)
+{
+	timer[prog] = timers.add(ms, TIMER_TAG | prog << 8 | pc);
+
+	if (timer[prog] == NONE) {
+		dropped++;
+		return false;
+	}
+	return true;
+}
+
+void RuleEngine::run(byte prog, byte pc, const DateTime& now)
+{
+	const byte* code = programs[prog].getCode();
+	runs++;
+
+	while (pc < RuleProgram::CODE_SIZE) {
+		byte op = code[pc];
+		byte size = RuleProgram::getSize(op);
+		const byte* arg = code + pc + 1;
+
+		if (!size || pc + size > RuleProgram::CODE_SIZE)
+			return;
+		pc += size;
+
+		switch (op) {
+			case RuleProgram::END:
+				return;
+			case RuleProgram::IF_TIME:
+				if (!inWindow(minuteOf(now), RuleProgram::getWord(arg), 
+						RuleProgram::getWord(arg + 2)))
+					return;
+				break;
+			case RuleProgram::IF_DAYS: {
+				Week_t w;
+				w.days = arg[0];
+				if (!w.week.all && !(w.days & 1 << (now.getDayOfWeek() - 1)))
+					return;
+				break;
+			}
+			case RuleProgram::IF_ON:
+				if (!isOn(RuleProgram::getWord(arg)))
+					return;
+				break;
+			case RuleProgram::IF_OFF:
+				if (isOn(RuleProgram::getWord(arg)))
+					return;
+				break;
+			case RuleProgram::IF_ABOVE:
+				if (!isAbove(arg))
+					return;
+				break;
+			case RuleProgram::IF_BELOW:
+				if (isAbove(arg))
+					return;
+				break;
+			case RuleProgram::SWITCH_ON:
+			case RuleProgram::SWITCH_OFF:
+			case RuleProgram::TOGGLE:
+				action(RuleProgram::getWord(arg), op);
+				break;
+			case RuleProgram::WAIT:
+				suspend(prog, pc, RuleProgram::getWord(arg) * 1000UL);
+				return;
+			default:
+				break;	// triggers, matched by the caller
+		}
+	}
+}
+
+unsigned long RuleEngine::getRuns() const
+{
+	return runs;
+}
+
+unsigned long RuleEngine::getDropped() const
+{
+	return dropped;
+}
+
+byte RuleEngine::getPending() const
+{
+	byte n = 0;
+	for (byte i = 0; i < count; i++) {
+		if (timer[i] != NONE)
+			n++;
+	}
+	return n;
+}
@@ -0,0 +1,80 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include "Arduino.h"
+#include "DateTime.h"
+#include "RuleProgram.h"
+#include "Switch.h"
+#include "TimerWheel.h"
+
+
+// Runs RuleProgram bytecode. Triggers are matched on the first op only,
+// so an rf code that no program listens to costs one compare per
+// program. A program suspended by WAIT is a timer on the wheel, its
+// data (TIMER_TAG, program, pc) is handed back to resume().
+class RuleEngine {
+public:
+	static const byte MAX_PROGRAMS = 32;
+	static const byte NONE = 255;
+	// set in the data of the timers armed by WAIT
+	static const uint16_t TIMER_TAG = 0x8000;
+
+	typedef bool (*SwitchState)(switch_id_t);
+	typedef float (*SensorValue)(byte);
+	// switch id and SWITCH_ON, SWITCH_OFF or TOGGLE
+	typedef void (*SwitchAction)(switch_id_t, byte);
+private:
+	const RuleProgram* programs;
+	byte count;
+	TimerWheel& timers;
+	SwitchState isOn;
+	SensorValue sensor;
+	SwitchAction action;
+
+	byte timer[MAX_PROGRAMS];	// wheel handle of a waiting program
+	unsigned long level;	// last state of the sensor triggers
+	unsigned long known;
+	uint16_t lastMinute;
+	unsigned long runs;
+	unsigned long dropped;
+
+	void run(byte, byte, const DateTime&);
+	bool suspend(byte, byte, unsigned long);
+	bool isAbove(const byte*);
+public:
+	RuleEngine(TimerWheel&, SwitchState, SensorValue, SwitchAction);
+
+	void begin(const RuleProgram*, byte);
+
+	void onCode(unsigned long, const DateTime&);
+	// time and sensor triggers, once a minute
+	void onMinute(const DateTime&);
+	// a WAIT timer fired
+	void resume(uint16_t, const DateTime&);
+	// drops pending waits of a program, e.g. after it was changed
+	void cancel(byte);
+
+	unsigned long getRuns() const;
+	unsigned long getDropped() const;
+	byte getPending() const;
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RuleProgram.h"
+#include "NamePool.h"
+#include "Util.h"
+
+
+namespace {
+	// operand bytes of each op
+	const byte OPERANDS[RuleProgram::OPS] = {
+		0, 4, 2, 3, 3, 4, 1, 2, 2, 3, 3, 2, 2, 2, 2
+	};
+
+	size_t printMinute(Print& p, uint16_t m)
+	{
+		size_t n = 0;
+		byte h = m / 60;
+		m %= 60;
+		if (h < 10)
+			n += p.print('0');
+		n += p.print(h);
+		n += p.print(':');
+		if (m < 10)
+			n += p.print('0');
+		return n + p.print(m);
+	}
+
+	size_t printLevel(Print& p, const byte* arg, char cmp)
+	{
+		size_t n = p.print(F("sensor "));
+		n += p.print(arg[0]);
+		n += p.print(' ');
+		n += p.print(cmp);
+		n += p.print(' ');
+		return n + p.print(int16_t(RuleProgram::getWord(arg + 1)) / 10.0, 1);
+	}
+}
+
+STATIC_ASSERT(sizeof(RuleProgram) == 32, rule_program_size);
+
+
+RuleProgram::RuleProgram():
+	active(0), nameId(NamePool::NONE)
+{
+	memset(code, END, sizeof(code));
+}
+
+const byte* RuleProgram::getCode() const
+{
+	return code;
+}
+
+void RuleProgram::setCode(const byte* c, byte len)
+{
+	if (len > CODE_SIZE)
+		len = CODE_SIZE;
+	memcpy(code, c, len);
+	memset(code + len, END, CODE_SIZE - len);
+}
+
+byte RuleProgram::getTrigger() const
+{
+	return code[0];
+}
+
+bool RuleProgram::isActive() const
+{
+	return active;
+}
+
+void RuleProgram::setActive(bool act)
+{
+	active = act;
+}
+
+void RuleProgram::setNameId(byte id)
+{
+	nameId = id;
+}
+
+byte RuleProgram::getNameId() const
+{
+	return nameId;
+}
+
+byte RuleProgram::getSize(byte op)
+{
+	return op < OPS ? OPERANDS[op] + 1 : 0;
+}
+
+
+RuleText::RuleText(const RuleProgram& prog):
+	code(prog.getCode())
+{}
+
+size_t RuleText::printTo(Print& p) const
+{
+	size_t n = 0;
+	byte pc = 0;
+
+	while (pc < RuleProgram::CODE_SIZE && code[pc] != RuleProgram::END) {
+		byte op = code[pc];
+		byte size = RuleProgram::getSize(op);
+		const byte* arg = code + pc + 1;
+
+		if (!size || pc + size > RuleProgram::CODE_SIZE)
+			return n + p.print('?');
+		if (pc)
+			n += p.print(F("; "));
+		pc += size;
+
+		switch (op) {
+			case RuleProgram::ON_RF:
+				n += p.print(F("rf "));
+				n += p.print(RuleProgram::getLong(arg));
+				break;
+			case RuleProgram::ON_TIME:
+				n += p.print(F("at "));
+				n += printMinute(p, RuleProgram::getWord(arg));
+				break;
+			case RuleProgram::ON_ABOVE:
+				n += printLevel(p, arg, '>');
+				break;
+			case RuleProgram::ON_BELOW:
+				n += printLevel(p, arg, '<');
+				break;
+			case RuleProgram::IF_TIME:
+				n += p.print(F("if "));
+				n += printMinute(p, RuleProgram::getWord(arg));
+				n += p.print('-');
+				n += printMinute(p, RuleProgram::getWord(arg + 2));
+				break;
+			case RuleProgram::IF_DAYS:
+				n += p.print(F("if days "));
+				n += p.print(arg[0]);
+				break;
+			case RuleProgram::IF_ON:
+			case RuleProgram::IF_OFF:
+				n += p.print(F("if "));
+				n += p.print(RuleProgram::getWord(arg));
+				n += p.print(op == RuleProgram::IF_ON ? F(" on") : F(" off"));
+				break;
+			case RuleProgram::IF_ABOVE:
+				n += p.print(F("if "));
+				n += printLevel(p, arg, '>');
+				break;
+			case RuleProgram::IF_BELOW:
+				n += p.print(F("if "));
+				n += printLevel(p, arg, '<');
+				break;
+			case RuleProgram::SWITCH_ON:
+				n += p.print(F("on "));
+				n += p.print(RuleProgram::getWord(arg));
+				break;
+			case RuleProgram::SWITCH_OFF:
+				n += p.print(F("off "));
+				n += p.print(RuleProgram::getWord(arg));
+				break;
+			case RuleProgram::TOGGLE:
+				n += p.print(F("toggle "));
+				n += p.print(RuleProgram::getWord(arg));
+				break;
+			case RuleProgram::WAIT:
+				n += p.print(F("wait "));
+				n += p.print(RuleProgram::getWord(arg));
+				break;
+		}
+	}
+	return n;
+}
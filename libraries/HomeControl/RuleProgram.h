@@ -0,0 +1,94 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RULE_PROGRAM_H
+#define RULE_PROGRAM_H
+
+#include "Arduino.h"
+#include "Printable.h"
+
+
+// A rule compiled to bytecode. The first op is the trigger, the ones
+// after it are conditions and actions run in order. A condition that
+// does not hold ends the program, WAIT suspends it in the RuleEngine
+// and conditions after a WAIT are checked again when it resumes.
+// Operands follow their op, multi byte ones lsb first.
+class RuleProgram {
+public:
+	static const byte CODE_SIZE = 30;
+
+	enum Op {
+		END,
+		ON_RF,			// u32 RfCode::getId()
+		ON_TIME,		// u16 minute of the day
+		ON_ABOVE,		// sensor, i16 threshold in 1/10 units
+		ON_BELOW,
+		IF_TIME,		// u16 from, u16 until, minutes of the day
+		IF_DAYS,		// Week_t
+		IF_ON,			// u16 switch
+		IF_OFF,
+		IF_ABOVE,		// sensor, i16 threshold in 1/10 units
+		IF_BELOW,
+		SWITCH_ON,		// u16 switch
+		SWITCH_OFF,
+		TOGGLE,
+		WAIT,			// u16 seconds
+		OPS
+	};
+private:
+	byte code[CODE_SIZE];
+	byte active;
+	byte nameId;	// slot in NamePool
+public:
+	RuleProgram();
+
+	const byte* getCode() const;
+	void setCode(const byte*, byte);
+	byte getTrigger() const;
+
+	bool isActive() const;
+	void setActive(bool);
+
+	void setNameId(byte);
+	byte getNameId() const;
+
+	// size of an op with its operands, 0 if op is not valid
+	static byte getSize(byte op);
+	static uint16_t getWord(const byte*);
+	static unsigned long getLong(const byte*);
+};
+
+// the program as text, e.g. "rf 1234; if 18:00-23:00; on 1; wait 600; off 1"
+class RuleText : public Printable {
+	const byte* code;
+public:
+	RuleText(const RuleProgram&);
+	size_t printTo(Print&) const;
+};
+
+inline uint16_t RuleProgram::getWord(const byte* p)
+{
+	return uint16_t(p[0]) | uint16_t(p[1]) << 8;
+}
+
+inline unsigned long RuleProgram::getLong(const byte* p)
+{
+	return getWord(p) | (unsigned long)getWord(p + 2) << 16;
+}
+
+#endif
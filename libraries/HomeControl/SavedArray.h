@@ -20,12 +20,17 @@
 #define SAVED_ARRAY_H
 
 #include "Arduino.h"
-#include <avr/eeprom.h>
+#include "Storage.h"
 
 
-template<class T, byte sz> class SavedArray {
+template<class T, uint16_t sz, class S = DefaultStorage> class SavedArray {
 	void* eeprom;
 	T data[sz];
+
+#ifndef __AVR__
+	// stored as bytes, a vptr or pointer would be stale after a restart
+	STATIC_ASSERT(__is_trivially_copyable(T), saved_as_bytes);
+#endif
 public:
 	SavedArray(void*);
 	~SavedArray();
@@ -34,59 +39,69 @@ public:
 	void load();
 	
 	T& instance();
-	byte getSize() const;
+	uint16_t getSize() const;
 	
-	const T& operator[](byte) const;
-	T& operator[](byte);
+	const T& operator[](uint16_t) const;
+	T& operator[](uint16_t);
+
+#ifndef __AVR__
+	// the saved elements in place, without a load(), for storage that 
+	// is mapped. A save() shows at once, unsaved changes do not.
+	const T* view() const;
+#endif
 };
 
-template<class T, byte sz>
-SavedArray<T, sz>::SavedArray(void* ee):
+template<class T, uint16_t sz, class S>
+SavedArray<T, sz, S>::SavedArray(void* ee):
 	eeprom(ee)
 {}
 
-template<class T, byte sz>
-SavedArray<T, sz>::~SavedArray()
+template<class T, uint16_t sz, class S>
+SavedArray<T, sz, S>::~SavedArray()
 {}
 
-template<class T, byte sz>
-T& SavedArray<T, sz>::instance()
+template<class T, uint16_t sz, class S>
+T& SavedArray<T, sz, S>::instance()
 {
 	return data[0];
 }
 
-template<class T, byte sz>
-const T& SavedArray<T, sz>::operator[](byte i) const
+template<class T, uint16_t sz, class S>
+const T& SavedArray<T, sz, S>::operator[](uint16_t i) const
 {
 	return data[i];
 }
 
-template<class T, byte sz>
-T& SavedArray<T, sz>::operator[](byte i)
+template<class T, uint16_t sz, class S>
+T& SavedArray<T, sz, S>::operator[](uint16_t i)
 {
 	return data[i];
 }
 
-template<class T, byte sz>
-byte SavedArray<T, sz>::getSize() const
+template<class T, uint16_t sz, class S>
+uint16_t SavedArray<T, sz, S>::getSize() const
 {
 	return sz;
 }
 
-template<class T, byte sz>
-void SavedArray<T, sz>::save()
+template<class T, uint16_t sz, class S>
+void SavedArray<T, sz, S>::save()
 {
-#if GCC_VERSION >= 40600
-	eeprom_update_block(data, eeprom, sizeof(T)*sz);
-#else
-	eeprom_write_block(data, eeprom, sizeof(T)*sz);
-#endif
+	S::write(data, eeprom, sizeof(T)*sz);
 }
 
-template<class T, byte sz>
-void SavedArray<T, sz>::load()
+template<class T, uint16_t sz, class S>
+void SavedArray<T, sz, S>::load()
 {
-	eeprom_read_block(data, eeprom, sizeof(T)*sz);	
+	S::read(data, eeprom, sizeof(T)*sz);	
 }
 
-#endif
\ No newline at end of file
+#ifndef __AVR__
+template<class T, uint16_t sz, class S>
+const T* SavedArray<T, sz, S>::view() const
+{
+	return static_cast<const T*>(S::view(eeprom, sizeof(T)*sz, __alignof__(T)));
+}
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Scene.h"
+#include "NamePool.h"
+#include "Util.h"
+
+
+STATIC_ASSERT(sizeof(Scene) <= sizeof(SwitchBatch) + 2, scene_size);
+
+
+Scene::Scene():
+	nameId(NamePool::NONE)
+{}
+
+const SwitchBatch& Scene::getBatch() const
+{
+	return batch;
+}
+
+void Scene::setBatch(const SwitchBatch& b)
+{
+	batch = b;
+}
+
+bool Scene::isActive() const
+{
+	return !batch.isEmpty();
+}
+
+void Scene::setNameId(byte id)
+{
+	nameId = id;
+}
+
+byte Scene::getNameId() const
+{
+	return nameId;
+}
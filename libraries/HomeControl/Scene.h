@@ -0,0 +1,43 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "Arduino.h"
+#include "SwitchBatch.h"
+
+
+// A stored SwitchBatch with a name, applied from the web, by event
+// rules and by schedules. An empty scene is unused.
+class Scene {
+	SwitchBatch batch;
+	byte nameId;		// slot in NamePool
+public:
+	Scene();
+
+	const SwitchBatch& getBatch() const;
+	void setBatch(const SwitchBatch&);
+
+	bool isActive() const;
+
+	void setNameId(byte);
+	byte getNameId() const;
+};
+
+#endif
@@ -17,19 +17,30 @@
 */
 
 #include "Schedule.h"
+#include "NamePool.h"
+#include "Util.h"
+
+
+namespace {
+	const time_t SECS_PER_MIN 	= 60;
+	const time_t SECS_PER_DAY 	= 86400;
+	const int THRESHOLD_SCALE	= 10;
+}
+
+STATIC_ASSERT(sizeof(Schedule) <= 14, schedule_size);
 
 
 Schedule::Schedule():
-	time(0), duration(0), on(0), active(0),
-	switchId(255), sensorId(255), threshold(100)
+	day(0), minute(0), on(0), active(0), duration(0),
+	threshold(100 * THRESHOLD_SCALE), switchId(Switch::NONE),
+	sensorId(255), nameId(NamePool::NONE)
 {
 	w.days = 0;
-	memcpy(name, 0, sizeof(name));
 }
 
 time_t Schedule::getTime() const
 {
-	return time;
+	return day * SECS_PER_DAY + minute * SECS_PER_MIN;
 }
 
 Week_t Schedule::getDays() const
@@ -39,12 +50,13 @@ Week_t Schedule::getDays() const
 
 time_t Schedule::getDuration() const
 {
-	return duration;
+	return duration * SECS_PER_MIN;
 }
 
 void Schedule::setTime(time_t _time)
 {
-	time = _time;
+	day = _time / SECS_PER_DAY;
+	minute = (_time % SECS_PER_DAY) / SECS_PER_MIN;
 }
 
 void Schedule::setDays(Week_t _w)
@@ -54,10 +66,11 @@ void Schedule::setDays(Week_t _w)
 
 void Schedule::setDuration(time_t d)
 {
-	duration = d;
+	d /= SECS_PER_MIN;
+	duration = d > 0xFFFF ? 0xFFFF : d;
 }
 
-void Schedule::setSwitchId(byte id)
+void Schedule::setSwitchId(switch_id_t id)
 {
 	switchId = id;
 }
@@ -67,7 +80,7 @@ void Schedule::setSensorId(byte id)
 	sensorId = id;
 }
 
-byte Schedule::getSwitchId() const
+switch_id_t Schedule::getSwitchId() const
 {
 	return switchId;
 }
@@ -79,12 +92,20 @@ byte Schedule::getSensorId() const
 
 float Schedule::getThreshold() const
 {
-	return threshold;
+	return float(threshold) / THRESHOLD_SCALE;
 }
 
 void Schedule::setThreshold(float th)
 {
-	threshold = th;
+	th *= THRESHOLD_SCALE;
+	th += th < 0 ? -0.5 : 0.5;
+
+	if (th > 32767)
+		threshold = 32767;
+	else if (th < -32767)
+		threshold = -32767;
+	else
+		threshold = th;
 }
 
 bool Schedule::turnOn() const
@@ -107,13 +128,12 @@ void Schedule::setActive(bool act)
 	active = act;
 }
 
-void Schedule::setName(const char* _name)
+void Schedule::setNameId(byte id)
 {
-	strncpy(name, _name, sizeof(name));
-	name[SCHEDULE_NAME_SIZE] = '\0';
+	nameId = id;
 }
 
-const char* Schedule::getName() const
+byte Schedule::getNameId() const
 {
-	return name;	
+	return nameId;
 }
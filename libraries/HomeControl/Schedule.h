@@ -21,23 +21,21 @@
 
 #include "Arduino.h"
 #include "DateTime.h"
-
-const int SCHEDULE_NAME_SIZE = 10;
+#include "Switch.h"
 
 
 class Schedule {
-	time_t time; 
-	time_t duration;
+	uint16_t day;			// days since 1970 of the first run
+	uint16_t minute : 11;	// minute of the day
+	uint16_t on 	: 1;
+	uint16_t active : 1;
+	uint16_t duration;		// minutes
+	int16_t threshold;		// fixed point, 1/10 units
+	switch_id_t switchId;	// switch or scene target
 	Week_t w;
 
-	bool on 	: 1;
-	bool active : 1;
-
-	byte switchId;
 	byte sensorId;
-	float threshold;
-	
-	char name[SCHEDULE_NAME_SIZE+1];
+	byte nameId;			// slot in NamePool
 public:
 	Schedule();
 	
@@ -49,10 +47,10 @@ public:
 	void setDays(Week_t);
 	void setDuration(time_t);
 	
-	void setSwitchId(byte);
+	void setSwitchId(switch_id_t);
 	void setSensorId(byte);
 	
-	byte getSwitchId() const;
+	switch_id_t getSwitchId() const;
 	byte getSensorId() const;
 
 	float getThreshold() const;
@@ -64,8 +62,8 @@ public:
 	bool isActive() const;
 	void setActive(bool);
 	
-	void setName(const char*);
-	const char* getName() const;
+	void setNameId(byte);
+	byte getNameId() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SendTracker.h"
+
+
+SendTracker::SendTracker(byte repeat):
+	waits(0)
+{
+	memset(entry, 0, sizeof(entry));
+	for (switch_id_t i = 0; i < MAX; i++) {
+		entry[i].repeat = repeat;
+		entry[i].needed = STREAK;
+	}
+}
+
+byte SendTracker::getRepeat(switch_id_t id) const
+{
+	return entry[id].repeat;
+}
+
+const SendTracker::Stats& SendTracker::getStats(switch_id_t id) const
+{
+	return entry[id].stats;
+}
+
+void SendTracker::sent(switch_id_t id, bool on, byte bursts, bool watched, unsigned long now)
+{
+	Entry& e = entry[id];
+
+	e.stats.bursts += bursts;
+	// a resend is not a new command
+	if (e.attempts && e.on == on && watched) {
+		e.deadline = now + WINDOW;
+		return;
+	}
+	e.stats.commands++;
+	if (e.attempts && !watched)
+		done(id);
+	else if (!e.attempts && watched)
+		waiting[waits++] = id;
+	e.attempts = watched;
+	e.on = on;
+	e.deadline = now + WINDOW;
+}
+
+bool SendTracker::confirm(switch_id_t id, bool on)
+{
+	Entry& e = entry[id];
+
+	if (!e.attempts || e.on != on)
+		return false;
+
+	e.stats.confirmed++;
+	if (e.attempts == 1) {
+		if (e.probing)
+			e.needed = max(e.needed / 2, STREAK);
+		e.probing = false;
+		if (++e.streak >= e.needed && e.repeat > MIN_REPEAT) {
+			e.repeat--;
+			e.probing = true;
+			e.streak = 0;
+		}
+	}
+	e.attempts = 0;
+	done(id);
+	return true;
+}
+
+bool SendTracker::isPending(switch_id_t id) const
+{
+	return entry[id].attempts;
+}
+
+bool SendTracker::due(switch_id_t& id, bool& on, unsigned long now) const
+{
+	for (switch_id_t i = 0; i < waits; i++) {
+		const Entry& e = entry[waiting[i]];
+		if (long(now - e.deadline) >= 0) {
+			id = waiting[i];
+			on = e.on;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SendTracker::retry(switch_id_t id)
+{
+	Entry& e = entry[id];
+
+	if (e.probing)
+		e.needed = min(e.needed * 2, MAX_STREAK);
+	e.probing = false;
+	e.streak = 0;
+	if (e.repeat < MAX_REPEAT)
+		e.repeat++;
+	if (e.attempts >= MAX_ATTEMPTS) {
+		e.stats.failed++;
+		e.attempts = 0;
+		done(id);
+		return false;
+	}
+	e.stats.retries++;
+	e.attempts++;
+	return true;
+}
+
+// drops id from the waiting list, a short one
+void SendTracker::done(switch_id_t id)
+{
+	for (switch_id_t i = 0; i < waits; i++) {
+		if (waiting[i] == id) {
+			waiting[i] = waiting[--waits];
+			return;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEND_TRACKER_H
+#define SEND_TRACKER_H
+
+#include "Arduino.h"
+#include "Switch.h"
+
+
+// Number of bursts to send per switch, learned from feedback. A switch
+// with feedback waits for it after each command: confirmed on the first
+// try a few times in a row it gets one burst less, a retry gets it one
+// more. Each failed try with one less doubles the confirmations needed
+// for the next one. Switches without feedback keep the initial number.
+class SendTracker {
+public:
+	static const switch_id_t MAX = Switch::MAX;
+	static const byte MIN_REPEAT = 1;
+	static const byte MAX_REPEAT = 8;
+	static const byte MAX_ATTEMPTS = 3;		// sends of one command
+	static const byte STREAK = 4;			// confirmations until one less
+	static const byte MAX_STREAK = 64;
+	static const unsigned long WINDOW = 2000;	// ms to wait for feedback
+
+	// counters wrap at 16 bits
+	struct Stats {
+		uint16_t commands;
+		uint16_t bursts;
+		uint16_t confirmed;
+		uint16_t retries;
+		uint16_t failed;
+	};
+private:
+	struct Entry {
+		Stats stats;
+		unsigned long deadline;
+		byte repeat	: 4;
+		byte attempts : 2;	// of the pending command, 0 if none
+		byte on		: 1;
+		byte probing : 1;	// first command after one less
+		byte streak;
+		byte needed;		// streak for one less
+	};
+
+	Entry entry[MAX];
+	switch_id_t waiting[MAX];	// ids with a pending command
+	switch_id_t waits;
+
+	void done(switch_id_t id);
+public:
+	SendTracker(byte repeat);
+
+	byte getRepeat(switch_id_t id) const;
+	const Stats& getStats(switch_id_t id) const;
+
+	// bursts went out for a command, if watched feedback is expected
+	void sent(switch_id_t id, bool on, byte bursts, bool watched, unsigned long now);
+	// feedback says switch id is on or off, true if a command waited 
+	// for it
+	bool confirm(switch_id_t id, bool on);
+	// a command waits for feedback
+	bool isPending(switch_id_t id) const;
+	// a command whose window passed without feedback
+	bool due(switch_id_t& id, bool& on, unsigned long now) const;
+	// gives up on it after MAX_ATTEMPTS and returns false, otherwise it
+	// is to be sent again with one more burst
+	bool retry(switch_id_t id);
+};
+
+#endif
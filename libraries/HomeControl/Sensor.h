@@ -28,7 +28,12 @@ protected:
 public:
 	static const int ERROR;
 	
-	~Sensor();
+	virtual ~Sensor();
+
+	// sensors are built in static storage only (see Arena),
+	// these hide the global heap operators
+	void* operator new(size_t, void* p) throw() { return p; }
+	void operator delete(void*) {}
 	
 	virtual float read() = 0;
 	virtual const char* getName() const = 0;
@@ -0,0 +1,180 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Session.h"
+
+
+namespace {
+
+	int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		return -1;
+	}
+
+	// entries are cleared to 0, which is never a live expiry here
+	inline bool isLive(unsigned long expiry, unsigned long now)
+	{
+		return expiry && (long)(expiry - now) > 0;
+	}
+
+	inline unsigned long getLong(const byte* p)
+	{
+		return (unsigned long)p[0] << 24 | (unsigned long)p[1] << 16 | 
+			(unsigned long)p[2] << 8 | p[3];
+	}
+
+	inline uint16_t getWord(const byte* p)
+	{
+		return uint16_t(p[0]) << 8 | p[1];
+	}
+}
+
+const char* const Session::COOKIE = "hcs";
+
+Session::Session():
+	serial(0), minSerial(0)
+{
+	memset(revoked, 0, sizeof(revoked));
+	memset(&inner, 0, sizeof(inner));
+	memset(&outer, 0, sizeof(outer));
+}
+
+void Session::begin(const byte* passwDigest, unsigned long seed)
+{
+	byte key[Sha256::BLOCK];
+	Sha256 sha;
+	unsigned long t = micros();
+
+	sha.update(passwDigest, Sha256::SIZE);
+	sha.update(&seed, sizeof(seed));
+	sha.update(&t, sizeof(t));
+	memset(key, 0, sizeof(key));
+	sha.finish(key);
+
+	for (byte i = 0; i < Sha256::BLOCK; i++)
+		key[i] ^= 0x36;
+	sha.reset();
+	sha.update(key, sizeof(key));
+	sha.save(inner);
+
+	for (byte i = 0; i < Sha256::BLOCK; i++)
+		key[i] ^= 0x36 ^ 0x5c;
+	sha.reset();
+	sha.update(key, sizeof(key));
+	sha.save(outer);
+
+	memset(key, 0, sizeof(key));
+	memset(revoked, 0, sizeof(revoked));
+	minSerial = serial;
+}
+
+void Session::sign(const byte* data, byte* mac) const
+{
+	byte hash[Sha256::SIZE];
+	Sha256 sha;
+
+	sha.restore(inner);
+	sha.update(data, DATA_SIZE);
+	sha.finish(hash);
+	sha.restore(outer);
+	sha.update(hash, sizeof(hash));
+	sha.finish(hash);
+	memcpy(mac, hash, MAC_SIZE);
+}
+
+void Session::issue(char* token)
+{
+	byte raw[RAW_SIZE];
+	unsigned long expiry = millis() + TTL;
+
+	raw[0] = expiry >> 24;
+	raw[1] = expiry >> 16;
+	raw[2] = expiry >> 8;
+	raw[3] = expiry;
+	raw[4] = serial >> 8;
+	raw[5] = serial;
+	serial++;
+	sign(raw, raw + DATA_SIZE);
+
+	for (byte i = 0; i < RAW_SIZE; i++) {
+		*token++ = "0123456789abcdef"[raw[i] >> 4];
+		*token++ = "0123456789abcdef"[raw[i] & 15];
+	}
+	*token = '\0';
+}
+
+// signature and expiry, raw gets the decoded token
+bool Session::check(const char* token, byte* raw) const
+{
+	for (byte i = 0; i < RAW_SIZE; i++) {
+		int hi = hexValue(token[2*i]);
+		int lo = hexValue(token[2*i+1]);
+		if (hi < 0 || lo < 0)
+			return false;
+		raw[i] = hi << 4 | lo;
+	}
+
+	byte mac[MAC_SIZE];
+	sign(raw, mac);
+	if (!Sha256::equals(mac, raw + DATA_SIZE, MAC_SIZE))
+		return false;
+
+	unsigned long left = getLong(raw) - millis();
+	return left != 0 && left <= TTL;
+}
+
+bool Session::verify(const char* token) const
+{
+	byte raw[RAW_SIZE];
+
+	if (!check(token, raw))
+		return false;
+
+	uint16_t s = getWord(raw + 4);
+	if ((int16_t)(s - minSerial) < 0)
+		return false;
+
+	unsigned long now = millis();
+	for (byte i = 0; i < REVOKED; i++) {
+		if (revoked[i].serial == s && isLive(revoked[i].expiry, now))
+			return false;
+	}
+	return true;
+}
+
+void Session::revoke(const char* token)
+{
+	byte raw[RAW_SIZE];
+
+	if (!check(token, raw))
+		return;
+
+	unsigned long now = millis();
+	for (byte i = 0; i < REVOKED; i++) {
+		if (!isLive(revoked[i].expiry, now)) {
+			revoked[i].serial = getWord(raw + 4);
+			revoked[i].expiry = getLong(raw);
+			return;
+		}
+	}
+	memset(revoked, 0, sizeof(revoked));
+	minSerial = serial;
+}
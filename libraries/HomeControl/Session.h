@@ -0,0 +1,67 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "Arduino.h"
+#include "Sha256.h"
+
+
+// Stateless login sessions. A token carries its expiry and a serial,
+// signed with HMAC-SHA-256 under a key drawn at begin(), so checking 
+// one costs two hash blocks and no lookup besides the revocation table.
+// Tokens do not survive a reboot or a password change.
+class Session {
+public:
+	static const byte TOKEN_SIZE = 28;				// hex characters
+	static const unsigned long TTL = 3600000UL;		// ms
+	static const byte REVOKED = 8;
+	static const char* const COOKIE;
+private:
+	static const byte RAW_SIZE = 14;	// expiry, serial, mac
+	static const byte DATA_SIZE = 6;
+	static const byte MAC_SIZE = 8;
+
+	struct Revoked {
+		uint16_t serial;
+		unsigned long expiry;	// millis(), free once passed
+	};
+
+	Sha256::Midstate inner;
+	Sha256::Midstate outer;
+	Revoked revoked[REVOKED];
+	uint16_t serial;	// next one issued
+	uint16_t minSerial;	// older ones are revoked
+
+	void sign(const byte* data, byte* mac) const;
+	bool check(const char* token, byte* raw) const;
+public:
+	Session();
+
+	// the key is derived from the password digest, so the seed only
+	// needs to differ between boots
+	void begin(const byte* passwDigest, unsigned long seed);
+
+	// writes TOKEN_SIZE characters and a terminating 0
+	void issue(char* token);
+	bool verify(const char* token) const;
+	// a full table revokes every session issued so far
+	void revoke(const char* token);
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SHA256_H
+#define SHA256_H
+
+#include "Arduino.h"
+
+
+// FIPS 180-4 SHA-256, fed incrementally. The message schedule is kept
+// as a rolling window of 16 words to spare the stack.
+class Sha256 {
+public:
+	static const byte SIZE = 32;	// digest bytes
+	static const byte BLOCK = 64;
+private:
+	uint32_t state[8];
+	uint32_t length;	// bytes so far
+	byte block[BLOCK];
+
+	void transform();
+public:
+	// chaining value after whole blocks, lets HMAC keep its padded keys
+	struct Midstate {
+		uint32_t h[8];
+	};
+
+	Sha256();
+
+	void reset();
+	void update(byte);
+	void update(const void*, size_t);
+	// writes SIZE bytes, call reset() before reuse
+	void finish(byte* digest);
+
+	// save() only after a multiple of BLOCK bytes, restore() continues
+	// as if one block had been hashed
+	void save(Midstate&) const;
+	void restore(const Midstate&);
+
+	// same length buffers, time does not depend on where they differ
+	static bool equals(const byte*, const byte*, byte size = SIZE);
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Arduino.h"
+
+
+// Single writer, many readers. The writer copies into a slot no reader
+// holds and then swaps the current index, so readers never wait for 
+// the writer and the writer never waits for readers. publish() returns
+// false if every other slot is still being read, the caller retries later.
+template<class T, byte n = 3> class Snapshot {
+	T slot[n];
+	volatile int readers[n];
+	volatile byte current;
+public:
+	Snapshot();
+
+	const T& acquire(byte&);
+	void release(byte);
+	bool publish(const T&);
+};
+
+template<class T, byte n>
+Snapshot<T, n>::Snapshot():
+	current(0)
+{
+	for (byte i = 0; i < n; i++)
+		readers[i] = 0;
+}
+
+template<class T, byte n>
+const T& Snapshot<T, n>::acquire(byte& i)
+{
+	for (;;) {
+		i = current;
+		__sync_fetch_and_add(&readers[i], 1);
+		// the writer may have reused the slot before we registered
+		if (current == i)
+			return slot[i];
+		__sync_fetch_and_sub(&readers[i], 1);
+	}
+}
+
+template<class T, byte n>
+void Snapshot<T, n>::release(byte i)
+{
+	__sync_fetch_and_sub(&readers[i], 1);
+}
+
+template<class T, byte n>
+bool Snapshot<T, n>::publish(const T& data)
+{
+	for (byte i = 0; i < n; i++) {
+		if (i == current || readers[i])
+			continue;
+		slot[i] = data;
+		__sync_synchronize();
+		current = i;
+		return true;
+	}
+	return false;
+}
+
+#endif
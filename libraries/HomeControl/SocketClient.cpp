@@ -0,0 +1,231 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __AVR__
+
+#include "SocketClient.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace {
+	const char HEADER_END[] = "\r\n\r\n";
+	const char CONTENT_LENGTH[] = "Content-Length:";
+
+	// length of the complete request or 0 if the header is not complete yet
+	size_t requestLength(const char* buf, size_t len)
+	{
+		const char* end = NULL;
+
+		for (size_t i = 0; i + 4 <= len; i++) {
+			if (memcmp(buf + i, HEADER_END, 4) == 0) {
+				end = buf + i + 4;
+				break;
+			}
+		}
+		if (!end)
+			return 0;
+
+		size_t body = 0;
+		const size_t n = sizeof(CONTENT_LENGTH) - 1;
+
+		for (const char* p = buf; p + n < end; p++) {
+			if (strncasecmp(p, CONTENT_LENGTH, n) == 0) {
+				body = strtoul(p + n, NULL, 10);
+				break;
+			}
+		}
+		return end - buf + body;
+	}
+}
+
+// the request is in memory, parsing must not wait for more
+SocketClient::SocketClient(int _fd):
+	fd(_fd), inLen(0), inPos(0), outLen(0)
+{
+	setTimeout(0);
+}
+
+SocketClient::~SocketClient()
+{
+	stop();
+}
+
+bool SocketClient::fill()
+{
+	if (fd < 0 || inLen == IN_SIZE)
+		return false;
+
+	ssize_t n = recv(fd, in + inLen, IN_SIZE - inLen, MSG_DONTWAIT);
+
+	if (n <= 0)
+		return false;
+
+	inLen += n;
+	return true;
+}
+
+// reads what the socket has ready without waiting. true once the header
+// and a Content-Length body are in, the buffer is full or the peer is gone.
+bool SocketClient::receive()
+{
+	while (inLen < IN_SIZE) {
+		size_t len = requestLength(in, inLen);
+
+		if (len && inLen >= len)
+			return true;
+
+		ssize_t n = recv(fd, in + inLen, IN_SIZE - inLen, MSG_DONTWAIT);
+
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+			return false;
+		if (n <= 0)
+			return true;
+		inLen += n;
+	}
+	return true;
+}
+
+void SocketClient::rewind()
+{
+	inPos = 0;
+}
+
+int SocketClient::getFd() const
+{
+	return fd;
+}
+
+uint32_t SocketClient::getRemoteAddress() const
+{
+	sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+
+	if (getpeername(fd, (sockaddr*)&addr, &len) != 0 || addr.sin_family != AF_INET)
+		return 0;
+	return addr.sin_addr.s_addr;
+}
+
+int SocketClient::connect(IPAddress, uint16_t)
+{
+	return 0;
+}
+
+int SocketClient::connect(const char*, uint16_t)
+{
+	return 0;
+}
+
+bool SocketClient::sendAll(const uint8_t* buf, size_t size)
+{
+	while (size && fd >= 0) {
+		ssize_t n = send(fd, buf, size, MSG_NOSIGNAL);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		buf += n;
+		size -= n;
+	}
+	return true;
+}
+
+size_t SocketClient::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t SocketClient::write(const uint8_t* buf, size_t size)
+{
+	if (outLen + size > OUT_SIZE) {
+		flush();
+		if (size > OUT_SIZE)
+			return sendAll(buf, size) ? size : 0;
+	}
+	memcpy(out + outLen, buf, size);
+	outLen += size;
+	return size;
+}
+
+int SocketClient::available()
+{
+	if (inPos == inLen)
+		fill();
+	return inLen - inPos;
+}
+
+int SocketClient::read()
+{
+	if (inPos == inLen && !fill())
+		return -1;
+	return (uint8_t)in[inPos++];
+}
+
+int SocketClient::read(uint8_t* buf, size_t size)
+{
+	if (inPos == inLen && !fill())
+		return -1;
+
+	size_t n = inLen - inPos < size ? inLen - inPos : size;
+	memcpy(buf, in + inPos, n);
+	inPos += n;
+	return n;
+}
+
+int SocketClient::peek()
+{
+	if (inPos == inLen && !fill())
+		return -1;
+	return (uint8_t)in[inPos];
+}
+
+void SocketClient::flush()
+{
+	if (outLen)
+		sendAll(out, outLen);
+	outLen = 0;
+}
+
+void SocketClient::stop()
+{
+	if (fd < 0)
+		return;
+
+	flush();
+	close(fd);
+	fd = -1;
+}
+
+uint8_t SocketClient::connected()
+{
+	return fd >= 0;
+}
+
+SocketClient::operator bool()
+{
+	return fd >= 0;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOCKET_CLIENT_H
+#define SOCKET_CLIENT_H
+
+#include "Client.h"
+
+
+// Client on top of a connected POSIX socket. The request is collected
+// with receive() before it is handled, so parsing never waits on the 
+// network and can be replayed with rewind() on another thread. Output
+// is buffered and sent in full segments.
+class SocketClient : public Client {
+	static const int IN_SIZE = 2048;
+	static const int OUT_SIZE = 1460;
+
+	int fd;
+	char in[IN_SIZE];
+	size_t inLen;
+	size_t inPos;
+	uint8_t out[OUT_SIZE];
+	size_t outLen;
+
+	bool fill();
+	bool sendAll(const uint8_t*, size_t);
+public:
+	SocketClient(int);
+	virtual ~SocketClient();
+
+	bool receive();
+	void rewind();
+	int getFd() const;
+	// IPv4 address of the peer in network order, 0 if there is none
+	uint32_t getRemoteAddress() const;
+
+	virtual int connect(IPAddress, uint16_t);
+	virtual int connect(const char*, uint16_t);
+	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t*, size_t);
+	virtual int available();
+	virtual int read();
+	virtual int read(uint8_t*, size_t);
+	virtual int peek();
+	virtual void flush();
+	virtual void stop();
+	virtual uint8_t connected();
+	virtual operator bool();
+
+	using Print::write;
+};
+
+#endif
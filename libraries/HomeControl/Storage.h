@@ -0,0 +1,65 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "Arduino.h"
+#include "Util.h"
+
+#ifdef __AVR__
+#include <avr/eeprom.h>
+#else
+#include "MappedStorage.h"
+#endif
+
+
+// Backend for arrays that are never persisted, e.g. snapshot copies.
+struct RamStorage {
+	static void read(void*, const void*, size_t) {}
+	static void write(const void*, void*, size_t) {}
+};
+
+#ifdef __AVR__
+
+// Backend for SavedArray, addresses are EEMEM locations.
+struct EepromStorage {
+	static void read(void* data, const void* addr, size_t size)
+	{
+		eeprom_read_block(data, addr, size);
+	}
+
+	static void write(const void* data, void* addr, size_t size)
+	{
+#if GCC_VERSION >= 40600
+		eeprom_update_block(data, addr, size);
+#else
+		eeprom_write_block(data, addr, size);
+#endif
+	}
+};
+
+typedef EepromStorage DefaultStorage;
+
+#else
+
+typedef MappedStorage DefaultStorage;
+
+#endif
+
+#endif
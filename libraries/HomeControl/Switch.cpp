@@ -18,37 +18,95 @@
 
 #include "Switch.h"
 #include "Arduino.h"
+#include "NamePool.h"
+#include "Util.h"
 
 
-const int MAX_SIZE = 6;
-char group_buf[MAX_SIZE] = {0};
-char device_buf[MAX_SIZE] = {0};
+namespace {
+
+// tri-state symbols as sent by RCSwitch, '0' = 00, 'F' = 01
+const uint32_t TRI_F = 1;
+// a closed DIP switch sends '0', an open one 'F'
+const uint32_t ALL_OPEN = 0x55555;
+// the address is followed by '0F' for on and 'F0' for off
+const uint32_t CODE_ON = 0x1;
+const uint32_t CODE_OFF = 0x4;
+
+const byte GROUP_SHIFT = 10;
+const byte DEVICE_SHIFT = 0;
+
+}
+
+// 5 bytes on the board, the host pads to 6
+STATIC_ASSERT(sizeof(Switch) <= 6, switch_size);
+
+
+DipSwitch::DipSwitch(byte _bits):
+	bits(_bits)
+{}
+
+size_t DipSwitch::printTo(Print& p) const
+{
+	char buf[5];
+	for (byte i = 0; i < 5; i++)
+		buf[i] = bitRead(bits, i) ? '1' : '0';
+	return p.write((const uint8_t*)buf, sizeof(buf));
+}
 
 
 Switch::Switch()
-	:group(0), device(0), id(0), on(0), pin(0), active(0), scheduled(0)
+	:code(0), codeHigh(0), on(0), pin(0), active(0), scheduled(0),
+	id(0), nameId(NamePool::NONE)
 {
-	memcpy(name, 0, sizeof(name));
+	setAddress(ALL_OPEN);
 }
 
-void Switch::setGroup(const char* grp)
+uint32_t Switch::getAddress() const
+{
+	return code | uint32_t(codeHigh) << 16;
+}
+
+void Switch::setAddress(uint32_t addr)
+{
+	code = addr;
+	codeHigh = addr >> 16;
+}
+
+// DIP switch i of a block takes bits shift+9-2i and shift+8-2i
+void Switch::setDip(const char* dip, byte shift)
 {
-	group = 0;
+	uint32_t addr = getAddress();
 
-	for (int i = 0; i < 5; i++) {
-		if (grp[i] == '1')
-			bitSet(group, i);
+	for (byte i = 0; i < 5; i++) {
+		uint32_t bit = TRI_F << (shift + 8 - 2*i);
+		if (dip[i] == '1')
+			addr &= ~bit;
+		else
+			addr |= bit;
 	}
+	setAddress(addr);
 }
 
-void Switch::setDevice(const char* dev)
+byte Switch::getDip(byte shift) const
 {
-	device = 0;
+	uint32_t addr = getAddress();
+	byte bits = 0;
 
-	for (int i = 0; i < 5; i++) {
-		if (dev[i] == '1')
-			bitSet(device, i);
+	for (byte i = 0; i < 5; i++) {
+		if (!(addr & TRI_F << (shift + 8 - 2*i)))
+			bitSet(bits, i);
 	}
+	return bits;
+}
+
+void Switch::setGroup(const char* grp)
+{
+	setDip(grp, GROUP_SHIFT);
+}
+
+void Switch::setDevice(const char* dev)
+{
+	setDip(dev, DEVICE_SHIFT);
 }
 
 void Switch::setId(byte _id)
@@ -56,28 +114,19 @@ void Switch::setId(byte _id)
 	id = _id;
 }
 
-char* Switch::getGroup() const
+DipSwitch Switch::getGroup() const
 {
-	for (int i = 0; i < 5; i++) {
-		if (bitRead(group, i))
-			group_buf[i] = '1';
-		else
-			group_buf[i] = '0';
-	}
-	group_buf[5] = '\0';
-	return group_buf;
+	return DipSwitch(getDip(GROUP_SHIFT));
 }
 
-char* Switch::getDevice() const
+DipSwitch Switch::getDevice() const
 {
-	for (int i = 0; i < 5; i++) {
-		if (bitRead(device, i))
-			device_buf[i] = '1';
-		else
-			device_buf[i] = '0';
-	}
-	device_buf[5] = '\0';
-	return device_buf;
+	return DipSwitch(getDip(DEVICE_SHIFT));
+}
+
+uint32_t Switch::getCode(bool _on) const
+{
+	return getAddress() << 4 | (_on ? CODE_ON : CODE_OFF);
 }
 
 byte Switch::getId() const
@@ -125,13 +174,12 @@ void Switch::setActive(bool act)
 	active = act;
 }
 
-void Switch::setName(const char* _name)
+void Switch::setNameId(byte _id)
 {
-	strncpy(name, _name, sizeof(name));
-	name[SWITCH_NAME_SIZE] = '\0';
+	nameId = _id;
 }
 
-const char* Switch::getName() const
+byte Switch::getNameId() const
 {
-	return name;	
+	return nameId;
 }
@@ -21,31 +21,59 @@
 
 
 #include "Arduino.h"
+#include "Printable.h"
 
 
-const int SWITCH_NAME_SIZE = 10;
+// switch ids, also in event rules, schedules and rule programs
+typedef uint16_t switch_id_t;
+
+// the 5 DIP switches of a group or device, printed as "01101"
+class DipSwitch : public Printable {
+	byte bits;	// bit 0 is the leftmost switch
+public:
+	DipSwitch(byte);
+	size_t printTo(Print&) const;
+};
 
 class Switch {
- 	unsigned int group : 5;
- 	unsigned int device : 5;
-	bool on : 1;
-	bool pin : 1;
-	bool active : 1;
-	bool scheduled : 1;
-
-	byte id;
-	char name[SWITCH_NAME_SIZE+1];
+	// tri-state address of group and device, 2 bits per DIP switch,
+	// kept ready to send so switching does no string work
+	uint16_t code;
+	uint16_t codeHigh : 4;
+	uint16_t on : 1;
+	uint16_t pin : 1;
+	uint16_t active : 1;
+	uint16_t scheduled : 1;
+	uint16_t id : 8;
+
+	byte nameId;	// slot in NamePool
+
+	uint32_t getAddress() const;
+	void setAddress(uint32_t);
+	void setDip(const char*, byte shift);
+	byte getDip(byte shift) const;
 public:
+	// capacity of every table indexed by switch id
+#ifdef __AVR__
+	static const switch_id_t MAX = 16;
+#else
+	static const switch_id_t MAX = 512;
+#endif
+	static const switch_id_t NONE = 0xFFFF;
+
 	Switch();
 
 	void setGroup(const char*);
 	void setDevice(const char*);
 	void setId(byte);
 
-	char* getGroup() const;
-	char* getDevice() const;
+	DipSwitch getGroup() const;
+	DipSwitch getDevice() const;
 	byte getId() const;
 
+	// 24 bit code word for Transmitter::send()
+	uint32_t getCode(bool on) const;
+
 	bool isOn() const;
 	void setOn(bool);
 
@@ -58,8 +86,8 @@ public:
 	bool isScheduled() const;
 	void setScheduled(bool);
 
-	void setName(const char*);
-	const char* getName() const;
+	void setNameId(byte);
+	byte getNameId() const;
 };
 
 #endif
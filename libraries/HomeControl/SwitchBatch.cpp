@@ -0,0 +1,116 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SwitchBatch.h"
+
+
+SwitchBatch::SwitchBatch()
+{
+	clear();
+}
+
+void SwitchBatch::set(switch_id_t id, bool on)
+{
+	uint16_t bit = 1U << (id & 15);
+
+	mask[id >> 4] |= bit;
+	if (on)
+		state[id >> 4] |= bit;
+	else
+		state[id >> 4] &= ~bit;
+}
+
+void SwitchBatch::clear()
+{
+	memset(mask, 0, sizeof(mask));
+	memset(state, 0, sizeof(state));
+}
+
+void SwitchBatch::clear(switch_id_t id)
+{
+	uint16_t bit = 1U << (id & 15);
+
+	mask[id >> 4] &= ~bit;
+	state[id >> 4] &= ~bit;
+}
+
+bool SwitchBatch::has(switch_id_t id) const
+{
+	return mask[id >> 4] & (1U << (id & 15));
+}
+
+bool SwitchBatch::turnOn(switch_id_t id) const
+{
+	return state[id >> 4] & (1U << (id & 15));
+}
+
+bool SwitchBatch::isEmpty() const
+{
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		if (mask[w])
+			return false;
+	}
+	return true;
+}
+
+switch_id_t SwitchBatch::getCount() const
+{
+	switch_id_t n = 0;
+
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		for (uint16_t m = mask[w]; m; m &= m-1)
+			n++;
+	}
+	return n;
+}
+
+void SwitchBatch::dropUnchanged(const SwitchBatch& current)
+{
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		mask[w] &= state[w] ^ current.state[w];
+		state[w] &= mask[w];
+	}
+}
+
+bool SwitchBatch::isApplied(const SwitchBatch& current) const
+{
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		if (mask[w] & (state[w] ^ current.state[w]))
+			return false;
+	}
+	return true;
+}
+
+SwitchBatch SwitchBatch::inverted() const
+{
+	SwitchBatch b;
+
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		b.mask[w] = mask[w];
+		b.state[w] = mask[w] & ~state[w];
+	}
+	return b;
+}
+
+void SwitchBatch::merge(const SwitchBatch& b)
+{
+	for (switch_id_t w = 0; w < WORDS; w++) {
+		mask[w] |= b.mask[w];
+		state[w] = (state[w] & ~b.mask[w]) | b.state[w];
+	}
+}
@@ -0,0 +1,60 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWITCH_BATCH_H
+#define SWITCH_BATCH_H
+
+#include "Arduino.h"
+#include "Switch.h"
+
+
+// Target states for up to MAX switches, one bit each: whether the
+// batch sets a switch and whether it turns it on. Comparing with the
+// current states of all switches is a few word operations.
+class SwitchBatch {
+public:
+	static const switch_id_t MAX = Switch::MAX;
+private:
+	static const switch_id_t WORDS = (MAX + 15) / 16;
+
+	uint16_t mask[WORDS];
+	uint16_t state[WORDS];
+public:
+	SwitchBatch();
+
+	void set(switch_id_t id, bool on);
+	void clear();
+	void clear(switch_id_t id);
+
+	bool has(switch_id_t id) const;
+	bool turnOn(switch_id_t id) const;
+	bool isEmpty() const;
+	switch_id_t getCount() const;
+
+	// turnOn(i) of current is the state of switch i, dropped are the 
+	// switches already in their target state
+	void dropUnchanged(const SwitchBatch& current);
+	bool isApplied(const SwitchBatch& current) const;
+
+	// the same switches, each to the other state
+	SwitchBatch inverted() const;
+	// adds the switches of another batch, its states win
+	void merge(const SwitchBatch&);
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWITCH_REGISTRY_H
+#define SWITCH_REGISTRY_H
+
+#include "Arduino.h"
+#include "Switch.h"
+
+
+// The active switches out of N. All ids are kept in one permutation,
+// the active ones packed at the front and the free ones behind them, 
+// with the position of each id alongside. Iterating visits only active
+// switches, and looking one up, adding or removing it is O(1). An id 
+// stays with its switch, only positions change.
+template<switch_id_t N> class SwitchRegistry {
+	switch_id_t ids[N];
+	switch_id_t pos[N];
+	switch_id_t count;
+
+	void move(switch_id_t id, switch_id_t to);
+public:
+	SwitchRegistry();
+
+	switch_id_t getCount() const;
+	// the i-th active id, in no particular order
+	switch_id_t operator[](switch_id_t i) const;
+
+	bool isActive(switch_id_t id) const;
+	void setActive(switch_id_t id, bool);
+
+	// the id freed last, Switch::NONE if every one is active
+	switch_id_t getFree() const;
+};
+
+template<switch_id_t N>
+SwitchRegistry<N>::SwitchRegistry():
+	count(0)
+{
+	for (switch_id_t i = 0; i < N; i++)
+		ids[i] = pos[i] = i;
+}
+
+template<switch_id_t N>
+switch_id_t SwitchRegistry<N>::getCount() const
+{
+	return count;
+}
+
+template<switch_id_t N>
+switch_id_t SwitchRegistry<N>::operator[](switch_id_t i) const
+{
+	return ids[i];
+}
+
+template<switch_id_t N>
+bool SwitchRegistry<N>::isActive(switch_id_t id) const
+{
+	return id < N && pos[id] < count;
+}
+
+// swaps id with the one at position to
+template<switch_id_t N>
+void SwitchRegistry<N>::move(switch_id_t id, switch_id_t to)
+{
+	switch_id_t other = ids[to];
+
+	ids[pos[id]] = other;
+	pos[other] = pos[id];
+	ids[to] = id;
+	pos[id] = to;
+}
+
+template<switch_id_t N>
+void SwitchRegistry<N>::setActive(switch_id_t id, bool active)
+{
+	if (id >= N || isActive(id) == active)
+		return;
+
+	if (active) {
+		move(id, count);
+		count++;
+	} else {
+		count--;
+		move(id, count);
+	}
+}
+
+template<switch_id_t N>
+switch_id_t SwitchRegistry<N>::getFree() const
+{
+	return count < N ? ids[count] : Switch::NONE;
+}
+
+#endif
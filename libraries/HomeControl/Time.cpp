@@ -109,8 +109,8 @@ void Time::syncTime(bool force)
 	if (!force && getTime().getUnix() - lastSync < interval)
 		return;
 
-	if (!syncTime(ntpServer[0]))
-		syncTime(ntpServer[1]);
+	if (!syncTime(IPAddress(ntpServer[0])))
+		syncTime(IPAddress(ntpServer[1]));
 }
 
 bool Time::isRunning() const
@@ -184,7 +184,7 @@ void Time::setOffset(int offset)
 
 IPAddress Time::getTimeServer() const
 {
-	return ntpServer[0];
+	return IPAddress(ntpServer[0]);
 }
 
 time_t Time::getSyncInterval() const
@@ -27,7 +27,7 @@
 class Time {
 	time_t lastSync;
 	time_t interval;
-	IPAddress ntpServer[2];
+	uint32_t ntpServer[2];	// plain addresses, the class is saved as bytes
 	int utc;
 	
 	void createNtpPacket();
@@ -0,0 +1,165 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TimerWheel.h"
+
+
+TimerWheel::TimerWheel():
+	freeList(0), used(0), current(0), last(0)
+{
+	memset(head, NONE, sizeof(head));
+	for (byte i = 0; i < TIMERS; i++) {
+		timers[i].list = NONE;
+		timers[i].next = i + 1 < TIMERS ? i + 1 : NONE;
+	}
+}
+
+void TimerWheel::begin()
+{
+	last = millis();
+}
+
+void TimerWheel::link(byte t, byte list)
+{
+	Timer& tm = timers[t];
+	tm.list = list;
+	tm.prev = NONE;
+	tm.next = head[list];
+	if (tm.next != NONE)
+		timers[tm.next].prev = t;
+	head[list] = t;
+}
+
+void TimerWheel::unlink(byte t)
+{
+	Timer& tm = timers[t];
+	if (tm.prev != NONE)
+		timers[tm.prev].next = tm.next;
+	else
+		head[tm.list] = tm.next;
+	if (tm.next != NONE)
+		timers[tm.next].prev = tm.prev;
+}
+
+// the lowest level whose range covers the delay, slot by the due tick
+void TimerWheel::place(byte t)
+{
+	uint32_t due = timers[t].due;
+	uint32_t delta = due - current;
+
+	if (int32_t(delta) <= 0) {
+		link(t, EXPIRED);
+		return;
+	}
+
+	byte level = 0;
+	while (level < LEVELS-1 && delta >> (BITS * (level+1)))
+		level++;
+	link(t, level * SLOTS + ((due >> (BITS * level)) & (SLOTS-1)));
+}
+
+void TimerWheel::cascade(byte list)
+{
+	byte t = head[list];
+	head[list] = NONE;
+
+	while (t != NONE) {
+		byte next = timers[t].next;
+		place(t);
+		t = next;
+	}
+}
+
+void TimerWheel::tick()
+{
+	current++;
+
+	// levels at a slot boundary hand their slot down, top level first
+	byte level = 1;
+	while (level < LEVELS && !(current & ((1UL << BITS*level) - 1)))
+		level++;
+	while (--level > 0)
+		cascade(level * SLOTS + ((current >> (BITS * level)) & (SLOTS-1)));
+
+	byte slot = current & (SLOTS-1);
+	while (head[slot] != NONE) {
+		byte t = head[slot];
+		unlink(t);
+		link(t, EXPIRED);
+	}
+}
+
+void TimerWheel::advance()
+{
+	uint32_t ms = millis();
+
+	while (ms - last >= TICK) {
+		last += TICK;
+		tick();
+	}
+}
+
+byte TimerWheel::add(unsigned long ms, uint16_t data)
+{
+	if (freeList == NONE)
+		return NONE;
+
+	advance();
+	if (ms > MAX_DELAY)
+		ms = MAX_DELAY;
+
+	byte t = freeList;
+	freeList = timers[t].next;
+	used++;
+
+	// part of the current tick has passed already, round up
+	timers[t].due = current + ((uint32_t(millis()) - last + ms + TICK - 1) >> TICK_SHIFT);
+	timers[t].data = data;
+	place(t);
+	return t;
+}
+
+void TimerWheel::cancel(byte t)
+{
+	if (t >= TIMERS || timers[t].list == NONE)
+		return;
+
+	unlink(t);
+	timers[t].list = NONE;
+	timers[t].next = freeList;
+	freeList = t;
+	used--;
+}
+
+bool TimerWheel::poll(uint16_t& data)
+{
+	advance();
+
+	byte t = head[EXPIRED];
+	if (t == NONE)
+		return false;
+
+	data = timers[t].data;
+	cancel(t);
+	return true;
+}
+
+byte TimerWheel::getUsed() const
+{
+	return used;
+}
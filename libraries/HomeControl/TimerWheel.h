@@ -0,0 +1,81 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "Arduino.h"
+
+
+// One shot timers on a hierarchical wheel of 4 levels with 32 slots
+// each. Adding and cancelling only link or unlink a list node. A
+// timer moves down a level whenever the tick counter passes a slot
+// boundary, so each pass does constant work however many timers are
+// armed. Timers fire one tick late at most, never early. Ticks are
+// counted from millis() deltas, so its wraparound does not matter.
+// Times are 32 bit as on the board, the host wraps the same way.
+class TimerWheel {
+public:
+	static const byte TIMERS = 16;
+	static const byte NONE = 255;
+	static const byte TICK_SHIFT = 6;		// 64 ms
+	static const unsigned long TICK = 1UL << TICK_SHIFT;
+	static const byte BITS = 5;
+	static const byte LEVELS = 4;
+	// about 18.6 hours, longer delays are cut
+	static const unsigned long MAX_DELAY = 
+		(((1UL << BITS*LEVELS) - 1) << TICK_SHIFT) - TICK;
+private:
+	static const byte SLOTS = 1 << BITS;
+	static const byte EXPIRED = LEVELS * SLOTS;	// list of due timers
+
+	struct Timer {
+		uint32_t due;	// tick
+		uint16_t data;
+		byte list;
+		byte next;
+		byte prev;
+	};
+
+	Timer timers[TIMERS];
+	byte head[LEVELS * SLOTS + 1];
+	byte freeList;
+	byte used;
+	uint32_t current;	// ticks done
+	uint32_t last;		// millis() of the current tick
+
+	void link(byte, byte);
+	void unlink(byte);
+	void place(byte);
+	void cascade(byte);
+	void advance();
+	void tick();
+public:
+	TimerWheel();
+
+	void begin();
+	// handle for cancel(), NONE if all timers are armed
+	byte add(unsigned long ms, uint16_t data);
+	void cancel(byte);
+	// data of the next due timer, each fires once
+	bool poll(uint16_t& data);
+
+	byte getUsed() const;
+};
+
+#endif
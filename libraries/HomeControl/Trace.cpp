@@ -0,0 +1,126 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Trace.h"
+
+
+Trace traceLog;
+
+TraceArg::TraceArg():
+	type(NONE), value(0)
+{}
+
+TraceArg::TraceArg(int v):
+	type(INT), value(v)
+{}
+
+TraceArg::TraceArg(unsigned int v):
+	type(UINT), value(v)
+{}
+
+TraceArg::TraceArg(long v):
+	type(INT), value(v)
+{}
+
+TraceArg::TraceArg(unsigned long v):
+	type(UINT), value(v)
+{}
+
+TraceArg::TraceArg(const char* s):
+	type(STR), value(0)
+{
+	for (byte i = 0; i < 4 && s && s[i]; i++)
+		value |= uint32_t(byte(s[i])) << (8*i);
+}
+
+TraceArg::TraceArg(const IPAddress& ip):
+	type(IP), value(0)
+{
+	for (byte i = 0; i < 4; i++)
+		value |= uint32_t(ip[i]) << (8*i);
+}
+
+
+Trace::Trace():
+	dropped(0), busy(0)
+{}
+
+// the gateway workers on hosted builds trace concurrently
+void Trace::lock()
+{
+#ifndef __AVR__
+	while (__sync_lock_test_and_set(&busy, 1))
+		;
+#endif
+}
+
+void Trace::unlock()
+{
+#ifndef __AVR__
+	__sync_lock_release(&busy);
+#endif
+}
+
+void Trace::add(uint16_t id, const TraceArg& arg)
+{
+	TraceRecord rec;
+	rec.id = id;
+	rec.type = arg.type;
+	rec.time = millis();
+	rec.value = arg.value;
+
+	lock();
+	if (ring.isFull())
+		dropped++;
+	ring.put(rec);
+	unlock();
+}
+
+void Trace::drain(Print& out)
+{
+	TraceRecord recs[4];
+
+	lock();
+	unsigned long lost = dropped;
+	dropped = 0;
+	unlock();
+
+	if (lost) {
+		out.print(F("# dropped "));
+		out.println(lost);
+	}
+	// a few records at a time, tracing must not wait for a slow client
+	for (;;) {
+		lock();
+		byte n = ring.drainInto(recs, sizeof(recs) / sizeof(recs[0]));
+		unlock();
+		if (!n)
+			break;
+
+		for (byte i = 0; i < n; i++) {
+			const TraceRecord& rec = recs[i];
+			out.print(rec.id, HEX);
+			out.print(' ');
+			out.print(rec.type);
+			out.print(' ');
+			out.print((unsigned long)rec.time);
+			out.print(' ');
+			out.println((unsigned long)rec.value, HEX);
+		}
+	}
+}
@@ -0,0 +1,101 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "RingBuffer.h"
+
+// compile trace points out completely
+//#define NO_TRACE
+// drain the trace to Serial from loop()
+//#define DEBUG
+
+// files using TRACE define their own id (0-15) before including this,
+// tools/trace_decode.py maps it back to the file
+#ifndef TRACE_FILE
+#define TRACE_FILE 0
+#endif
+
+// 12 bits of line, a trace further down does not compile
+#define TRACE_LINE (__LINE__ + 0 * sizeof(char[__LINE__ < 4096 ? 1 : -1]))
+#define TRACE_ID uint16_t(uint16_t(TRACE_FILE) << 12 | TRACE_LINE)
+
+// TRACE_MSG("text") records only its id, the text stays in the source
+// where tools/trace_decode.py finds it and costs no RAM on the board
+#ifndef NO_TRACE
+#define TRACE(arg) traceLog.add(TRACE_ID, TraceArg(arg))
+#define TRACE_MSG(text) traceLog.add(TRACE_ID, TraceArg())
+#else
+#define TRACE(arg)
+#define TRACE_MSG(text)
+#endif
+
+
+// One trace argument, reduced to a type tag and 32 bits.
+// Strings keep their first four characters.
+struct TraceArg {
+	enum Type { NONE, INT, UINT, STR, IP };
+
+	byte type;
+	uint32_t value;
+
+	TraceArg();
+	TraceArg(int);
+	TraceArg(unsigned int);
+	TraceArg(long);
+	TraceArg(unsigned long);
+	TraceArg(const char*);
+	TraceArg(const IPAddress&);
+};
+
+struct TraceRecord {
+	uint16_t id;
+	byte type;
+	uint32_t time;
+	uint32_t value;
+};
+
+class Trace {
+public:
+#ifdef __AVR__
+	static const unsigned int SIZE = 32;
+#else
+	static const unsigned int SIZE = 256;
+#endif
+private:
+	RingBuffer<TraceRecord, SIZE> ring;
+	unsigned long dropped;
+	volatile byte busy;
+
+	void lock();
+	void unlock();
+public:
+	Trace();
+
+	void add(uint16_t id, const TraceArg&);
+	// print and remove the buffered records, one per line:
+	// id type millis value, all hex except millis
+	void drain(Print&);
+};
+
+extern Trace traceLog;
+
+#endif
@@ -0,0 +1,87 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Transmitter.h"
+
+
+Transmitter::Transmitter(byte _pin):
+	pin(_pin), repeat(REPEAT), protocol(RfProtocol::get(1)), 
+	pulseLength(protocol->pulseLength)
+{}
+
+void Transmitter::begin()
+{
+	pinMode(pin, OUTPUT);
+}
+
+void Transmitter::setRepeat(byte r)
+{
+	repeat = r;
+}
+
+bool Transmitter::setProtocol(byte p)
+{
+	const RfProtocol* pro = RfProtocol::get(p);
+
+	if (!pro)
+		return false;
+	protocol = pro;
+	pulseLength = pro->pulseLength;
+	return true;
+}
+
+void Transmitter::setPulseLength(unsigned int len)
+{
+	pulseLength = len;
+}
+
+void Transmitter::pulse(byte high, byte low)
+{
+	digitalWrite(pin, protocol->inverted ? LOW : HIGH);
+	delayMicroseconds(pulseLength * high);
+	digitalWrite(pin, protocol->inverted ? HIGH : LOW);
+	delayMicroseconds(pulseLength * low);
+}
+
+void Transmitter::send(uint32_t word, byte bits)
+{
+	for (byte r = 0; r < repeat; r++) {
+		for (uint32_t mask = 1UL << (bits-1); mask; mask >>= 1) {
+			if (word & mask)
+				pulse(protocol->oneHigh, protocol->oneLow);
+			else
+				pulse(protocol->zeroHigh, protocol->zeroLow);
+		}
+		pulse(protocol->syncHigh, protocol->syncLow);
+	}
+	if (protocol->inverted)
+		digitalWrite(pin, LOW);
+}
+
+// learned raw codes cannot be sent, they only keep a hash
+void Transmitter::send(const RfCode& code)
+{
+	const RfProtocol* pro = protocol;
+	unsigned int len = pulseLength;
+
+	if (!setProtocol(code.protocol))
+		return;
+	send(code.value, code.bits);
+	protocol = pro;
+	pulseLength = len;
+}
@@ -0,0 +1,51 @@
+/*
+	HomeControl
+	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRANSMITTER_H
+#define TRANSMITTER_H
+
+#include "Arduino.h"
+#include "RfProtocol.h"
+
+
+// Sends a binary RF code word, e.g. Switch::getCode(), with the
+// timing of one of the RCSwitch protocols, protocol 1 by default.
+class Transmitter {
+	byte pin;
+	byte repeat;
+	const RfProtocol* protocol;
+	unsigned int pulseLength;
+
+	void pulse(byte high, byte low);
+public:
+	static const byte REPEAT = 10;
+
+	Transmitter(byte);
+
+	void begin();
+	void setRepeat(byte);
+	// also resets the pulse length to the one of the protocol
+	bool setProtocol(byte);
+	void setPulseLength(unsigned int);
+
+	// most significant bit first, then a sync pulse, repeated
+	void send(uint32_t word, byte bits = 24);
+	void send(const RfCode&);
+};
+
+#endif
@@ -20,36 +20,74 @@
 #define UTIL_H
 
 
-//#define DEBUG
+// bytes written with operator<< and page templates, i.e. everything
+// sent to web clients
+inline unsigned long& bytesSent()
+{
+	static unsigned long n = 0;
+	return n;
+}
 
 template<class T>
 inline Print& operator<<(Print &p, T rhs)
 {
-	p.print(rhs); 
+	size_t n = p.print(rhs);
+#ifdef __AVR__
+	bytesSent() += n;
+#else
+	__sync_fetch_and_add(&bytesSent(), n);
+#endif
 	return p; 
 }
 
-int freeRam() 
+inline int freeRam() 
 {
+#ifdef __AVR__
 	extern int __heap_start, *__brkval; 
 	int v; 
 	return (int)&v - (__brkval == 0 ? (int)&__heap_start : (int)__brkval); 
+#else
+	return 0; // no fixed heap/stack gap on a hosted system
+#endif
 }
 
-#ifdef DEBUG
-#define DEBUG_PRINT(str) \
-	Serial.print(millis()); \
-	Serial.print(": "); \
-	Serial.print(__PRETTY_FUNCTION__); \
-	Serial.print(' '); \
-	Serial.print(__FILE__); \
-	Serial.print(':'); \
-	Serial.print(__LINE__); \
-	Serial.print(' '); \
-	Serial.println(str);
+inline int heapUsed()
+{
+#ifdef __AVR__
+	extern int __heap_start, *__brkval;
+	return __brkval == 0 ? 0 : (int)__brkval - (int)&__heap_start;
 #else
-#define DEBUG_PRINT(str)
+	return 0;
 #endif
+}
+
+// High water marks of heap and stack, memSample() is cheap enough
+// to be called at the deepest points of the call tree
+struct MemStat {
+	int lowFree;
+	int heapPeak;
+};
+
+inline MemStat& memStat()
+{
+	static MemStat stat = { 0x7fff, 0 };
+	return stat;
+}
+
+inline void memSample()
+{
+	MemStat& stat = memStat();
+	int f = freeRam();
+	int h = heapUsed();
+	if (f < stat.lowFree)
+		stat.lowFree = f;
+	if (h > stat.heapPeak)
+		stat.heapPeak = h;
+}
+
+// C++98 compile time check, e.g. STATIC_ASSERT(sizeof(Switch) <= 6, switch_size)
+#define STATIC_ASSERT(expr, msg) \
+	typedef char static_assert_##msg[(expr) ? 1 : -1]
 
 #define GCC_VERSION (__GNUC__ * 10000 \
 	+ __GNUC_MINOR__ * 100 \
@@ -21,24 +21,18 @@
 
 namespace {
 
-	void fixPadding(char* base, int size)
-	{
-		char* str = base + size - 6;
-
-		if (strcmp(str, "%3D%3D") == 0) {
-			str[0] = '=';
-			str[1] = '=';
-			str[2] = '\0';
-		} else if (strcmp(str + 3, "%3D") == 0) {
-			str[3] = '=';
-			str[4] = '\0';
-		}
-	}
+	// SHA-256 of "YWRtaW46YWRtaW4="
+	const byte DEFAULT_DIGEST[Sha256::SIZE] PROGMEM = {
+		0x12, 0xd8, 0xd9, 0xea, 0x56, 0xa1, 0xac, 0xfb, 
+		0x1a, 0x0a, 0xcb, 0x46, 0x3a, 0xf5, 0x3f, 0xdf, 
+		0x46, 0x0e, 0x9a, 0x0e, 0x88, 0xf8, 0xea, 0x1a, 
+		0xab, 0x48, 0x7b, 0x6b, 0x91, 0xe6, 0xff, 0x92
+	};
 }
 
 
 WebServer::WebServer():
-	dhcp(true)
+	dhcp(true), ip(0), gw(0), dns(0), mask(0)
 {
 	// TODO teach arduino c++11
 	mac[0] = 0x00;	
@@ -49,7 +43,7 @@ WebServer::WebServer():
 	mac[5] = 0xAA;	
 	
 	// admin:admin
-	strncpy(passw, "YWRtaW46YWRtaW4=", MAX_PASSW_SIZE);
+	memcpy_P(passwDigest, DEFAULT_DIGEST, sizeof(passwDigest));
 }
 
 byte* WebServer::getMAC() 
@@ -64,27 +58,27 @@ bool WebServer::getDHCP() const
 
 IPAddress WebServer::getIP() const
 {
-	return ip;
+	return IPAddress(ip);
 }
 
 IPAddress WebServer::getGW() const
 {
-	return gw;
+	return IPAddress(gw);
 }
 
 IPAddress WebServer::getDNS() const
 {
-	return dns;
+	return IPAddress(dns);
 }
 
 IPAddress WebServer::getMask() const
 {
-	return mask;
+	return IPAddress(mask);
 }
 
-char* WebServer::getPassw()
+const byte* WebServer::getPasswDigest() const
 {
-	return passw;
+	return passwDigest;
 }
 
 void WebServer::setDHCP(bool _dhcp)
@@ -114,11 +108,13 @@ void WebServer::setMask(const IPAddress& _mask)
 
 bool WebServer::setPassw(const char* _passw)
 {
-	if (strlen(_passw) < MIN_PASSW_SIZE)
+	size_t len = strlen(_passw);
+	if (len < MIN_PASSW_SIZE || len > MAX_PASSW_SIZE)
 		return false;
 
-	strncpy(passw, _passw, MAX_PASSW_SIZE);
-	fixPadding(passw, strlen(passw));
+	Sha256 sha;
+	sha.update(_passw, len);
+	sha.finish(passwDigest);
 
 	return true;
 }
@@ -21,6 +21,7 @@
 
 #include "Arduino.h"
 #include "IPAddress.h"
+#include "Sha256.h"
 
 
 class WebServer {
@@ -33,25 +34,29 @@ public:
 	IPAddress getGW() const;
 	IPAddress getDNS() const;
 	IPAddress getMask() const;
-	char* getPassw();
+	// SHA-256 of the base64 "user:password" of Basic auth
+	const byte* getPasswDigest() const;
 	
 	void setDHCP(bool);
 	void setIP(const IPAddress&);
 	void setGW(const IPAddress&);
 	void setDNS(const IPAddress&);
 	void setMask(const IPAddress&);
+	// base64 credential, as the browser sends it
 	bool setPassw(const char*);
 	
 	static const byte MIN_PASSW_SIZE = 16;
-	static const byte MAX_PASSW_SIZE = 32;
+	// only the digest is stored, the form value buffer limits the length
+	static const byte MAX_PASSW_SIZE = 48;
 private:
 	bool dhcp;
-	IPAddress ip;
-	IPAddress gw;
-	IPAddress dns;
-	IPAddress mask;
+	// plain addresses, the class is saved as bytes
+	uint32_t ip;
+	uint32_t gw;
+	uint32_t dns;
+	uint32_t mask;
 	byte mac[6];
-	char passw[MAX_PASSW_SIZE+1];
+	byte passwDigest[Sha256::SIZE];
 };
 
 #endif
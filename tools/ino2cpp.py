@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+#
+#	HomeControl
+#	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Turn the sketch into a C++ file for the host build, like the Arduino
+# IDE does: Arduino.h first, then prototypes of the functions before
+# the first function definition.
+#
+#   tools/ino2cpp.py HomeControl/HomeControl.ino HomeControl.cpp
+#
+# Code for the board only (#ifdef __AVR__) gets no prototypes. Functions
+# with default arguments are left out, they are defined before use.
+
+import re
+import sys
+
+FUNCTION = re.compile(
+	r'^((?:inline\s+|static\s+)?[A-Za-z_][\w\s\*&:<>,]*?[\s\*&]+)(\w+)\(([^)]*)\)\s*(\{\s*\})?$')
+
+
+def prototypes(lines):
+	found = []
+	first = None
+	active = []
+
+	for i, line in enumerate(lines):
+		t = line.strip()
+		if t.startswith('#ifdef __AVR__'):
+			active.append(False)
+			continue
+		if t.startswith('#ifndef __AVR__'):
+			active.append(True)
+			continue
+		if t.startswith('#if'):
+			active.append(True)
+			continue
+		if t.startswith('#else') and active:
+			active[-1] = not active[-1]
+			continue
+		if t.startswith('#endif') and active:
+			active.pop()
+			continue
+		if not all(active):
+			continue
+
+		m = FUNCTION.match(line)
+		if not m or (i > 0 and lines[i-1].startswith('template')):
+			continue
+		body = m.group(4) or (i + 1 < len(lines) and lines[i+1].startswith('{'))
+		if not body:
+			continue
+		if first is None:
+			first = i
+		if m.group(2) in ('setup', 'loop') or m.group(1).startswith('inline'):
+			continue
+		if '=' not in m.group(3):
+			found.append(line.rstrip() + ';')
+	return first, found
+
+
+def main():
+	if len(sys.argv) != 3:
+		sys.exit('usage: ino2cpp.py sketch.ino out.cpp')
+
+	path = sys.argv[1]
+	lines = open(path).read().split('\n')
+	first, found = prototypes(lines)
+	if first is None:
+		first = len(lines)
+
+	out = ['#include <Arduino.h>', '#line 1 "%s"' % path]
+	out += lines[:first]
+	out += found
+	out += ['#line %d "%s"' % (first + 1, path)]
+	out += lines[first:]
+	open(sys.argv[2], 'w').write('\n'.join(out))
+
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+#
+#	HomeControl
+#	Copyright (C) 2014 Serkan Sakar <ssakar@gmx.de>
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Decode the binary trace of HomeControl (see Trace.h).
+#
+#   curl -s -u :password http://homecontrol/trace | tools/trace_decode.py
+#   tools/trace_decode.py trace.txt
+#
+# Each record is "id type millis value". The id is (file << 12) | line,
+# the file id comes from "#define TRACE_FILE n", the sketch is 0.
+
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+NONE, INT, UINT, STR, IP = range(5)
+
+FUNC = re.compile(r'^[A-Za-z_][\w:<>,&*\s]*\s[\w:~]+\(.*\)\s*(const)?\s*$')
+TRACE = re.compile(r'TRACE(?:_MSG)?\((.*)\);')
+
+
+def load_sources():
+	files = {}
+	for d, _, names in os.walk(ROOT):
+		for n in names:
+			# Trace.h only holds the default
+			if not n.endswith(('.ino', '.cpp', '.h')) or n == 'Trace.h':
+				continue
+			path = os.path.join(d, n)
+			with open(path, errors='replace') as f:
+				lines = f.read().split('\n')
+			m = [re.match(r'#define TRACE_FILE (\d+)', l) for l in lines]
+			m = [int(x.group(1)) for x in m if x]
+			if m:
+				files[m[0]] = path
+			elif n.endswith('.ino'):
+				files.setdefault(0, path)
+	return files
+
+
+def function_at(lines, i):
+	while i > 0:
+		i -= 1
+		if FUNC.match(lines[i]) and i+1 < len(lines) and lines[i+1].startswith('{'):
+			return lines[i].split('(')[0].split()[-1]
+	return '?'
+
+
+def value(kind, v):
+	if kind == NONE:
+		return ''
+	if kind == INT:
+		return str(v - (1 << 32) if v & (1 << 31) else v)
+	if kind == UINT:
+		return str(v)
+	if kind == STR:
+		b = bytes((v >> (8*i)) & 0xff for i in range(4))
+		return repr(b.split(b'\0')[0].decode('latin-1'))
+	if kind == IP:
+		return '.'.join(str((v >> (8*i)) & 0xff) for i in range(4))
+	return hex(v)
+
+
+def main():
+	files = load_sources()
+	cache = {}
+	src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+
+	for rec in src:
+		rec = rec.strip()
+		if not rec or rec.startswith('#'):
+			if rec:
+				print(rec)
+			continue
+		tid, kind, ms, v = rec.split()
+		tid, kind, ms, v = int(tid, 16), int(kind), int(ms), int(v, 16)
+		path = files.get(tid >> 12)
+		line = tid & 0xfff
+
+		where, expr, func = '%d:%d' % (tid >> 12, line), '', '?'
+		if path:
+			if path not in cache:
+				with open(path, errors='replace') as f:
+					cache[path] = f.read().split('\n')
+			lines = cache[path]
+			where = '%s:%d' % (os.path.basename(path), line)
+			if line <= len(lines):
+				m = TRACE.search(lines[line-1])
+				expr = m.group(1) if m else lines[line-1].strip()
+				func = function_at(lines, line-1)
+
+		val = value(kind, v)
+		print('%10d %-22s %-20s %s%s' % (ms, where, func, expr,
+			' = ' + val if val and not expr.startswith('"') else ''))
+
+
+if __name__ == '__main__':
+	main()